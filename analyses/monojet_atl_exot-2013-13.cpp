@@ -28,22 +28,26 @@ using namespace boost;
 using namespace boost::filesystem;
 
 
-// atl pt over met cut
+// atl pt over met cut, shares the leading jet pt and the met with the default cuts
 class cut_atl_jetmet: public cut
 {
 public:
-	cut_atl_jetmet() {}
+	cut_atl_jetmet(observables &obs = default_observables()) : list(obs), jet_pt(add_pt(obs, ptype_jet, 1, 2.0)), met(add_met(obs)) {}
+
+	void prepare(const vector<event*> &events)
+	{
+		list.prepare(events);
+	}
 
 	bool operator() (const event *ev) 
 	{ 
-		// get the leading jet and the met
-		const particle *j1 = ev->get(ptype_jet, 1, 2.0);
-		// reject event if jets not found
-		if (!j1)
-			return false;
-		// event passed
-		return j1->pt() > ev->met() / 2.0;
+		// events without the leading jet have pt 0 and are rejected
+		return list.value(ev, jet_pt) > list.value(ev, met) / 2.0;
 	}
+private:
+	observables &list;
+	unsigned int jet_pt;
+	unsigned int met;
 };
 
 // atl delta phi cut
@@ -12,6 +12,11 @@
 namespace analysis
 {
 
+	// upper bounds of the sizes read from binary files, such that corrupt 
+	// files are rejected instead of allocated
+	const unsigned int max_binary_cuts = 1u << 16;
+	const unsigned int max_binary_name_size = 4096;
+
 	/* cut & count class */
 
 	cuts::cuts()
@@ -38,6 +43,12 @@ namespace analysis
 		{
 			// get the cut
 			cut *apply_cut = list_cuts[i];
+			if (!apply_cut)
+			{
+				std::cout << "Error: cut " << list_names[i] << " only holds counters and can not be applied." << std::endl;
+				exit (EXIT_FAILURE);
+			}
+			apply_cut->prepare(events);
 
 			// loop over all events
 			for (int index = events.size() - 1; index >= 0; index--)
@@ -64,26 +75,28 @@ namespace analysis
 	
 	const std::vector<event*> cuts::reduce(const std::vector<event*> &events) const
 	{
-		std::vector<event*> reduced_events;
-		
-		// loop over all events
-		for (unsigned int index = 0; index < events.size(); ++index)
-		{	
-			event *ev = events[index];
-			bool passed_cuts = true;
+		// apply the cuts one after the other, such that each cut is only 
+		// prepared for the events which passed the previous cuts
+		std::vector<event*> reduced_events(events);
+		std::vector<event*> passed_events;
+		for (unsigned int i = 0; i < list_cuts.size(); i++)
+		{
+			cut *apply_cut = list_cuts[i];
+			if (!apply_cut)
+			{
+				std::cout << "Error: cut " << list_names[i] << " only holds counters and can not be applied." << std::endl;
+				exit (EXIT_FAILURE);
+			}
+			apply_cut->prepare(reduced_events);
 			
-			// loop over all cuts
-			for (unsigned int i = 0; i < list_cuts.size(); i++)
+			// loop over the remaining events
+			passed_events.clear();
+			for (unsigned int index = 0; index < reduced_events.size(); ++index)
 			{
-				cut *apply_cut = list_cuts[i];
-				if (!(*apply_cut)(ev))
-				{
-					passed_cuts = false;
-					break;
-				}				
+				if ((*apply_cut)(reduced_events[index]))
+					passed_events.push_back(reduced_events[index]);
 			}
-			if (passed_cuts)
-				reduced_events.push_back(ev);
+			reduced_events.swap(passed_events);
 		}
 		return reduced_events;
 	}
@@ -142,5 +155,88 @@ namespace analysis
 		ofs << " (" << pass << "/" << total << ")" << std::endl;
 	}
 
+	void cuts::write_binary(std::ostream& os) const
+	{
+		unsigned int nr_cuts = list_cuts.size();
+		os.write(reinterpret_cast<const char*>(&nr_cuts), sizeof(nr_cuts));
+		for (unsigned int i = 0; i < nr_cuts; i++)
+		{
+			unsigned int name_size = list_names[i].size();
+			os.write(reinterpret_cast<const char*>(&name_size), sizeof(name_size));
+			os.write(list_names[i].data(), name_size);
+			os.write(reinterpret_cast<const char*>(&list_pass[i]), sizeof(unsigned int));
+			os.write(reinterpret_cast<const char*>(&list_total[i]), sizeof(unsigned int));
+		}
+		os.write(reinterpret_cast<const char*>(&pass), sizeof(unsigned int));
+		os.write(reinterpret_cast<const char*>(&total), sizeof(unsigned int));
+	}
+
+	bool cuts::read_binary(std::istream& is)
+	{
+		// read into a temporary, which is only merged when complete
+		cuts read;
+		unsigned int nr_cuts = 0;
+		is.read(reinterpret_cast<char*>(&nr_cuts), sizeof(nr_cuts));
+		if (!is || nr_cuts > max_binary_cuts)
+			return false;
+		for (unsigned int i = 0; i < nr_cuts; i++)
+		{
+			unsigned int name_size = 0;
+			is.read(reinterpret_cast<char*>(&name_size), sizeof(name_size));
+			if (!is || name_size > max_binary_name_size)
+				return false;
+			std::string name(name_size, ' ');
+			if (name_size > 0)
+				is.read(&name[0], name_size);
+			read.add_cut(nullptr, name);
+			is.read(reinterpret_cast<char*>(&read.list_pass[i]), sizeof(unsigned int));
+			is.read(reinterpret_cast<char*>(&read.list_total[i]), sizeof(unsigned int));
+		}
+		is.read(reinterpret_cast<char*>(&read.pass), sizeof(unsigned int));
+		is.read(reinterpret_cast<char*>(&read.total), sizeof(unsigned int));
+		if (!is)
+			return false;
+		
+		// keep the cuts of this instance if it has the same list
+		if (list_cuts.empty())
+			*this = read;
+		else
+		{
+			if (list_names != read.list_names)
+				return false;
+			clear();
+			merge(read);
+		}
+		return true;
+	}
+
+	void cuts::merge(const cuts& other)
+	{
+		if (!can_merge(other))
+		{
+			std::cout << "Error: can not merge cut & count results with different cuts." << std::endl;
+			exit (EXIT_FAILURE);
+		}
+
+		// an empty instance adopts the counters of the other
+		if (list_cuts.empty() && total == 0)
+		{
+			for (unsigned int i = 0; i < other.list_cuts.size(); i++)
+				add_cut(nullptr, other.list_names[i]);
+		}
+		for (unsigned int i = 0; i < list_cuts.size(); i++)
+		{
+			list_pass[i] += other.list_pass[i];
+			list_total[i] += other.list_total[i];
+		}
+		pass += other.pass;
+		total += other.total;
+	}
+
+	bool cuts::can_merge(const cuts& other) const
+	{
+		return (list_cuts.empty() && total == 0) || list_names == other.list_names;
+	}
+
 /* NAMESPACE */
 }
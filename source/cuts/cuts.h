@@ -10,10 +10,13 @@
 
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "../event/event.h"
+#include "../event/observables.h"
 
 
 /* NAMESPACE */
@@ -31,6 +34,9 @@ namespace analysis
 		// all cuts are based on this class and should overload this
 		// operator, and return true for events that pass the cuts
 		virtual bool operator() (const event *ev) { return false; }
+		// called with all events before they are tested, cuts which 
+		// are faster for a whole sample can precompute their values here
+		virtual void prepare(const std::vector<event*> &events) {}
 	
 	};
 	
@@ -51,6 +57,15 @@ namespace analysis
 		void write(std::ostream& os) const;
 		void write(std::ofstream& ofs) const;	
 
+		// the pass & total counters can be stored in a binary format and
+		// merged with the counters of other jobs with the same cuts, cuts
+		// read into an empty instance only hold the counters, reading into
+		// an instance with other cuts or a corrupt file returns false
+		void write_binary(std::ostream& os) const;
+		bool read_binary(std::istream& is);
+		void merge(const cuts& other);
+		bool can_merge(const cuts& other) const;
+
 	private:
 		std::vector<cut*> list_cuts;
 		std::vector<std::string> list_names;
@@ -28,55 +28,53 @@ namespace analysis
 		unsigned int number;
 	};
 	
-	/* cut: pt */
-	class cut_pt : public cut
-	{	
+	/* cut: observable, passes if min < value < max */
+	class cut_observable : public cut
+	{
 	public:
-		cut_pt(double pt, unsigned int t, unsigned int n, double eta) : pt_cut(pt), type(t), number(n), eta_max(eta) {};
-	
+		cut_observable(observables &obs, const std::string &name, double min, double max = std::numeric_limits<double>::infinity()) :
+			list(obs), handle(obs.handle(name)), min_value(min), max_value(max) {};
+		cut_observable(observables &obs, unsigned int h, double min, double max = std::numeric_limits<double>::infinity()) :
+			list(obs), handle(h), min_value(min), max_value(max) {};
+
+		void prepare(const std::vector<event*> &events)
+		{
+			list.prepare(events);
+		};
+
 		bool operator() (const event *ev) 
 		{ 
-			const particle *p = ev->get(type, number, eta_max); 
-			if (!p)
-				return false;
-			return p->pt() > pt_cut;
+			double value = list.value(ev, handle);
+			return value > min_value && value < max_value;
 		};
 	private:
-		double pt_cut;
-		unsigned int type;
-		unsigned int number;
-		double eta_max;
+		observables &list;
+		unsigned int handle;
+		double min_value;
+		double max_value;
+	};
+	
+	/* cut: pt, an event without the particle has pt 0 */
+	class cut_pt : public cut_observable
+	{	
+	public:
+		cut_pt(double pt, unsigned int t, unsigned int n, double eta, observables &obs = default_observables()) :
+			cut_observable(obs, add_pt(obs, t, n, eta), pt) {};
 	};
 	
 	/* cut: met */
-	class cut_met : public cut
+	class cut_met : public cut_observable
 	{		
 	public:
-		cut_met(double met) : met_cut(met) {};
-		
-		bool operator() (const event *ev) 
-		{ 
-			return ev->met() > met_cut;
-		};		
-	private:
-		double met_cut;		
+		cut_met(double met, observables &obs = default_observables()) : cut_observable(obs, add_met(obs), met) {};
 	};
 	
 	/* cut: ht */
-	class cut_ht : public cut
+	class cut_ht : public cut_observable
 	{		
 	public:
-		cut_ht(double ht, unsigned int t, double pt, double eta) : ht_cut(ht), type(t), min_pt(pt), max_eta(eta) {};
-		
-		bool operator() (const event *ev) 
-		{ 
-			return ev->ht(type, min_pt, max_eta) > ht_cut;
-		};		
-	private:
-		double ht_cut;
-		unsigned int type;
-		double min_pt;
-		double max_eta;		
+		cut_ht(double ht, unsigned int t, double pt, double eta, observables &obs = default_observables()) :
+			cut_observable(obs, add_ht(obs, t, pt, eta), ht) {};
 	};
 	
 	/* cut: veto */
@@ -111,15 +109,30 @@ namespace analysis
 	class cut_mt2: public cut
 	{		
 	public:
-		cut_mt2(double mt2, double mn) : mt2_cut(mt2), mt2_mn(mn) {};
+		cut_mt2(double mt2, double mn, int workers = 1) : mt2_cut(mt2), mt2_mn(mn), mt2_workers(workers) {};
 		
+		void prepare(const std::vector<event*> &events)
+		{
+			// mt2 of the whole sample in one batch, keyed by the event id such that freed or
+			// changed events are never confused with the prepared ones
+			std::vector<double> values = mt2_events(events, std::vector<double>(1, mt2_mn), mt2_workers);
+			mt2_values.clear();
+			for (unsigned int i = 0; i < events.size(); ++i)
+				mt2_values[events[i]->id()] = values[i];
+		};
+
 		bool operator() (const event *ev) 
 		{ 
+			std::unordered_map<unsigned long long, double>::const_iterator it = mt2_values.find(ev->id());
+			if (it != mt2_values.end())
+				return it->second > mt2_cut;
 			return ev->mt2(mt2_mn) > mt2_cut;
 		};		
 	private: 
 		double mt2_cut;
-		double mt2_mn;		
+		double mt2_mn;
+		int mt2_workers;
+		std::unordered_map<unsigned long long, double> mt2_values;
 	};
 	
 /* NAMESPACE */
@@ -0,0 +1,227 @@
+/* Detector simulation class
+ *
+ * Parametrised fast detector simulation: applies efficiency tables and Gaussian
+ * pT resolutions per (|eta|, pT) bin to the truth objects of an event and 
+ * produces lhco objects, with the missing energy following the smearing.
+*/
+
+#include "detector_sim.h"
+
+
+/* NAMESPACE */
+namespace analysis
+{
+
+	/* con- & destructor */
+
+	detector_sim::detector_sim(const std::string & settings_file, unsigned int seed)
+	{
+		sim_seed = seed;
+		read_response(settings_file, "PHOTON", resp_photon);
+		read_response(settings_file, "ELECTRON", resp_electron);
+		read_response(settings_file, "MUON", resp_muon);
+		read_response(settings_file, "TAU", resp_tau);
+		read_response(settings_file, "JET", resp_jet);
+	}
+
+	detector_sim::~detector_sim()
+	{
+	}
+
+
+	/* detector response */
+
+	void detector_sim::read_response(const std::string & settings_file, const std::string & name, response & resp)
+	{
+		// tables are read as NAME_ETA_BINS = {...}, NAME_PT_BINS = {...} and NAME_EFFICIENCY = {...} etc.
+		resp.eta_bins = read_settings_list<double>(settings_file, name + "_ETA_BINS");
+		resp.pt_bins = read_settings_list<double>(settings_file, name + "_PT_BINS");
+		resp.efficiency = read_settings_list<double>(settings_file, name + "_EFFICIENCY");
+		resp.resolution = read_settings_list<double>(settings_file, name + "_RESOLUTION");
+		resp.btag = read_settings_list<double>(settings_file, name + "_BTAG");
+		resp.mistag = read_settings_list<double>(settings_file, name + "_MISTAG");
+
+		// objects without a response are passed unchanged
+		resp.defined = resp.eta_bins.size() > 1 && resp.pt_bins.size() > 1;
+		if (!resp.defined)
+		{
+			std::cout << "Warning: no detector response for " << name << ", these objects are passed unchanged." << std::endl;
+			return;
+		}
+
+		// all tables have one entry per bin, missing tables mean full efficiency or no smearing
+		unsigned int nr_bins = (resp.eta_bins.size() - 1) * (resp.pt_bins.size() - 1);
+		std::string tables[4] = { "_EFFICIENCY", "_RESOLUTION", "_BTAG", "_MISTAG" };
+		std::vector<double> *values[4] = { &resp.efficiency, &resp.resolution, &resp.btag, &resp.mistag };
+		for (unsigned int t = 0; t < 4; ++t)
+		{
+			if (!values[t]->empty() && values[t]->size() != nr_bins)
+			{
+				std::cout << "Error: " << name << tables[t] << " needs " << nr_bins << " entries, one per (eta, pt) bin." << std::endl;
+				exit (EXIT_FAILURE);
+			}
+		}
+	}
+
+	const detector_sim::response * detector_sim::response_of(unsigned int type) const
+	{
+		switch (type)
+		{
+		case ptype_photon:
+			return &resp_photon;
+		case ptype_electron:
+			return &resp_electron;
+		case ptype_muon:
+			return &resp_muon;
+		case ptype_tau:
+			return &resp_tau;
+		case ptype_jet:
+			return &resp_jet;
+		default:
+			return nullptr;
+		}
+	}
+
+	int detector_sim::bin(const response & resp, double eta, double pt) const
+	{
+		// outside the eta range or below the lowest pt edge the object is not detected, 
+		// above the highest pt edge the last bin is used
+		double abs_eta = std::abs(eta);
+		if (abs_eta < resp.eta_bins.front() || abs_eta >= resp.eta_bins.back() || pt < resp.pt_bins.front())
+			return -1;
+		int eta_bin = std::upper_bound(resp.eta_bins.begin(), resp.eta_bins.end(), abs_eta) - resp.eta_bins.begin() - 1;
+		int nr_pt_bins = resp.pt_bins.size() - 1;
+		int pt_bin = std::upper_bound(resp.pt_bins.begin(), resp.pt_bins.end(), pt) - resp.pt_bins.begin() - 1;
+		pt_bin = std::min(pt_bin, nr_pt_bins - 1);
+		return eta_bin * nr_pt_bins + pt_bin;
+	}
+
+
+	/* simulation */
+
+	event* detector_sim::simulate(const event & truth, std::mt19937 & rng) const
+	{
+		std::uniform_real_distribution<double> flat(0., 1.);
+		std::normal_distribution<double> gauss(0., 1.);
+		event *reco = new event;
+
+		// missing transverse momentum of the truth event: the met objects of lhco input, 
+		// otherwise the recoil of the visible final state
+		double mex = 0., mey = 0., vis_px = 0., vis_py = 0.;
+		bool truth_met = false;
+		for (unsigned int i = 0; i < truth.size(); ++i)
+		{
+			const particle *p = truth[i];
+			if (!p->is_final())
+				continue;
+			if (p->type() == ptype_met)
+			{
+				if (dynamic_cast<const lhco*>(p))
+				{
+					mex += p->pt() * cos(p->phi());
+					mey += p->pt() * sin(p->phi());
+					truth_met = true;
+				}
+				continue;
+			}
+			vis_px += p->px();
+			vis_py += p->py();
+		}
+		if (!truth_met)
+		{
+			mex = -vis_px;
+			mey = -vis_py;
+		}
+
+		// detector response of the visible objects, the missing energy absorbs the changes
+		for (unsigned int i = 0; i < truth.size(); ++i)
+		{
+			const particle *p = truth[i];
+			unsigned int type = p->type();
+			if (!p->is_final() || type == ptype_met || type == ptype_none)
+				continue;
+
+			double eta = p->eta(), phi = p->phi(), pt = p->pt(), mass = p->mass();
+			double reco_pt = pt, reco_mass = mass;
+			double btag = p->bjet();
+			const response *resp = response_of(type);
+			if (resp && resp->defined)
+			{
+				// efficiency
+				int b = bin(*resp, eta, pt);
+				bool detected = b >= 0 && (resp->efficiency.empty() || flat(rng) < resp->efficiency[b]);
+
+				// gaussian pt resolution, the mass scales with the pt
+				if (detected && !resp->resolution.empty())
+				{
+					reco_pt = pt * (1. + resp->resolution[b] * gauss(rng));
+					reco_mass = pt > 0 ? mass * reco_pt / pt : mass;
+					detected = reco_pt > 0.;
+				}
+
+				// b-tagging of true b-jets and mistagging of the other jets
+				if (detected && type == ptype_jet)
+				{
+					const std::vector<double> & tag = btag > 0 ? resp->btag : resp->mistag;
+					if (!tag.empty())
+						btag = flat(rng) < tag[b] ? 1. : 0.;
+				}
+
+				if (!detected)
+					reco_pt = 0.;
+			}
+
+			mex -= (reco_pt - pt) * cos(phi);
+			mey -= (reco_pt - pt) * sin(phi);
+			if (reco_pt <= 0.)
+				continue;
+
+			// lhco objects: the charge of leptons is stored as number of tracks
+			double ntrk = (type & ptype_leptonall) ? p->charge() : 0.;
+			if (type == ptype_jet)
+				reco->push_back(new lhco(type, eta, phi, reco_pt, reco_mass, ntrk, btag));
+			else
+				reco->push_back(new lhco(type, eta, phi, reco_pt, 0., ntrk));
+		}
+
+		// missing transverse energy
+		reco->push_back(new lhco(ptype_met, 0., atan2(mey, mex), sqrt(mex * mex + mey * mey)));
+		return reco;
+	}
+
+	void detector_sim::simulate(const std::vector<event*> & truth, std::vector<event*> & reco, int workers) const
+	{
+		unsigned int first = reco.size();
+		reco.resize(first + truth.size(), nullptr);
+
+		// contiguous ranges of events per worker
+		unsigned int nr_workers = std::max(1, workers);
+		unsigned int range = (truth.size() + nr_workers - 1) / nr_workers;
+		std::vector<std::thread> threads;
+		for (unsigned int begin = 0; begin < truth.size(); begin += range)
+		{
+			unsigned int end = std::min<unsigned int>(truth.size(), begin + range);
+			threads.push_back(std::thread([this, &truth, &reco, first, begin, end]()
+			{
+				for (unsigned int i = begin; i < end; ++i)
+				{
+					std::seed_seq seeds = { sim_seed, i };
+					std::mt19937 rng(seeds);
+					reco[first + i] = simulate(*truth[i], rng);
+				}
+			}));
+		}
+		for (unsigned int t = 0; t < threads.size(); ++t)
+			threads[t].join();
+	}
+
+	void detector_sim::simulate(const std::vector<event*> & truth, boost::filesystem::path file, int workers) const
+	{
+		std::vector<event*> reco;
+		simulate(truth, reco, workers);
+		write_lhco(reco, file);
+		delete_events(reco);
+	}
+
+/* NAMESPACE */
+}
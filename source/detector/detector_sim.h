@@ -0,0 +1,77 @@
+/* Detector simulation class
+ *
+ * Parametrised fast detector simulation: applies efficiency tables and Gaussian
+ * pT resolutions per (|eta|, pT) bin to the truth objects of an event and 
+ * produces lhco objects, with the missing energy following the smearing.
+*/
+
+#ifndef INC_DETECTOR_SIM
+#define INC_DETECTOR_SIM
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "../event/event.h"
+#include "../particle/lhco.h"
+#include "../utility/utility.h"
+
+
+/* NAMESPACE */
+namespace analysis
+{
+
+	class detector_sim
+	{
+
+	public:
+		/* con- & destructor: reads the detector response from a settings file */
+		detector_sim(const std::string & settings_file, unsigned int seed = 5489);
+		~detector_sim();
+
+		/* simulation of a single event of lhe or lhco truth objects, returns a new lhco event */
+		event* simulate(const event & truth, std::mt19937 & rng) const;
+
+		/* simulation of a sample with several workers, each event has its own random sequence derived 
+		   from the seed and its index such that the result does not depend on the number of workers */
+		void simulate(const std::vector<event*> & truth, std::vector<event*> & reco, int workers = 1) const;
+		void simulate(const std::vector<event*> & truth, boost::filesystem::path file, int workers = 1) const;
+
+	private:
+		/* response of an object type: tables in |eta| bins (rows) and pT bins (columns) */
+		struct response
+		{
+			bool defined;
+			std::vector<double> eta_bins;
+			std::vector<double> pt_bins;
+			std::vector<double> efficiency;
+			std::vector<double> resolution;
+			std::vector<double> btag;
+			std::vector<double> mistag;
+		};
+
+		/* reading and lookup of the responses */
+		void read_response(const std::string & settings_file, const std::string & name, response & resp);
+		const response * response_of(unsigned int type) const;
+		int bin(const response & resp, double eta, double pt) const;
+
+		/* responses of the object types */
+		response resp_photon;
+		response resp_electron;
+		response resp_muon;
+		response resp_tau;
+		response resp_jet;
+		unsigned int sim_seed;
+
+	};
+
+/* NAMESPACE */
+}
+
+#endif
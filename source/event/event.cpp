@@ -3,6 +3,8 @@
  * 
 */
 
+#include <atomic>
+
 #include "event.h" 
 
 
@@ -10,10 +12,19 @@
 namespace analysis
 {
 
+	// identifiers are unique over all events of the program
+	static unsigned long long new_event_id()
+	{
+		static std::atomic<unsigned long long> last_id(0);
+		return ++last_id;
+	}
+
 	/* con & destructor */
 	
 	event::event()
 	{
+		event_id = new_event_id();
+		ev_info = nullptr;
 	}
 
 	event::~event() 
@@ -24,21 +35,28 @@ namespace analysis
 			particles[i] = nullptr;
 		}
 		particles.clear();
+		delete ev_info;
 	}
 	
 	/* copy & assignment */
 	
 	event::event(const event& ev)
 	{
-		
+		event_id = new_event_id();
 		for (unsigned int i = 0; i < ev.size(); i++)
 			particles.push_back(ev[i]->clone());
+		ev_info = ev.ev_info ? ev.ev_info->clone() : nullptr;
 	}
 
 	event & event::operator = (const event& ev)
 	{
+		// the particles are appended, the info only stays valid for an empty event
+		bool keep_info = particles.empty();
+		changed();
 		for (unsigned int i = 0; i < ev.size(); i++)
 			particles.push_back(ev[i]->clone());
+		if (keep_info && ev.ev_info)
+			ev_info = ev.ev_info->clone();
 		return *this;
 	}
 
@@ -47,13 +65,25 @@ namespace analysis
 		return new event(*this);
 	}
 
-	/* member operations */
+	/* attached info */
 
-	particle* event::operator[] (int n) 
+	void event::set_info(event_info *info)
 	{
-		return particles[n]; 
+		if (info == ev_info)
+			return;
+		delete ev_info;
+		ev_info = info;
 	}
 
+	void event::changed()
+	{
+		event_id = new_event_id();
+		delete ev_info;
+		ev_info = nullptr;
+	}
+
+	/* member operations */
+
 	const particle* event::operator[] (int n) const 
 	{
 		return particles[n]; 
@@ -67,28 +97,31 @@ namespace analysis
 	void event::resize(unsigned int n)  
 	{ 
 		particles.resize(n);
+		changed();
 	}
 
 	void event::push_back(particle *p) 
 	{ 
 		particles.push_back(p);
-		// sort particles according to pt
+		// sort particles according to pt, which also renews the id and removes the info
 		sort_pt();
 	}
 
 	void event::erase(int n)
 	{
 		particles.erase(particles.begin() + n);
+		changed();
 	}
 
 	void event::clear() 
 	{ 
 		particles.clear(); 
+		changed();
 	}
 
 	/* member access */
 
-	particle* event::get(unsigned int type, unsigned int number) const
+	const particle* event::get(unsigned int type, unsigned int number) const
 	{
 		// TODO: safety checks for number		
 		unsigned int count = 0;		
@@ -105,7 +138,7 @@ namespace analysis
 		return nullptr;
 	}
 
-	particle* event::get(unsigned int type, unsigned int number, double max_eta) const
+	const particle* event::get(unsigned int type, unsigned int number, double max_eta) const
 	{
 		// TODO: safety checks for number	
 		unsigned int count = 0;		
@@ -199,6 +232,25 @@ namespace analysis
 	
 	// returns the mt2 for the event
 	double event::mt2(double mn) const
+	{
+		// at least two leptons have to be present in order to calculate mT2
+		double pa[3], pb[3], pmiss[3];
+		if (!mt2_momenta(pa, pb, pmiss))
+			return 0;
+
+		// calculate mT2 using the two leading leptons, MET and mn as input values
+		mt2_bisect::mt2 mt2_event;
+		mt2_event.set_momenta(pa,pb,pmiss);
+		mt2_event.set_mn(mn);
+		double mt2_value = mt2_event.get_mt2();
+		
+		return mt2_value;
+
+	}
+
+	// fills the (mass,px,py) input of mt2 from the two leading leptons and MET, 
+	// returns false if less than two leptons are present
+	bool event::mt2_momenta(double *pa, double *pb, double *pmiss) const
 	{
 		// identify leptons within the event
 		std::vector< particle* > leptons;
@@ -209,9 +261,8 @@ namespace analysis
 				leptons.push_back(p);
 		}
 		// TODO: generalise?
-		// at least two leptons has to be present in order to calculate mT2
 		if (leptons.size() < 2)
-			return 0;
+			return false;
 
 		// extract MET components
 		double px_inv = 0;
@@ -226,18 +277,10 @@ namespace analysis
 			}
 		}
 
-		// calculate mT2 using the two leading leptons, MET and mn as input values
-		double pa[3]    = { 0, leptons[0]->px(), leptons[0]->py() };
-		double pb[3]    = { 0, leptons[1]->px(), leptons[1]->py() };
-		double pmiss[3] = { 0, px_inv, py_inv };
-
-		mt2_bisect::mt2 mt2_event;
-		mt2_event.set_momenta(pa,pb,pmiss);
-		mt2_event.set_mn(mn);
-		double mt2_value = mt2_event.get_mt2();
-		
-		return mt2_value;
-
+		pa[0] = 0; pa[1] = leptons[0]->px(); pa[2] = leptons[0]->py();
+		pb[0] = 0; pb[1] = leptons[1]->px(); pb[2] = leptons[1]->py();
+		pmiss[0] = 0; pmiss[1] = px_inv; pmiss[2] = py_inv;
+		return true;
 	}
 	
 	/* utility */
@@ -246,11 +289,13 @@ namespace analysis
 	void event::sort_pt()
 	{
 		std::sort(particles.begin(), particles.end(), compare_pt);
+		changed();
 	}
 	
 	void event::sort_type()
 	{
 		std::sort(particles.begin(), particles.end(), compare_type);
+		changed();
 	}
 
 	/* input & output */
@@ -321,5 +366,27 @@ namespace analysis
 		events.clear();				
 	}
 
+	// returns the mt2 of all events for each of the masses, ordered as [event][mass]
+	std::vector<double> mt2_events(const std::vector<event*> & events, const std::vector<double> & mn, int workers, double relative_precision)
+	{
+		// only events with two leptons enter the batch, the others keep mt2 = 0
+		mt2_bisect::mt2_sample sample;
+		std::vector<unsigned int> indices;
+		for (unsigned int i = 0; i < events.size(); ++i)
+		{
+			double pa[3], pb[3], pmiss[3];
+			if (!events[i]->mt2_momenta(pa, pb, pmiss))
+				continue;
+			sample.push_back(pa, pb, pmiss);
+			indices.push_back(i);
+		}
+
+		std::vector<double> sample_mt2 = mt2_bisect::mt2_batch(sample, mn, workers, relative_precision);
+		std::vector<double> result(events.size() * mn.size(), 0.);
+		for (unsigned int i = 0; i < indices.size(); ++i)
+			std::copy(sample_mt2.begin() + i * mn.size(), sample_mt2.begin() + (i + 1) * mn.size(), result.begin() + indices[i] * mn.size());
+		return result;
+	}
+
 /* NAMESPACE */
 }
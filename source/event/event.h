@@ -21,6 +21,19 @@
 namespace analysis
 {
 
+	/* derived objects of an event, e.g. reconstructed candidates, which are built
+	   once and attached to the event; they refer to the particles by index, such
+	   that copies of the event keep a valid clone of them */
+	class event_info
+	{
+
+	public:
+
+		virtual ~event_info() {}
+		virtual event_info* clone() const = 0;
+
+	};
+
 	class event
 	{
 
@@ -35,8 +48,18 @@ namespace analysis
 		event & operator = (const event& ev);
 		event* clone() const;
 
-		/* member operations */
-		particle* operator[] (int n);
+		/* unique identifier, renewed when the particles change, such that
+		   cached observables of an event can not be confused with others */
+		unsigned long long id() const { return event_id; }
+
+		/* attached derived objects: the event takes ownership of the info, which
+		   is removed together with the id when the particles change */
+		void set_info(event_info *info);
+		const event_info* info() const { return ev_info; }
+		template<class T> const T* info() const { return dynamic_cast<const T*>(ev_info); }
+
+		/* member operations: the particles are only read through the event, such
+		   that every change goes through the members renewing the id */
 		const particle* operator[] (int n) const;
 		unsigned int size() const;
 		void resize(unsigned int n);
@@ -45,8 +68,8 @@ namespace analysis
 		void clear();
 
 		/* member access */
-		particle* get(unsigned int type, unsigned int number) const;
-		particle* get(unsigned int type, unsigned int number, double max_eta) const;
+		const particle* get(unsigned int type, unsigned int number) const;
+		const particle* get(unsigned int type, unsigned int number, double max_eta) const;
 
 		/* kinematics */
 		double met() const;
@@ -54,6 +77,7 @@ namespace analysis
 		double mass() const;
 		double mass(unsigned int type, const std::vector<int> &comb) const;
 		double mt2(double mn = 0) const;
+		bool mt2_momenta(double *pa, double *pb, double *pmiss) const;
 		
 		/* utility */
 		void sort_pt();
@@ -67,14 +91,20 @@ namespace analysis
 
 	private:
 
+		/* renews the id and removes the attached info */
+		void changed();
+
 		/* event data members */
 		std::vector<particle*> particles;
+		unsigned long long event_id;
+		event_info *ev_info;
 
 	};
 	
 	/* utility functions */
 	double mass(std::vector<const particle*> particles);
 	std::vector<event*> copy_events(const std::vector<event*> & events);
+	std::vector<double> mt2_events(const std::vector<event*> & events, const std::vector<double> & mn, int workers = 1, double relative_precision = mt2_bisect::default_relative_precision);
 	void delete_events(std::vector<event*> & events);
 
 /* NAMESPACE */
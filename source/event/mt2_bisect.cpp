@@ -14,12 +14,16 @@ namespace analysis
 namespace mt2_bisect
 {
 
-	mt2::mt2()
+	mt2::mt2(double relative, double absolute)
 	{
 		solved = false;
 		momenta_set = false;
+		analytic = true;
 		mt2_b  = 0.;
 		scale = 1.;
+		mn_unscale = 0.;
+		nevt = 0;
+		set_precision(relative, absolute);
 	}
 
 	double mt2::get_mt2()
@@ -35,6 +39,12 @@ namespace mt2_bisect
 		return mt2_b*scale;
 	}
 
+	void mt2::set_analytic(bool use_analytic)
+	{
+		solved = false;
+		analytic = use_analytic;
+	}
+
 	void mt2::set_momenta(double* pa0, double* pb0, double* pmiss0)
 	{
 		solved = false;     //reset solved tag when momenta are changed.
@@ -104,10 +114,7 @@ namespace mt2_bisect
 		mn   = mn_unscale/scale; 
 		mnsq = mn*mn;
 
-		if (ABSOLUTE_PRECISION > 100.*RELATIVE_PRECISION) 
-			precision = ABSOLUTE_PRECISION;
-		else 
-			precision = 100.*RELATIVE_PRECISION;
+		set_precision(relative_precision, absolute_precision);
 	}
 
 	void mt2::set_mn(double mn0)
@@ -118,6 +125,17 @@ namespace mt2_bisect
 		mnsq = mn*mn;
 	}
 
+	void mt2::set_precision(double relative, double absolute)
+	{
+		solved = false;    //reset solved tag when the precision is changed.
+		relative_precision = relative;
+		absolute_precision = absolute;
+		if (absolute_precision > 100.*relative_precision) 
+			precision = absolute_precision;
+		else 
+			precision = 100.*relative_precision;
+	}
+
 	void mt2::print()
 	{
 		std::cout << " pax = " << pax*scale << ";   pay = " << pay*scale << ";   ma = " << ma*scale <<";"<< std::endl;
@@ -317,7 +335,10 @@ namespace mt2_bisect
 	  
 	   
 	   solved = true;
-	   std::cout.precision(11);
+
+	//closed form solutions do not need a bisection
+	   if (analytic && mt2_analytic())
+		  return;
 
 	//if masses are very small, use code for massless case.  
 	   if(masq < MIN_MASS && mbsq < MIN_MASS) 
@@ -463,6 +484,52 @@ namespace mt2_bisect
 	   return;
 	}
 
+	//closed form solutions, returns false for configurations which have to be bisected
+	bool mt2::mt2_analytic()
+	{
+	   if(masq < MIN_MASS && mbsq < MIN_MASS)
+	   {
+	//massless visible particles: for mn = 0 and missing momentum between pa and pb 
+	//both transverse masses vanish with the invisible momenta parallel to pa and pb
+		  double det = pax*pby - pay*pbx;
+		  if(mn == 0 && fabs(det) > precision*precision)
+		  {
+			 double alpha = (pmissx*pby - pmissy*pbx)/det;
+			 double beta  = (pax*pmissy - pay*pmissx)/det;
+			 if(alpha >= 0 && beta >= 0)
+			 {
+				mt2_b = 0;
+				return true;
+			 }
+		  }
+
+	//massless visible particles without upstream momentum, pmiss = -(pa+pb):
+	//mt2^2 = mn^2 + A + sqrt(A^2 + 2 mn^2 A) with A = |pa||pb| + pa.pb
+		  double upx = pmissx + pax + pbx;
+		  double upy = pmissy + pay + pby;
+		  if(sqrt(upx*upx + upy*upy) < precision)
+		  {
+			 double A = sqrt((pax*pax + pay*pay)*(pbx*pbx + pby*pby)) + pax*pbx + pay*pby;
+			 mt2_b = sqrt(mnsq + A + sqrt(A*A + 2*mnsq*A));
+			 return true;
+		  }
+		  return false;
+	   }
+
+	//unbalanced configuration (ma >= mb): the unconstrained minimum of mT(a) is ma + mn
+	//at qa = pa mn/ma, mt2 equals it when mT(b) at qb = pmiss - qa does not exceed it
+	   double qbx = pmissx - pax*mn/ma;
+	   double qby = pmissy - pay*mn/ma;
+	   double Deltasq0 = ma*(ma + 2*mn);
+	   double Deltasq_b = mbsq + 2*(Eb*sqrt(mnsq + qbx*qbx + qby*qby) - pbx*qbx - pby*qby);
+	   if(Deltasq_b <= Deltasq0)
+	   {
+		  mt2_b = ma + mn;
+		  return true;
+	   }
+	   return false;
+	}
+
 	int mt2::find_high(double & Deltasq_high)
 	{
 	   double x0,y0;
@@ -636,6 +703,54 @@ namespace mt2_bisect
 	   return nsc;
 	}
 
+	void mt2_sample::push_back(const double *pa, const double *pb, const double *pmiss)
+	{
+		ma.push_back(pa[0]); pax.push_back(pa[1]); pay.push_back(pa[2]);
+		mb.push_back(pb[0]); pbx.push_back(pb[1]); pby.push_back(pb[2]);
+		pmissx.push_back(pmiss[1]); pmissy.push_back(pmiss[2]);
+	}
+
+	std::vector<double> mt2_batch(const mt2_sample & sample, const std::vector<double> & mn, int workers, double relative_precision)
+	{
+		unsigned int nr_events = sample.size();
+		unsigned int nr_masses = mn.size();
+		std::vector<double> result(nr_events * nr_masses, 0.);
+		
+		// the momenta of an event are set and scaled once, the bisection is then repeated for each mass
+		auto solve_range = [&](unsigned int begin, unsigned int end)
+		{
+			mt2 mt2_event(relative_precision);
+			for (unsigned int i = begin; i < end; ++i)
+			{
+				double pa[3] = { sample.ma[i], sample.pax[i], sample.pay[i] };
+				double pb[3] = { sample.mb[i], sample.pbx[i], sample.pby[i] };
+				double pmiss[3] = { 0, sample.pmissx[i], sample.pmissy[i] };
+				mt2_event.nevt = i;
+				mt2_event.set_momenta(pa, pb, pmiss);
+				for (unsigned int m = 0; m < nr_masses; ++m)
+				{
+					mt2_event.set_mn(mn[m]);
+					result[i * nr_masses + m] = mt2_event.get_mt2();
+				}
+			}
+		};
+
+		// contiguous ranges of events for each worker
+		unsigned int nr_workers = std::max(1, std::min<int>(workers, nr_events));
+		if (nr_workers == 1)
+		{
+			solve_range(0, nr_events);
+			return result;
+		}
+		std::vector<std::thread> threads;
+		unsigned int range = (nr_events + nr_workers - 1) / nr_workers;
+		for (unsigned int begin = 0; begin < nr_events; begin += range)
+			threads.push_back(std::thread(solve_range, begin, std::min(nr_events, begin + range)));
+		for (unsigned int t = 0; t < threads.size(); ++t)
+			threads[t].join();
+		return result;
+	}
+
 /* NAMESPACE */
 }
 }
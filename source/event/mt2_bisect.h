@@ -16,7 +16,7 @@
   2. Set momenta and the mass of the invisible particle, mn:
  
      mt2_event.set_momenta( pa, pb, pmiss );
-     mt2_event.set_mass( mn );
+     mt2_event.set_mn( mn );
  
      where array pa[0..2], pb[0..2], pmiss[0..2] contains (mass,px,py) 
      for the visible particles and the missing momentum. pmiss[0] is not used. 
@@ -25,14 +25,28 @@
   3. Use mt2::get_mt2() to obtain the value of mt2:
 
      double mt2_value = mt2_event.get_mt2();       
+
+  4. For a whole sample and several invisible masses fill an mt2_sample and 
+     use mt2_batch, which returns the values ordered as [event][mass]:
+
+     std::vector<double> mt2_values = mt2_batch( sample, mn_list, workers );
+
+  The precision is passed to the constructor, to set_precision or to mt2_batch,
+  such that coarse scans and precise final values can be combined. Closed form
+  solutions (unbalanced configurations, massless visible particles without
+  upstream momentum or with the missing momentum between them for mn = 0) are
+  evaluated directly, all other configurations are bisected.
           
 *******************************************************************************/ 
 
 #ifndef INC_MT2_BISECT
 #define INC_MT2_BISECT
 
+#include <algorithm>
 #include <iostream>
 #include <math.h>
+#include <thread>
+#include <vector>
 
 
 /* NAMESPACE */
@@ -41,10 +55,10 @@ namespace analysis
 namespace mt2_bisect
 {
 
-	/*The user can change the desired precision below, the larger one of the following two definitions is used. Relative precision less than 0.00001 is not guaranteed to be achievable--use with caution*/ 
+	/*The desired precision is set per instance, the larger one of the relative and absolute precision is used. Relative precision less than 0.00001 is not guaranteed to be achievable--use with caution*/ 
 
-	#define RELATIVE_PRECISION 0.00001 //defined as precision = RELATIVE_PRECISION * scale, where scale = max{Ea, Eb}
-	#define ABSOLUTE_PRECISION 0.0     //absolute precision for mt2, unused by default
+	const double default_relative_precision = 0.00001; //defined as precision = relative_precision * scale, where scale = max{Ea, Eb}
+	const double default_absolute_precision = 0.0;     //absolute precision for mt2, unused by default
 
 	//Reserved for expert
 	#define MIN_MASS  0.1   //if ma<MINMASS and mb<MINMASS, use massless code
@@ -55,11 +69,13 @@ namespace mt2_bisect
 	{  
 	public:
 
-		mt2();
+		mt2(double relative_precision = default_relative_precision, double absolute_precision = default_absolute_precision);
 		void   mt2_bisect();
 		void   mt2_massless();
 		void   set_momenta(double *pa0, double *pb0, double* pmiss0);
 		void   set_mn(double mn);
+		void   set_precision(double relative_precision, double absolute_precision = default_absolute_precision);
+		void   set_analytic(bool use_analytic); //closed form solutions are used by default, disable to always bisect
 		double get_mt2();
 		void   print();
 		int    nevt;
@@ -68,8 +84,10 @@ namespace mt2_bisect
 
 		bool   solved;
 		bool   momenta_set;
+		bool   analytic;
 		double mt2_b;
 
+		bool mt2_analytic();
 		int nsols(double Dsq);
 		int nsols_massless(double Dsq);
 		inline int signchange_n(long double t1, long double t2, long double t3, long double t4, long double t5);
@@ -95,9 +113,24 @@ namespace mt2_bisect
 
 		double scale;
 		double precision;
+		double relative_precision, absolute_precision;
 		  
 	};
 
+	/* visible and missing momenta (mass,px,py) of a sample in separate arrays */
+	struct mt2_sample
+	{
+		std::vector<double> ma, pax, pay;
+		std::vector<double> mb, pbx, pby;
+		std::vector<double> pmissx, pmissy;
+
+		unsigned int size() const { return pax.size(); }
+		void push_back(const double *pa, const double *pb, const double *pmiss);
+	};
+
+	/* mt2 of all events in the sample for each of the invisible masses, ordered as [event][mass] */
+	std::vector<double> mt2_batch(const mt2_sample & sample, const std::vector<double> & mn, int workers = 1, double relative_precision = default_relative_precision);
+
 /* NAMESPACE */
 }
 }
@@ -0,0 +1,208 @@
+/* Observables class
+ *
+ * Registry of named event observables, which are computed lazily at most once
+ * per event into cached columns. Cuts and plots refer to the observables by
+ * name or handle and share the computed values.
+*/
+
+#include "observables.h"
+
+
+/* NAMESPACE */
+namespace analysis
+{
+
+	/* con & destructor */
+
+	observables::observables() : computed_values(0) {}
+
+	/* registering observables */
+
+	unsigned int observables::add(const std::string & name, observable_function f)
+	{
+		std::unordered_map<std::string, unsigned int>::const_iterator it = list_handles.find(name);
+		if (it != list_handles.end())
+			return it->second;
+
+		list_names.push_back(name);
+		list_functions.push_back(f);
+		list_handles[name] = list_names.size() - 1;
+		columns.push_back(std::vector<double>(rows.size(), 0));
+		columns_set.push_back(std::vector<char>(rows.size(), 0));
+		return list_names.size() - 1;
+	}
+
+	bool observables::has(const std::string & name) const
+	{
+		return list_handles.count(name) > 0;
+	}
+
+	unsigned int observables::handle(const std::string & name) const
+	{
+		std::unordered_map<std::string, unsigned int>::const_iterator it = list_handles.find(name);
+		if (it == list_handles.end())
+		{
+			std::cout << "Error: observable " << name << " is not registered." << std::endl;
+			exit (EXIT_FAILURE);
+		}
+		return it->second;
+	}
+
+	/* cached values */
+
+	void observables::prepare(const std::vector<event*> & events)
+	{
+		// a sample without any known event starts new columns, such that 
+		// the cache does not grow over many samples
+		bool known = false;
+		for (unsigned int i = 0; i < events.size() && !known; ++i)
+			known = rows.count(events[i]->id()) > 0;
+		if (!known)
+			clear();
+
+		for (unsigned int i = 0; i < events.size(); ++i)
+			rows.insert(std::make_pair(events[i]->id(), static_cast<unsigned int>(rows.size())));
+		for (unsigned int h = 0; h < columns.size(); ++h)
+		{
+			columns[h].resize(rows.size(), 0);
+			columns_set[h].resize(rows.size(), 0);
+		}
+	}
+
+	double observables::value(const event *ev, unsigned int h)
+	{
+		std::unordered_map<unsigned long long, unsigned int>::const_iterator it = rows.find(ev->id());
+		if (it == rows.end())
+		{
+			computed_values.fetch_add(1, std::memory_order_relaxed);
+			return list_functions[h](ev);
+		}
+
+		// each row belongs to one event, so different events can be evaluated concurrently
+		unsigned int row = it->second;
+		if (!columns_set[h][row])
+		{
+			columns[h][row] = list_functions[h](ev);
+			columns_set[h][row] = 1;
+			computed_values.fetch_add(1, std::memory_order_relaxed);
+		}
+		return columns[h][row];
+	}
+
+	void observables::clear()
+	{
+		rows.clear();
+		for (unsigned int h = 0; h < columns.size(); ++h)
+		{
+			std::vector<double>().swap(columns[h]);
+			std::vector<char>().swap(columns_set[h]);
+		}
+	}
+
+	/* common observables */
+
+	observable_function observable_pt(unsigned int type, unsigned int number, double max_eta)
+	{
+		return [type, number, max_eta](const event *ev)
+		{
+			const particle *p = ev->get(type, number, max_eta);
+			return p ? p->pt() : 0.0;
+		};
+	}
+
+	observable_function observable_eta(unsigned int type, unsigned int number)
+	{
+		return [type, number](const event *ev)
+		{
+			const particle *p = ev->get(type, number);
+			return p ? p->eta() : 0.0;
+		};
+	}
+
+	observable_function observable_phi(unsigned int type, unsigned int number)
+	{
+		return [type, number](const event *ev)
+		{
+			const particle *p = ev->get(type, number);
+			return p ? p->phi() : 0.0;
+		};
+	}
+
+	observable_function observable_met()
+	{
+		return [](const event *ev) { return ev->met(); };
+	}
+
+	observable_function observable_ht(unsigned int type, double min_pt, double max_eta)
+	{
+		return [type, min_pt, max_eta](const event *ev) { return ev->ht(type, min_pt, max_eta); };
+	}
+
+	observable_function observable_mass(unsigned int type, const std::vector<int> & comb)
+	{
+		return [type, comb](const event *ev) { return ev->mass(type, comb); };
+	}
+
+	observable_function observable_mt2(double mn)
+	{
+		return [mn](const event *ev) { return ev->mt2(mn); };
+	}
+
+	/* registering common observables */
+
+	observables & default_observables()
+	{
+		static observables obs;
+		return obs;
+	}
+
+	std::string observable_name(const std::string & name, const std::vector<double> & parameters)
+	{
+		// full precision, such that different parameters never share a name
+		std::ostringstream ss;
+		ss.precision(17);
+		ss << name << "(";
+		for (unsigned int i = 0; i < parameters.size(); ++i)
+			ss << (i > 0 ? "," : "") << parameters[i];
+		ss << ")";
+		return ss.str();
+	}
+
+	unsigned int add_pt(observables & obs, unsigned int type, unsigned int number, double max_eta)
+	{
+		return obs.add(observable_name("pt", {static_cast<double>(type), static_cast<double>(number), max_eta}),
+			observable_pt(type, number, max_eta));
+	}
+
+	unsigned int add_eta(observables & obs, unsigned int type, unsigned int number)
+	{
+		return obs.add(observable_name("eta", {static_cast<double>(type), static_cast<double>(number)}),
+			observable_eta(type, number));
+	}
+
+	unsigned int add_phi(observables & obs, unsigned int type, unsigned int number)
+	{
+		return obs.add(observable_name("phi", {static_cast<double>(type), static_cast<double>(number)}),
+			observable_phi(type, number));
+	}
+
+	unsigned int add_met(observables & obs)
+	{
+		return obs.add("met", observable_met());
+	}
+
+	unsigned int add_ht(observables & obs, unsigned int type, double min_pt, double max_eta)
+	{
+		return obs.add(observable_name("ht", {static_cast<double>(type), min_pt, max_eta}),
+			observable_ht(type, min_pt, max_eta));
+	}
+
+	unsigned int add_mass(observables & obs, unsigned int type, const std::vector<int> & comb)
+	{
+		std::vector<double> parameters(1, static_cast<double>(type));
+		parameters.insert(parameters.end(), comb.begin(), comb.end());
+		return obs.add(observable_name("mass", parameters), observable_mass(type, comb));
+	}
+
+/* NAMESPACE */
+}
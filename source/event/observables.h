@@ -0,0 +1,99 @@
+/* Observables class
+ *
+ * Registry of named event observables, which are computed lazily at most once
+ * per event into cached columns. Cuts and plots refer to the observables by
+ * name or handle and share the computed values.
+*/
+
+#ifndef INC_OBSERVABLES
+#define INC_OBSERVABLES
+
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "event.h"
+
+
+/* NAMESPACE */
+namespace analysis
+{
+
+	/* an observable computes one value of an event */
+	typedef std::function<double (const event*)> observable_function;
+
+	class observables
+	{
+
+	public:
+
+		/* con & destructor */
+		observables();
+
+		/* registering observables: returns the handle of the name, an existing
+		   name keeps its function */
+		unsigned int add(const std::string & name, observable_function f);
+		bool has(const std::string & name) const;
+		unsigned int handle(const std::string & name) const;
+		const std::string & name(unsigned int h) const { return list_names[h]; }
+		unsigned int size() const { return list_names.size(); }
+
+		/* cached values: prepare assigns rows to the events of a sample, afterwards
+		   the values of different events can be requested concurrently; values of
+		   events which were not prepared are computed but not cached */
+		void prepare(const std::vector<event*> & events);
+		double value(const event *ev, unsigned int h);
+		double value(const event *ev, const std::string & name) { return value(ev, handle(name)); }
+		void clear();
+
+		/* number of values computed so far, e.g. to check the caching */
+		unsigned long nr_computed() const { return computed_values; }
+
+	private:
+
+		/* registered observables */
+		std::vector<std::string> list_names;
+		std::vector<observable_function> list_functions;
+		std::unordered_map<std::string, unsigned int> list_handles;
+
+		/* one row per event and one column per observable */
+		std::unordered_map<unsigned long long, unsigned int> rows;
+		std::vector< std::vector<double> > columns;
+		std::vector< std::vector<char> > columns_set;
+		/* only counts, so concurrent evaluations increment it relaxed */
+		std::atomic<unsigned long> computed_values;
+
+	};
+
+	/* common observables */
+	observable_function observable_pt(unsigned int type, unsigned int number, double max_eta = 5.0);
+	observable_function observable_eta(unsigned int type, unsigned int number);
+	observable_function observable_phi(unsigned int type, unsigned int number);
+	observable_function observable_met();
+	observable_function observable_ht(unsigned int type, double min_pt = 0.0, double max_eta = 5.0);
+	observable_function observable_mass(unsigned int type, const std::vector<int> & comb);
+	observable_function observable_mt2(double mn = 0);
+
+	/* registry shared by the default cuts and plots, such that equal observables
+	   of an event are computed once for all of them */
+	observables & default_observables();
+
+	/* name of an observable with its parameters, e.g. "ht(4,30,3)" */
+	std::string observable_name(const std::string & name, const std::vector<double> & parameters);
+
+	/* registering the common observables under the name of their parameters */
+	unsigned int add_pt(observables & obs, unsigned int type, unsigned int number, double max_eta = 5.0);
+	unsigned int add_eta(observables & obs, unsigned int type, unsigned int number);
+	unsigned int add_phi(observables & obs, unsigned int type, unsigned int number);
+	unsigned int add_met(observables & obs);
+	unsigned int add_ht(observables & obs, unsigned int type, double min_pt = 0.0, double max_eta = 5.0);
+	unsigned int add_mass(observables & obs, unsigned int type, const std::vector<int> & comb);
+
+/* NAMESPACE */
+}
+
+#endif
@@ -0,0 +1,186 @@
+/* Overlap removal class
+ *
+ * Applies a sequence of overlap removal rules to events: each rule removes the
+ * objects of one type within a deltaR cone of the remaining objects of another
+ * type. The reference objects are swept in eta order, such that a rule costs
+ * O((n + m) log m) instead of O(n m), and the removed objects are counted per rule.
+*/
+
+#include <sstream>
+#include <utility>
+
+#include "overlap_removal.h"
+
+
+/* NAMESPACE */
+namespace analysis
+{
+
+	/* con & destructor */
+
+	overlap_removal::overlap_removal() {}
+
+	/* rules */
+
+	void overlap_removal::add_rule(const std::string & name, unsigned int remove_type, unsigned int reference_type, double delta_r, bool rapidity)
+	{
+		if (delta_r < 0)
+		{
+			std::cout << "Error: overlap removal rule " << name << " has a negative deltaR." << std::endl;
+			exit (EXIT_FAILURE);
+		}
+		list_names.push_back(name);
+		list_remove_types.push_back(remove_type);
+		list_reference_types.push_back(reference_type);
+		list_delta_r.push_back(delta_r);
+		list_rapidity.push_back(rapidity);
+		list_removed.push_back(0);
+	}
+
+	void overlap_removal::clear()
+	{
+		list_names.clear();
+		list_remove_types.clear();
+		list_reference_types.clear();
+		list_delta_r.clear();
+		list_rapidity.clear();
+		list_removed.clear();
+	}
+
+	/* application */
+
+	unsigned int overlap_removal::apply(event *ev)
+	{
+		std::vector<unsigned long long> removed;
+		unsigned int nr_removed = apply(ev, removed);
+		add_removed(removed);
+		return nr_removed;
+	}
+
+	unsigned int overlap_removal::apply(const std::vector<event*> & events)
+	{
+		unsigned int nr_removed = 0;
+		for (unsigned int i = 0; i < events.size(); ++i)
+			nr_removed += apply(events[i]);
+		return nr_removed;
+	}
+
+	unsigned int overlap_removal::apply(event *ev, std::vector<unsigned long long> & removed) const
+	{
+		removed.resize(nr_rules(), 0);
+		unsigned int n = ev->size();
+		if (n == 0)
+			return 0;
+
+		// kinematics of the particles, the rapidity only if a rule needs it
+		std::vector<double> eta(n), y, phi(n);
+		for (unsigned int i = 0; i < n; ++i)
+		{
+			eta[i] = (*ev)[i]->eta();
+			phi[i] = (*ev)[i]->phi();
+		}
+		if (std::find(list_rapidity.begin(), list_rapidity.end(), true) != list_rapidity.end())
+		{
+			y.resize(n);
+			for (unsigned int i = 0; i < n; ++i)
+				y[i] = (*ev)[i]->y();
+		}
+
+		std::vector<char> is_removed(n, 0);
+		std::vector< std::pair<double, unsigned int> > references;
+		std::vector<unsigned int> overlapping;
+		for (unsigned int rule = 0; rule < nr_rules(); ++rule)
+		{
+			const std::vector<double> & coord = list_rapidity[rule] ? y : eta;
+			double dr = list_delta_r[rule];
+			double dr2 = dr * dr;
+
+			// remaining reference objects, sorted in eta
+			references.clear();
+			for (unsigned int i = 0; i < n; ++i)
+			{
+				if (!is_removed[i] && (*ev)[i]->type() & list_reference_types[rule])
+					references.push_back(std::make_pair(coord[i], i));
+			}
+			if (references.empty())
+				continue;
+			std::sort(references.begin(), references.end());
+
+			// only the references within the eta window of a candidate are visited, all
+			// references stay until the rule is done
+			overlapping.clear();
+			for (unsigned int i = 0; i < n; ++i)
+			{
+				if (is_removed[i] || !((*ev)[i]->type() & list_remove_types[rule]))
+					continue;
+				std::vector< std::pair<double, unsigned int> >::const_iterator it;
+				it = std::lower_bound(references.begin(), references.end(), std::make_pair(coord[i] - dr, 0u));
+				for (; it != references.end() && it->first < coord[i] + dr; ++it)
+				{
+					if (it->second == i)
+						continue;
+					double deta = coord[i] - it->first;
+					double dphi = std::abs(phi[i] - phi[it->second]);
+					dphi = std::min(dphi, 2 * M_PI - dphi);
+					if (deta * deta + dphi * dphi < dr2)
+					{
+						overlapping.push_back(i);
+						break;
+					}
+				}
+			}
+			for (unsigned int k = 0; k < overlapping.size(); ++k)
+				is_removed[overlapping[k]] = 1;
+			removed[rule] += overlapping.size();
+		}
+
+		// delete the removed particles, the last first such that the indices stay valid
+		unsigned int nr_removed = 0;
+		for (unsigned int i = n; i-- > 0; )
+		{
+			if (!is_removed[i])
+				continue;
+			delete (*ev)[i];
+			ev->erase(i);
+			nr_removed++;
+		}
+		return nr_removed;
+	}
+
+	void overlap_removal::add_removed(const std::vector<unsigned long long> & removed)
+	{
+		for (unsigned int rule = 0; rule < removed.size() && rule < nr_rules(); ++rule)
+			list_removed[rule] += removed[rule];
+	}
+
+	void overlap_removal::reset_counters()
+	{
+		list_removed.assign(nr_rules(), 0);
+	}
+
+	/* input & output */
+
+	std::string overlap_removal::settings() const
+	{
+		std::ostringstream oss;
+		oss.precision(17);
+		for (unsigned int rule = 0; rule < nr_rules(); ++rule)
+		{
+			oss << (rule > 0 ? " " : "") << list_names[rule] << " " << list_remove_types[rule] << " ";
+			oss << list_reference_types[rule] << " " << list_delta_r[rule] << " " << list_rapidity[rule];
+		}
+		return oss.str();
+	}
+
+	void overlap_removal::write(std::ostream& os) const
+	{
+		os << "Removed objects for each of the overlap removal rules:" << std::endl;
+		for (unsigned int rule = 0; rule < nr_rules(); ++rule)
+		{
+			os << "rule: " << list_names[rule] << " (" << ptype_to_string(list_remove_types[rule]) << " within deltaR<";
+			os << list_delta_r[rule] << " of " << ptype_to_string(list_reference_types[rule]) << ") -> removed: " << list_removed[rule] << std::endl;
+		}
+	}
+
+/* NAMESPACE */
+}
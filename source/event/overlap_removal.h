@@ -0,0 +1,77 @@
+/* Overlap removal class
+ *
+ * Applies a sequence of overlap removal rules to events: each rule removes the
+ * objects of one type within a deltaR cone of the remaining objects of another
+ * type. The reference objects are swept in eta order, such that a rule costs
+ * O((n + m) log m) instead of O(n m), and the removed objects are counted per rule.
+*/
+
+#ifndef INC_OVERLAP_REMOVAL
+#define INC_OVERLAP_REMOVAL
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "event.h"
+
+
+/* NAMESPACE */
+namespace analysis
+{
+
+	class overlap_removal
+	{
+
+	public:
+
+		/* con & destructor */
+		overlap_removal();
+
+		/* rules are applied in the order they are added: objects of remove_type within
+		   deltaR < delta_r of an object of reference_type are removed, the objects removed
+		   by previous rules are no references anymore; optionally the rapidity is used
+		   instead of eta */
+		void add_rule(const std::string & name, unsigned int remove_type, unsigned int reference_type, double delta_r, bool rapidity = false);
+		unsigned int nr_rules() const { return list_names.size(); }
+		const std::string & rule_name(unsigned int rule) const { return list_names[rule]; }
+		void clear();
+
+		/* removes and deletes the overlapping particles, returns the number of removed particles */
+		unsigned int apply(event *ev);
+		unsigned int apply(const std::vector<event*> & events);
+
+		/* for concurrent use: counts the removed particles per rule in removed, which can
+		   be added to the counters afterwards */
+		unsigned int apply(event *ev, std::vector<unsigned long long> & removed) const;
+		void add_removed(const std::vector<unsigned long long> & removed);
+
+		/* counters of removed particles per rule */
+		unsigned long long removed(unsigned int rule) const { return list_removed[rule]; }
+		void reset_counters();
+
+		/* input & output: settings are the rules without the counters */
+		std::string settings() const;
+		void write(std::ostream& os) const;
+
+	private:
+
+		/* rules */
+		std::vector<std::string> list_names;
+		std::vector<unsigned int> list_remove_types;
+		std::vector<unsigned int> list_reference_types;
+		std::vector<double> list_delta_r;
+		std::vector<bool> list_rapidity;
+
+		/* removed particles per rule */
+		std::vector<unsigned long long> list_removed;
+
+	};
+
+/* NAMESPACE */
+}
+
+#endif
@@ -15,7 +15,10 @@ namespace analysis
 
 	cut_gres::cut_gres()
 	{
-		topology = {1, 2};		
+		topology = {1, 2};
+		nr_jets = 0;
+		nr_combinations = 0;
+		kernel = nullptr;
 	}
 
 	void cut_gres::init()
@@ -30,6 +33,8 @@ namespace analysis
 		calc_combinations();
 		// calculate all pairing of resonance combinations
 		calc_pairings();
+		// select the evaluation kernel for this topology
+		calc_kernel();
 
 		// LOGGING: topology
 		std::cout << "CUT_GRES: reduced topology: {";
@@ -84,8 +89,10 @@ namespace analysis
 
 			}
 			std::cout << "]" << std::endl;
-		}		
+		}
 
+		// LOGGING: evaluation kernel
+		std::cout << "CUT_GRES: using " << (kernel ? "specialised" : "generic") << " kernel for this topology" << std::endl;
 	}
 
 	/*bool cut_gres::passed(const event *ev) 
@@ -102,110 +109,47 @@ namespace analysis
 
 	bool cut_gres::operator() (const event *ev)
 	{
-		// event did not pass by default
-		bool has_passed = false;
+		check_init();
 
-		// loop over all resonance pairings
-		for (unsigned int i = 0; i < nr_combinations; ++i)
-		{
-			std::vector< std::vector<unsigned int> > pair = resonance_pairings[i];
-			bool pair_passed = true;			
-	
-			// loop over all resonances in the pair
-			for (unsigned int j = 0; j < pair.size(); j++)
-			{
-				std::vector<unsigned int> comb = pair[j];
-				
-				// construct the resonance event
-				event *res = new event;
-				for	(unsigned int k = 0; k < comb.size(); k++)
-					res->push_back(ev->get(ptype_jet, comb[k], 2.8));
-
-				// check whether the pair passed the cuts
-				if (res->mass() < reduced_cuts[j])
-					pair_passed = false;
-	
-			}
-			
-			// all pairs passed the cuts
-			if (pair_passed)
-			{
-				has_passed = true;	
-				break;
-			}
-		}
+		// cache the four-vectors of the leading jets once on the stack
+		double jets[gres_max_jets][4];
+		if (!fill_jets(ev, jets, nr_jets))
+			return false;
 
-		return has_passed;		
+		// use the specialised kernel if one was selected in init()
+		if (kernel)
+			return kernel(jets, &reduced_cuts_sq[0]);
+		return passed_generic(jets);
 	}
 
 	// special case for topology {2,1}
 	bool cut_gres::passed_top21(const event *ev)
 	{
-		bool has_passed = false;
-		std::vector< std::vector<int> > combinations = {{1, 2}, {1, 3}, {2, 3}};
-		for (unsigned int i = 0; i < combinations.size(); i++)
-		{
-			particle *p1 = ev->get(ptype_jet, combinations[i][0], 2.8);
-			particle *p2 = ev->get(ptype_jet, combinations[i][1], 2.8);
-			event *jets = new event;
-			jets->push_back(p1); jets->push_back(p2);
-			
-			if (jets->mass() > reduced_cuts[0])
-			{
-				has_passed = true;
-				break;
-			}
-		}
-		return has_passed;		
+		check_init();
+		double jets[gres_max_jets][4];
+		if (!fill_jets(ev, jets, 3))
+			return false;
+		return kernel_2<3>(jets, &reduced_cuts_sq[0]);
 	}
 
 	// special case for topology {3,1}
 	bool cut_gres::passed_top31(const event *ev)
 	{
-		bool has_passed = false;		
-		std::vector< std::vector<int> > combinations = {{1, 2, 3}, {1, 2, 4}, {1, 3, 4}, {2, 3, 4}};
-		for (unsigned int i = 0; i < combinations.size(); i++)
-		{
-			particle *p1 = ev->get(ptype_jet, combinations[i][0], 2.8);
-			particle *p2 = ev->get(ptype_jet, combinations[i][1], 2.8);
-			particle *p3 = ev->get(ptype_jet, combinations[i][2], 2.8);
-			event *jets = new event;
-			jets->push_back(p1); jets->push_back(p2); jets->push_back(p3);
-			
-			if (jets->mass() > reduced_cuts[0])
-			{
-				has_passed = true;
-				break;
-			}
-		}
-		return has_passed;
+		check_init();
+		double jets[gres_max_jets][4];
+		if (!fill_jets(ev, jets, 4))
+			return false;
+		return kernel_3<4>(jets, &reduced_cuts_sq[0]);
 	}
 
 	// special case for topology {2,2}
 	bool cut_gres::passed_top22(const event *ev)
 	{
-		bool has_passed = false;
-		std::vector< std::vector<int> > comb1 = {{1, 2}, {1, 3}, {1, 4}, {2, 3}, {2, 4}, {3, 4}};
-		std::vector< std::vector<int> > comb2 = {{3, 4}, {2, 4}, {2, 3}, {1, 4}, {1, 3}, {1, 2}};
-		for (unsigned int i = 0; i < comb1.size(); i++)
-		{
-			event *res1 = new event;
-			particle *p1 = ev->get(ptype_jet, comb1[i][0], 2.8);
-			particle *p2 = ev->get(ptype_jet, comb1[i][1], 2.8);
-			res1->push_back(p1); res1->push_back(p2);
-
-			event *res2 = new event;
-			particle *p3 = ev->get(ptype_jet, comb2[i][0], 2.8);
-			particle *p4 = ev->get(ptype_jet, comb2[i][1], 2.8);
-			res2->push_back(p3); res2->push_back(p4);
-			
-			if (res1->mass() > reduced_cuts[0] && res2->mass() > reduced_cuts[1])
-			{
-				has_passed = true;
-				break;
-			}
-		}
-		return has_passed;
+		check_init();
+		double jets[gres_max_jets][4];
+		if (!fill_jets(ev, jets, 4))
+			return false;
+		return kernel_22<4>(jets, &reduced_cuts_sq[0]);
 	}
 
 	std::string cut_gres::name() const
@@ -373,5 +317,184 @@ namespace analysis
 		return is_valid;
 	}
 
+	// selects a specialised kernel for the common topologies and flattens the pairings for the generic case
+	void cut_gres::calc_kernel()
+	{
+		if (nr_jets > gres_max_jets)
+		{
+			std::cout << "Error: cut_gres supports at most " << gres_max_jets << " jets, topology has " << nr_jets << "." << std::endl;
+			exit (EXIT_FAILURE);
+		}
+
+		// a resonance passes if its mass is strictly above the cut, i.e. its squared mass strictly 
+		// above the squared cut, a mass is never negative so negative cuts always pass
+		reduced_cuts_sq.clear();
+		for (unsigned int i = 0; i < reduced_cuts.size(); i++)
+			reduced_cuts_sq.push_back(reduced_cuts[i] >= 0 ? reduced_cuts[i] * reduced_cuts[i] : -HUGE_VAL);
+		// the special cases access the cuts without checking the topology
+		while (reduced_cuts_sq.size() < 2)
+			reduced_cuts_sq.push_back(-HUGE_VAL);
+
+		// store the pairings as consecutive zero-based jet indices
+		flat_pairings.clear();
+		for (unsigned int i = 0; i < resonance_pairings.size(); i++)
+			for (unsigned int j = 0; j < resonance_pairings[i].size(); j++)
+				for (unsigned int k = 0; k < resonance_pairings[i][j].size(); k++)
+					flat_pairings.push_back(resonance_pairings[i][j][k] - 1);
+
+		kernel = nullptr;
+		if (reduced_topology.size() == 1 && reduced_topology[0] == 2)
+		{
+			switch (nr_jets)
+			{
+				case 2: kernel = &kernel_2<2>; break;
+				case 3: kernel = &kernel_2<3>; break;
+				case 4: kernel = &kernel_2<4>; break;
+				case 5: kernel = &kernel_2<5>; break;
+				case 6: kernel = &kernel_2<6>; break;
+			}
+		}
+		else if (reduced_topology.size() == 1 && reduced_topology[0] == 3)
+		{
+			switch (nr_jets)
+			{
+				case 3: kernel = &kernel_3<3>; break;
+				case 4: kernel = &kernel_3<4>; break;
+				case 5: kernel = &kernel_3<5>; break;
+				case 6: kernel = &kernel_3<6>; break;
+			}
+		}
+		else if (reduced_topology.size() == 2 && reduced_topology[0] == 2 && reduced_topology[1] == 2)
+		{
+			switch (nr_jets)
+			{
+				case 4: kernel = &kernel_22<4>; break;
+				case 5: kernel = &kernel_22<5>; break;
+				case 6: kernel = &kernel_22<6>; break;
+			}
+		}
+	}
+
+	// the squared cuts, pairings and kernel are only known after init()
+	void cut_gres::check_init() const
+	{
+		if (reduced_cuts_sq.empty())
+		{
+			std::cout << "Error: cut_gres has to be initialised with init() before it is applied." << std::endl;
+			exit (EXIT_FAILURE);
+		}
+	}
+
+	// stores (px, py, pz, pe) of the first n jets within |eta| < 2.8, returns false if there are fewer
+	bool cut_gres::fill_jets(const event *ev, double jets[][4], unsigned int n) const
+	{
+		unsigned int count = 0;
+		for (unsigned int index = 0; index < ev->size() && count < n; index++)
+		{
+			const particle *p = (*ev)[index];
+			if (p->is_final() && (p->type() & ptype_jet) && std::abs(p->eta()) < 2.8)
+			{
+				jets[count][0] = p->px();
+				jets[count][1] = p->py();
+				jets[count][2] = p->pz();
+				jets[count][3] = p->pe();
+				count++;
+			}
+		}
+		return count == n;
+	}
+
+	// loops over the flattened resonance pairings for any topology
+	bool cut_gres::passed_generic(const double jets[][4]) const
+	{
+		unsigned int pos = 0;
+		for (unsigned int i = 0; i < nr_combinations; ++i)
+		{
+			bool pair_passed = true;
+			for (unsigned int j = 0; j < reduced_topology.size(); j++)
+			{
+				double pe = 0.0; double px = 0.0; double py = 0.0; double pz = 0.0;
+				for (int k = 0; k < reduced_topology[j]; k++)
+				{
+					const double *p = jets[flat_pairings[pos++]];
+					px += p[0]; py += p[1]; pz += p[2]; pe += p[3];
+				}
+				if (!(pe * pe - px * px - py * py - pz * pz > reduced_cuts_sq[j]))
+					pair_passed = false;
+			}
+			if (pair_passed)
+				return true;
+		}
+		return false;
+	}
+
+	// topology {2} plus single resonances: any jet pair above the cut
+	template <unsigned int NJ>
+	bool cut_gres::kernel_2(const double jets[][4], const double *cuts_sq)
+	{
+		for (unsigned int i = 0; i < NJ; i++)
+			for (unsigned int j = i + 1; j < NJ; j++)
+			{
+				double pe = jets[i][3] + jets[j][3];
+				double px = jets[i][0] + jets[j][0];
+				double py = jets[i][1] + jets[j][1];
+				double pz = jets[i][2] + jets[j][2];
+				if (pe * pe - px * px - py * py - pz * pz > cuts_sq[0])
+					return true;
+			}
+		return false;
+	}
+
+	// topology {3} plus single resonances: any jet triplet above the cut
+	template <unsigned int NJ>
+	bool cut_gres::kernel_3(const double jets[][4], const double *cuts_sq)
+	{
+		for (unsigned int i = 0; i < NJ; i++)
+			for (unsigned int j = i + 1; j < NJ; j++)
+				for (unsigned int k = j + 1; k < NJ; k++)
+				{
+					double pe = jets[i][3] + jets[j][3] + jets[k][3];
+					double px = jets[i][0] + jets[j][0] + jets[k][0];
+					double py = jets[i][1] + jets[j][1] + jets[k][1];
+					double pz = jets[i][2] + jets[j][2] + jets[k][2];
+					if (pe * pe - px * px - py * py - pz * pz > cuts_sq[0])
+						return true;
+				}
+		return false;
+	}
+
+	// topology {2,2} plus single resonances: two disjoint jet pairs, each above its own cut
+	template <unsigned int NJ>
+	bool cut_gres::kernel_22(const double jets[][4], const double *cuts_sq)
+	{
+		// all pair masses are needed for both resonances, compute them once
+		double mass_sq[NJ][NJ];
+		for (unsigned int i = 0; i < NJ; i++)
+			for (unsigned int j = i + 1; j < NJ; j++)
+			{
+				double pe = jets[i][3] + jets[j][3];
+				double px = jets[i][0] + jets[j][0];
+				double py = jets[i][1] + jets[j][1];
+				double pz = jets[i][2] + jets[j][2];
+				mass_sq[i][j] = pe * pe - px * px - py * py - pz * pz;
+			}
+
+		for (unsigned int i = 0; i < NJ; i++)
+			for (unsigned int j = i + 1; j < NJ; j++)
+			{
+				if (!(mass_sq[i][j] > cuts_sq[0]))
+					continue;
+				for (unsigned int k = 0; k < NJ; k++)
+					for (unsigned int l = k + 1; l < NJ; l++)
+					{
+						if (k == i || k == j || l == i || l == j)
+							continue;
+						if (mass_sq[k][l] > cuts_sq[1])
+							return true;
+					}
+			}
+		return false;
+	}
+
 /* NAMESPACE */
 }
@@ -7,6 +7,8 @@
 #ifndef INC_CUTS_MASS
 #define INC_CUTS_MASS
 
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -22,6 +24,9 @@
 namespace analysis
 {
 
+	// maximum number of jets a topology may combine, sets the size of the jet cache
+	const unsigned int gres_max_jets = 16;
+
 	/* invariant jet combination mass cut class */
 	class cut_gres : public cut
 	{
@@ -47,9 +52,19 @@ namespace analysis
 		void calc_nrcombinations();
 		void calc_combinations();
 		void calc_pairings();
+		void calc_kernel();
 
 	private:
 		bool is_valid_pairing(const std::vector<std::vector<unsigned int> > &pairing) const;
+		void check_init() const;
+		bool fill_jets(const event *ev, double jets[][4], unsigned int n) const;
+		bool passed_generic(const double jets[][4]) const;
+
+		// specialised kernels for the common topologies
+		typedef bool (*gres_kernel)(const double jets[][4], const double *cuts_sq);
+		template <unsigned int NJ> static bool kernel_2(const double jets[][4], const double *cuts_sq);
+		template <unsigned int NJ> static bool kernel_3(const double jets[][4], const double *cuts_sq);
+		template <unsigned int NJ> static bool kernel_22(const double jets[][4], const double *cuts_sq);
 
 	private:
 		std::vector<int> topology;
@@ -62,6 +77,11 @@ namespace analysis
 		std::vector<std::vector<std::vector<unsigned int> > > resonance_combinations;
 		std::vector<std::vector<std::vector<unsigned int> > > resonance_pairings;
 
+		// flattened pairings and squared cuts used in the event loop
+		std::vector<unsigned int> flat_pairings;
+		std::vector<double> reduced_cuts_sq;
+		gres_kernel kernel;
+
 	};
 
 /* NAMESPACE */
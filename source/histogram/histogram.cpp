@@ -15,11 +15,20 @@ namespace analysis
 	histogram::histogram() 
 	{
 		nbins = 100;
-		// set hmin and hmax to unrealistic values
-		// which are then automatically set later
-		hmin = 10000;
-		hmax = -10000;
+		// the range is set automatically from the values 
+		// after the warm-up or when drawing
+		hmin = 0;
+		hmax = 1;
 		auto_range = true;
+		nr_values = 0;
+		warm_up = 10000;
+		range_fixed = false;
+		grid_origin = 0;
+		grid_width = 1;
+		grid_low = 0;
+		grid_high = 1;
+		grid_merge = 1;
+		grid_max_bins = 1;
 
 		ps_title = "new histogram";
     	leg_title = "";
@@ -44,6 +53,18 @@ namespace analysis
 	void histogram::set_bins(double nb)
 	{
 		nbins = nb;
+		bin_edges.clear();
+	}
+
+	void histogram::set_bins(const std::vector<double> & edges)
+	{
+		// variable bins also fix the range
+		histogram_axis check(edges);
+		bin_edges = edges;
+		nbins = edges.size() - 1;
+		hmin = edges.front();
+		hmax = edges.back();
+		auto_range = false;
 	}
 
 	void histogram::set_range(double min, double max)
@@ -52,9 +73,19 @@ namespace analysis
 			return;
 		hmin = min;
 		hmax = max;
+		bin_edges.clear();
 		auto_range = false;
 	}
 
+	void histogram::set_warm_up(unsigned int n)
+	{
+		// number of values of all samples after which the automatic range is 
+		// fixed, zero keeps all values until drawing; later values outside of the 
+		// range widen it on the same grid while filling if they are in the bulk of
+		// all values so far, from the quantile sketch of all samples
+		warm_up = n;
+	}
+
 	void histogram::set_x_label(std::string x)
 	{
 		x_label = x;
@@ -89,19 +120,247 @@ namespace analysis
 
 	void histogram::add_sample(const std::vector<double> & sample, const std::string & name, double weight)
 	{
-		sample_list.push_back(sample);
+		unsigned int index = new_sample(name, weight);
+		for (unsigned int i = 0; i < sample.size(); ++i)
+			fill(index, sample[i]);
+	}
+
+	void histogram::add_sample(const histogram_data & data, const std::string & name, double weight)
+	{
+		// binned data, e.g. merged results, already carries its weights and the sample weight 
+		// only normalises; without a fixed range the histogram adopts the binning of the data
+		if (auto_range)
+		{
+			if (!sample_data.empty())
+			{
+				std::cout << "Error: binned samples can only be added to histograms with a fixed range or as first sample." << std::endl;
+				exit (EXIT_FAILURE);
+			}
+			const histogram_axis & axis = data.axis();
+			if (axis.is_fixed())
+			{
+				set_bins(axis.nr_bins());
+				set_range(axis.lower_edge(1), axis.upper_edge(axis.nr_bins()));
+			}
+			else
+				set_bins(axis.edges());
+		}
+		unsigned int index = new_sample(name, weight);
+		fill(index, data);
+	}
+
+	unsigned int histogram::new_sample(const std::string & name, double weight)
+	{
+		// the sample is binned online if the binning is known already
+		sample_data.push_back(!auto_range || range_fixed ? range_binning() : histogram_data());
+		sample_values.push_back(std::vector<double>());
+		sample_sketches.push_back(quantile_sketch());
 		sample_names.push_back(name);
 		sample_weights.push_back(weight);
+		return sample_data.size() - 1;
+	}
+
+	void histogram::fill(unsigned int sample, double value)
+	{
+		if (!auto_range)
+		{
+			sample_data[sample].fill(value, sample_weights[sample]);
+			return;
+		}
+
+		// values are kept until the automatic range is fixed, afterwards they are 
+		// binned directly and those outside of the range can widen it
+		sample_sketches[sample].add(value);
+		range_sketch.add(value);
+		if (range_fixed)
+		{
+			unsigned int bin = sample_data[sample].axis().find_bin(value);
+			if (bin == 0 || bin > sample_data[sample].nr_bins())
+				widen_range(value);
+			sample_data[sample].fill(value, sample_weights[sample]);
+			return;
+		}
+		sample_values[sample].push_back(value);
+		if (warm_up > 0 && ++nr_values >= warm_up)
+			fix_range(false);
+	}
+
+	histogram histogram::shard(unsigned int sample) const
+	{
+		if (!auto_range || !range_fixed)
+		{
+			std::cout << "Error: histogram shards with automatic range need the range fixed after the warm-up." << std::endl;
+			exit (EXIT_FAILURE);
+		}
+
+		// the shard keeps the options, the grid and the sketch of all values, which decides 
+		// on widening the range, with a single empty sample of the same weight
+		histogram result(*this);
+		result.sample_data.clear();
+		result.sample_values.clear();
+		result.sample_sketches.clear();
+		result.sample_names.clear();
+		result.sample_weights.clear();
+		result.new_sample(sample_names[sample], sample_weights[sample]);
+		return result;
+	}
+
+	void histogram::merge(unsigned int sample, const histogram & shard)
+	{
+		if (!range_fixed || !shard.range_fixed || shard.sample_data.size() != 1 || shard.grid_origin != grid_origin || shard.grid_width != grid_width)
+		{
+			std::cout << "Error: only shards of a histogram with automatic range can be merged into it." << std::endl;
+			exit (EXIT_FAILURE);
+		}
+
+		// both ranges lie on the same grid, the merged range covers both
+		double low = std::min(grid_low, shard.grid_low);
+		double high = std::max(grid_high, shard.grid_high);
+		double merge = std::max(grid_merge, shard.grid_merge);
+		if (low != grid_low || high != grid_high || merge != grid_merge)
+			set_grid(low, high, merge);
+		sample_data[sample].merge(shard.sample_data[0].rebinned(sample_data[sample].axis()));
+		sample_sketches[sample].merge(shard.sample_sketches[0]);
+		range_sketch.merge(shard.sample_sketches[0]);
+	}
+
+	void histogram::fill(unsigned int sample, const histogram_data & shard)
+	{
+		// shards are filled with binning() and already carry the sample weight
+		if (auto_range)
+		{
+			std::cout << "Error: histogram shards can only be merged into histograms with a fixed range." << std::endl;
+			exit (EXIT_FAILURE);
+		}
+		sample_data[sample].merge(shard);
+	}
+
+	histogram_data histogram::binning() const
+	{
+		if (auto_range)
+		{
+			std::cout << "Error: the binning of a histogram with automatic range is only known when drawing." << std::endl;
+			exit (EXIT_FAILURE);
+		}
+		return range_binning();
+	}
+
+	void histogram::fix_binning()
+	{
+		if (auto_range && !range_fixed)
+			fix_range(true);
+	}
+
+	/* automatic range */
+
+	histogram_data histogram::range_binning() const
+	{
+		if (!bin_edges.empty())
+			return histogram_data(histogram_axis(bin_edges));
+		return histogram_data(histogram_axis(nbins, hmin, hmax));
+	}
+
+	void histogram::bulk_range(const quantile_sketch & sketch, double & low, double & high) const
+	{
+		double q_low = sketch.quantile(0.001);
+		double q_high = sketch.quantile(0.999);
+		double margin = 0.05 * (q_high - q_low);
+		low = std::max(sketch.min(), q_low - margin);
+		high = std::min(sketch.max(), q_high + margin);
+	}
+
+	void histogram::fix_range(bool final)
+	{
+		const quantile_sketch & sketch = range_sketch;
+		if (sketch.count() == 0 && !final)
+			return;
+
+		// after the warm-up the range covers the bulk of the values, such that single 
+		// outliers do not squeeze the distribution; otherwise it spans all values
+		if (sketch.count() == 0)
+		{
+			// no values at all: keep the default range
+		}
+		else if (final && (warm_up == 0 || sketch.count() < warm_up))
+		{
+			hmin = sketch.min();
+			hmax = sketch.max();
+		}
+		else
+			bulk_range(sketch, hmin, hmax);
+		if (hmax <= hmin)
+			hmax = hmin + 1;
+		range_fixed = true;
+
+		// the range is widened on the grid of its bins, by up to the same number of bins
+		grid_origin = hmin;
+		grid_width = (hmax - hmin) / nbins;
+		grid_low = 0;
+		grid_high = nbins;
+		grid_merge = 1;
+		grid_max_bins = 2 * nbins;
+
+		// the values of the warm-up are binned, they are not kept anymore
+		bin_values();
+	}
+
+	void histogram::widen_range(double value)
+	{
+		// a value outside of the range widens it if it is in the bulk of all values so far, 
+		// such that single outliers do not squeeze the distribution and stay in the under- 
+		// or overflow, as do earlier values outside of the range
+		double low, high;
+		bulk_range(range_sketch, low, high);
+		if (value < low || value > high)
+			return;
+
+		// whole bins of the grid are added, in units of the bins of the fixed range
+		double bin = std::floor((value - grid_origin) / grid_width);
+		set_grid(std::min(grid_low, bin), std::max(grid_high, bin + 1), grid_merge);
+	}
+
+	void histogram::set_grid(double low, double high, double merge)
+	{
+		// the range is aligned to the merged bins, beyond the maximal number of bins 
+		// neighbouring bins are merged, such that all bins of the grid lie within one of them
+		low = std::floor(low / merge) * merge;
+		high = std::ceil(high / merge) * merge;
+		while ((high - low) / merge > grid_max_bins)
+		{
+			merge *= 2;
+			low = std::floor(low / merge) * merge;
+			high = std::ceil(high / merge) * merge;
+		}
+		grid_low = low;
+		grid_high = high;
+		grid_merge = merge;
+		nbins = (high - low) / merge;
+		hmin = grid_origin + low * grid_width;
+		hmax = grid_origin + high * grid_width;
+		histogram_data binning = range_binning();
+		for (unsigned int i = 0; i < sample_data.size(); ++i)
+			sample_data[i] = sample_data[i].rebinned(binning.axis());
+	}
+
+	void histogram::bin_values()
+	{
+		for (unsigned int i = 0; i < sample_values.size(); ++i)
+		{
+			sample_data[i] = range_binning();
+			for (unsigned int j = 0; j < sample_values[i].size(); ++j)
+				sample_data[i].fill(sample_values[i][j], sample_weights[i]);
+			std::vector<double>().swap(sample_values[i]);
+		}
 	}
 
 	/* histogram drawing */
 
-	void histogram::draw()
-	{	
-		// create a canvas with a random name		
-		std::random_device rd;
-		TCanvas* canvas = new TCanvas(boost::lexical_cast<std::string>(rd()).c_str(), "");
+	// line colors of the samples and their transparent fill colors
+	const std::vector<Color_t> hist_colors = {kBlack, kRed, kBlue, kGreen, kMagenta, kCyan};
+	const std::vector<Color_t> hist_colors_trans = {1700, 1701, 1702, 1703, 1704, 1705};
 
+	void histogram::set_style()
+	{
 		// options 
 		Int_t font = 42;
 		gStyle->SetOptStat(0);
@@ -117,29 +376,37 @@ namespace analysis
 		gStyle->SetTitleFont(font, "XYZ");
 		gStyle->SetEndErrorSize(0);
 
-		canvas->SetTicks(1,1);
-		canvas->SetBottomMargin(0.2);
-		canvas->SetLeftMargin(0.2);
-		canvas->SetLogy(0);
-		if (has_logy)
-			canvas->SetLogy(1);
-
-		// set colors and line shapes
-		Color_t kTransBlack = 1700, kTransRed = 1701, kTransBlue = 1702, kTransGreen = 1703, kTransMagenta = 1704, kTransCyan = 1705;
- 		std::vector<Color_t> colors = {kBlack, kRed, kBlue, kGreen, kMagenta, kCyan};
-		std::vector<Color_t> colors_trans = {kTransBlack, kTransRed, kTransBlue, kTransGreen, kTransMagenta, kTransCyan};
-		for (unsigned int i = 0; i < colors.size(); ++i)
+		// set transparent colors
+		for (unsigned int i = 0; i < hist_colors.size(); ++i)
 		{
-			TColor *c = gROOT->GetColor(colors_trans[i]);
+			TColor *c = gROOT->GetColor(hist_colors_trans[i]);
 			if (!c)
-				c = new TColor(colors_trans[i], 0.0, 0.0, 0.0);
+				c = new TColor(hist_colors_trans[i], 0.0, 0.0, 0.0);
 				
-			TColor *copy = gROOT->GetColor(colors[i]);
+			TColor *copy = gROOT->GetColor(hist_colors[i]);
 			Float_t r, g, b;
 			copy->GetRGB(r, g, b);
 			c->SetRGB(r, g, b);
 			c->SetAlpha(0.5);
 		}
+	}
+
+	void histogram::draw(bool apply_style)
+	{	
+		// create a canvas with a random name		
+		std::random_device rd;
+		TCanvas* canvas = new TCanvas(boost::lexical_cast<std::string>(rd()).c_str(), "");
+
+		canvas->SetTicks(1,1);
+		canvas->SetBottomMargin(0.2);
+		canvas->SetLeftMargin(0.2);
+		canvas->SetLogy(0);
+		if (has_logy)
+			canvas->SetLogy(1);
+
+		// set style once if requested
+		if (apply_style)
+			set_style();
 
 		// set axes' labels 
 		std::string labels = ";" + x_label + ";" + y_label;
@@ -148,29 +415,28 @@ namespace analysis
   		double max = -100;
   		double ymax;
 	
+		// fix or widen the automatic range and bin the values waiting for it
+		fix_binning();
+
   		// construction of histogram collection
 	    std::vector<TH1D*> hist;
 
-	    for (int i = 0; i < sample_list.size(); ++i)
+	    for (int i = 0; i < sample_data.size(); ++i)
 	    {
-			std::vector<double> list = sample_list[i];
-
-	    	// find max and min entry for auto range option.
-			if (auto_range && !list.empty())
+			// convert the sample data to one histogram per sample
+			const histogram_data & data = sample_data[i];
+			const histogram_axis & axis = data.axis();
+			if (axis.is_fixed())
+				hist.push_back(new TH1D("", labels.c_str(), axis.nr_bins(), axis.lower_edge(1), axis.upper_edge(axis.nr_bins())));
+			else
+				hist.push_back(new TH1D("", labels.c_str(), axis.nr_bins(), &axis.edges()[0]));
+			hist[i]->Sumw2();
+			for (unsigned int bin = 0; bin <= axis.nr_bins() + 1; ++bin)
 			{
-				auto result = std::minmax_element(list.begin(), list.end());
-				double min = *result.first;
-				double max = *result.second;
-				if (min < hmin) hmin = min;
-				if (max > hmax) hmax = max;
+				hist[i]->SetBinContent(bin, data.content(bin));
+				hist[i]->SetBinError(bin, data.error(bin));
 			}
-
-			// construct one histogram per sample
-			hist.push_back(new TH1D("", labels.c_str(), nbins, hmin, hmax));
-
-			// read the sample and fill the histogram
-			for (unsigned int j = 0; j < list.size(); j++)
-				hist[i]->Fill(list[j], sample_weights[i]);
+			hist[i]->SetEntries(data.entries());
 
 			if (is_normalised)
 			{
@@ -179,7 +445,7 @@ namespace analysis
 				hist[i]->Scale(scale);
 			}
 
-	    	hist[i]->SetLineColor(colors[i]);
+	    	hist[i]->SetLineColor(hist_colors[i]);
     		hist[i]->SetLineWidth(2);
     		ymax = hist[i]->GetMaximum();
     		if (ymax > max) 
@@ -200,7 +466,7 @@ namespace analysis
 		double y2 = 0.64;
 		TLegend *legend = new TLegend(x1, y1, x2, y2, leg_title.c_str());
 
-		for (int i = 0; i < sample_list.size(); ++i)
+		for (int i = 0; i < sample_data.size(); ++i)
     		legend->AddEntry(hist[i], sample_names[i].c_str());
 
   		// set legend cosmetics 
@@ -213,10 +479,10 @@ namespace analysis
 
 		// draw histograms: stacked or not
 		THStack stack(boost::lexical_cast<std::string>(rd()).c_str(), labels.c_str());
-		for (int i = 0; i < sample_list.size(); ++i)
+		for (int i = 0; i < sample_data.size(); ++i)
   		{
 			if (is_stacked)
-				hist[i]->SetFillColor(colors_trans[i]);
+				hist[i]->SetFillColor(hist_colors_trans[i]);
 
 			stack.Add(hist[i]);
   		}
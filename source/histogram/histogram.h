@@ -24,6 +24,9 @@
 #include <TROOT.h>
 #include <TStyle.h> 
 
+#include "histogram_data.h"
+#include "quantile_sketch.h"
+
 
 /* NAMESPACE */
 namespace analysis 
@@ -41,7 +44,9 @@ namespace analysis
 		/* histogram options */
 		void set_title(std::string ps);
 		void set_bins(double nb);
+		void set_bins(const std::vector<double> & edges);
 		void set_range(double min, double max);
+		void set_warm_up(unsigned int n);
 		void set_x_label(std::string x);
 		void set_y_label(std::string y);
 		void set_leg_title(std::string title);
@@ -51,14 +56,59 @@ namespace analysis
 
 		/* histogram data */
 		void add_sample(const std::vector<double> & sample, const std::string & name = "", double weight = 1);
-
-		/* histogram drawing */
-		void draw();
+		void add_sample(const histogram_data & data, const std::string & name = "", double weight = 1);
+		unsigned int new_sample(const std::string & name = "", double weight = 1);
+		void fill(unsigned int sample, double value);
+		void fill(unsigned int sample, const histogram_data & shard);
+
+		/* the binning is only known in advance, e.g. to fill shards, if the range is fixed
+		   by set_range or set_bins; the automatic range is fixed by fix_binning or draw */
+		histogram_data binning() const;
+		bool has_binning() const { return !auto_range; }
+
+		/* with the automatic range fixed after the warm-up, a worker fills a shard of a sample
+		   on the grid of the range, which both widen while filling; values outside of the range
+		   of a shard which is merged into a wider range stay in the under- and overflow */
+		bool has_range() const { return !auto_range || range_fixed; }
+		histogram shard(unsigned int sample) const;
+		void merge(unsigned int sample, const histogram & shard);
+		void fix_binning();
+		const histogram_data & data(unsigned int sample) const { return sample_data[sample]; }
+
+		/* histogram drawing: the global ROOT style only needs to be set once
+		   when many histograms are drawn in one process */
+		static void set_style();
+		void draw(bool apply_style = true);
 
 	private:
 
-		/* histogram data */
-		std::vector< std::vector<double> > sample_list;
+		/* automatic range */
+		histogram_data range_binning() const;
+		void bulk_range(const quantile_sketch & sketch, double & low, double & high) const;
+		void fix_range(bool final);
+		void widen_range(double value);
+		void set_grid(double low, double high, double merge);
+		void bin_values();
+
+		/* histogram data: samples are binned while filling if the range is fixed, with 
+		   the automatic range their values are kept during the warm-up only, afterwards 
+		   they are binned and the range is widened for them while filling */
+		std::vector<histogram_data> sample_data;
+		std::vector< std::vector<double> > sample_values;
+		std::vector<quantile_sketch> sample_sketches;
+		quantile_sketch range_sketch;
+		unsigned int nr_values;
+		unsigned int warm_up;
+		bool range_fixed;
+
+		/* grid of the automatic range: the bins of the fixed range start at the origin, the
+		   range spans [low, high) in units of them and merge of them form one bin */
+		double grid_origin;
+		double grid_width;
+		double grid_low;
+		double grid_high;
+		double grid_merge;
+		double grid_max_bins;
 		std::vector<std::string> sample_names;
 		std::vector<double> sample_weights;
 
@@ -66,6 +116,7 @@ namespace analysis
 		double nbins;
 		double hmin; 
 		double hmax;
+		std::vector<double> bin_edges;
 		bool auto_range;
 		std::string ps_title;
 		std::string leg_title;
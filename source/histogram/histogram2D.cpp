@@ -21,6 +21,7 @@ namespace analysis
 		xmax = 100;
 		ymin = 0;
 		ymax = 100;
+		has_sample_xy = false;
 
 		ps_title = "new 2D histogram";
     	x_label = ""; 
@@ -96,65 +97,66 @@ namespace analysis
 	/* histogram data */
 	void histogram2D::add_sample_xyz(const std::vector< std::vector<double> > & list_xyz)
 	{
-		sample_xyz = list_xyz;		
+		sample_xyz = list_xyz;
+		sample_grid.build(list_xyz);
 	}
 	
 	void histogram2D::add_sample_xy(const std::vector< std::vector<double> > & list_xy)
 	{
-		sample_xy.push_back(list_xy);
+		for (unsigned int i = 0; i < list_xy.size(); i++)
+			fill(list_xy[i][0], list_xy[i][1]);
 	}
 
-	/* interpolation */
-	
-	double histogram2D::Interpolate2D(const std::list< std::list<double> > & values, const std::list<double> & xy)
+	void histogram2D::fill(double x, double y, double weight)
 	{
-		/*try
-    	{
-			Py_Initialize();
-
-	    	PyRun_SimpleString("import sys, string, random");
-	    	PyRun_SimpleString("sys.path.append('../../source/histogram')");
-	    	
-	    	boost::python::list l_values;
-	  		typename std::list< std::list<double> >::const_iterator it_outer;
-	  		typename std::list<double>::const_iterator it_inner;
-
-	  		for (it_outer = values.begin(); it_outer != values.end(); ++it_outer)
-	  		{
-	  			boost::python::list l_inner;
-	  			for (it_inner = (*it_outer).begin(); it_inner != (*it_outer).end(); ++it_inner)
-	  			{
-	  				l_inner.append(*it_inner);
-	  			}
-	  			l_values.append(l_inner);
-	  		}  
+		// the binning is fixed by the first entry
+		if (!has_sample_xy)
+		{
+			sample_xy = binning();
+			has_sample_xy = true;
+		}
+		sample_xy.fill(x, y, weight);
+	}
 
-	  		boost::python::list l_xy;
-	  		for (it_inner = xy.begin(); it_inner != xy.end(); ++it_inner)
-	  		{
-	  			l_xy.append(*it_inner);
-	  		}
+	void histogram2D::fill(const histogram2D_data & shard)
+	{
+		// shards are filled with binning() in the worker threads
+		if (!has_sample_xy)
+		{
+			sample_xy = shard;
+			has_sample_xy = true;
+			return;
+		}
+		sample_xy.merge(shard);
+	}
 
-	    	boost::python::object module_ = boost::python::import("interpolate");
-	    	boost::python::object result_ = module_.attr("Interpolate2D")(l_values, l_xy);
-	    	double result = boost::python::extract<double>(result_);
+	histogram2D_data histogram2D::binning() const
+	{
+		return histogram2D_data(histogram_axis(xbins, xmin, xmax), histogram_axis(ybins, ymin, ymax));
+	}
 
-	    	Py_Finalize();
+	/* interpolation */
+	
+	double histogram2D::interpolate(double x, double y) const
+	{
+		return sample_grid.interpolate(x, y);
+	}
 
-	    	return result;
-    	}
-    	catch (boost::python::error_already_set const&)
-	   	{
-	        PyErr_Print();
-	        return 1.0;
-	   	}*/
-	   	return 1.0;
+	double histogram2D::Interpolate2D(const std::list< std::list<double> > & values, const std::list<double> & xy)
+	{
+		// builds the grid for a single query, use interpolation_grid for many queries
+		std::vector< std::vector<double> > list_xyz;
+		std::list< std::list<double> >::const_iterator it;
+		for (it = values.begin(); it != values.end(); ++it)
+			list_xyz.push_back(std::vector<double>(it->begin(), it->end()));
+		interpolation_grid grid(list_xyz);
+		return grid.interpolate(xy.front(), xy.back());
 	}
 
 	/* histogram drawing */
 	
-	void histogram2D::draw()
-	{	
+	void histogram2D::set_style()
+	{
 		// define histogram with options
 		Int_t font = 42;
 		gStyle->SetOptStat(0);
@@ -169,6 +171,13 @@ namespace analysis
 		gStyle->SetTitleSize(0.06, "XYZ");
 		gStyle->SetTitleFont(font, "XYZ");
 		gStyle->SetTitleX(0.15);
+	}
+
+	void histogram2D::draw(bool apply_style)
+	{	
+		// set style once if requested
+		if (apply_style)
+			set_style();
 
 		// create a canvas with options
 		TCanvas* canvas = new TCanvas("", "");
@@ -183,56 +192,42 @@ namespace analysis
 		// set axes' labels
 		std::string labels = ";" + x_label + ";" + y_label;
 
-  		// construct 2D histogram
-	    TH2D* hist2D = new TH2D("", labels.c_str(), xbins, xmin, xmax, ybins, ymin, ymax);
+  		// construct 2D histogram, binned samples keep their own binning
+		histogram_axis x_axis = has_sample_xy ? sample_xy.x_axis() : histogram_axis(xbins, xmin, xmax);
+		histogram_axis y_axis = has_sample_xy ? sample_xy.y_axis() : histogram_axis(ybins, ymin, ymax);
+	    TH2D* hist2D = new TH2D("", labels.c_str(), x_axis.nr_bins(), x_axis.lower_edge(1), x_axis.upper_edge(x_axis.nr_bins()), y_axis.nr_bins(), y_axis.lower_edge(1), y_axis.upper_edge(y_axis.nr_bins()));
 	    
 	    // draw 2D histogram dependent on which kind of sample has been specified
-	    if (sample_xy.size() > 0) // draw for xy sample
+	    if (has_sample_xy) // draw for xy sample
 	    {
-			// fill 2D histogram with xy list values
-			for (unsigned int i = 0; i < sample_xy.size(); i++)
+			// convert the binned xy sample including under- and overflow
+			for (unsigned int i = 0; i <= x_axis.nr_bins() + 1; i++)
 			{
-				std::vector< std::vector<double> > sample = sample_xy[i];
-				for (unsigned int j = 0; j < sample.size(); j++)
+				for (unsigned int j = 0; j <= y_axis.nr_bins() + 1; j++)
 				{
-					std::vector<double> xy = sample[j];
-					hist2D->Fill(xy[0], xy[1]);			
+					hist2D->SetBinContent(i, j, sample_xy.content(i, j));
+					hist2D->SetBinError(i, j, sample_xy.error(i, j));
 				}
 			}
+			hist2D->SetEntries(sample_xy.entries());
 		}
 	    else if (sample_xyz.size() > 0) // draw xyz sample
 	    {
-			// convert list_xyz to map
-			std::map<std::list<double>, double> map_values;
-			std::list< std::list<double> > list_values; 
-			for (unsigned int i = 0; i < sample_xyz.size(); i++)
+			// interpolate the xyz sample at all bin centers in one batch
+			std::vector<double> x_centers, y_centers;
+			for (unsigned int i = 1; i <= x_axis.nr_bins(); i++)
 			{
-				std::vector<double> xyz = sample_xyz[i];
-				std::list<double> coord = {xyz[0], xyz[1]};
-				map_values.insert(std::make_pair(coord, xyz[2]));
-				list_values.push_back({xyz[0], xyz[1], xyz[2]});		
+				for (unsigned int j = 1; j <= y_axis.nr_bins(); j++)
+				{
+					x_centers.push_back(x_axis.center(i));
+					y_centers.push_back(y_axis.center(j));
+				}
 			}
-			
-			// fill 2D histogram with xyz values
-			double value;
-			double xbin_size = (xmax - xmin) / xbins;
-			double ybin_size = (ymax - ymin) / ybins;
-
-			for (double x = (xmin + xbin_size / 2); x < xmax; x += xbin_size)
+			std::vector<double> values = sample_grid.interpolate(x_centers, y_centers);
+			for (unsigned int k = 0; k < values.size(); k++)
 			{
-				for (double y = (ymin + ybin_size / 2); y < ymax; y += ybin_size)
-				{	
-					std::list<double> coord = {x, y};
-					std::map<std::list<double>, double>::iterator it;
-					it = map_values.find(coord);
-
-					if (it != map_values.end())
-						value = map_values[coord];
-					else    				
-						value = Interpolate2D(list_values, coord);
-
-					hist2D->Fill(x, y, value);
-				}
+				if (sample_grid.is_inside(x_centers[k], y_centers[k]))
+					hist2D->Fill(x_centers[k], y_centers[k], values[k]);
 			}
 		}
 		else // no sample specified
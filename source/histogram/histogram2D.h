@@ -20,6 +20,9 @@
 #include <TLegend.h>
 #include <TStyle.h>
 
+#include "histogram_data.h"
+#include "interpolation_grid.h"
+
 
 /* NAMESPACE */
 namespace analysis 
@@ -47,18 +50,26 @@ namespace analysis
 		/* histogram data */
 		void add_sample_xyz(const std::vector< std::vector<double> > & list_xyz); 
 		void add_sample_xy(const std::vector< std::vector<double> > & list_xy);
+		void fill(double x, double y, double weight = 1);
+		void fill(const histogram2D_data & shard);
+		histogram2D_data binning() const;
 
-		/* interpolation */
+		/* interpolation of the xyz sample, values outside the sample are zero */
+		double interpolate(double x, double y) const;
 		double Interpolate2D(const std::list< std::list<double> > & values, const std::list<double> & xy);
 
-		/* histogram drawing */
-		void draw();
+		/* histogram drawing: the global ROOT style only needs to be set once
+		   when many histograms are drawn in one process */
+		static void set_style();
+		void draw(bool apply_style = true);
 		
 	private:
 	
 		/* histogram data */
 		std::vector< std::vector<double> > sample_xyz;
-		std::vector< std::vector< std::vector<double> > > sample_xy;
+		interpolation_grid sample_grid;
+		histogram2D_data sample_xy;
+		bool has_sample_xy;
 		
 		/* histogram options */
 		int xbins;
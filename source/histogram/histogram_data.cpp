@@ -0,0 +1,294 @@
+/* Histogram data classes
+ *
+ * ROOT independent binned data with fixed or variable bins, weighted fills 
+ * and sum-of-squares errors, which can be filled online in per-thread shards
+ * and merged bin by bin. The binary format allows to merge results of
+ * independent jobs.
+*/
+
+#include "histogram_data.h"
+
+
+/* NAMESPACE */
+namespace analysis 
+{
+
+	// upper bounds of the sizes read from binary files, such that corrupt 
+	// files are rejected instead of allocated
+	const unsigned int max_binary_bins = 1u << 20;
+	const unsigned long long max_binary_bins2D = 1ull << 24;
+
+	/* histogram axis */
+
+	histogram_axis::histogram_axis(unsigned int n, double min, double max)
+	{
+		nbins = std::max(1u, n);
+		axis_min = min;
+		axis_max = max;
+		inv_width = max > min ? nbins / (max - min) : 0;
+	}
+
+	histogram_axis::histogram_axis(const std::vector<double> & edges)
+	{
+		if (edges.size() < 2 || !std::is_sorted(edges.begin(), edges.end()))
+		{
+			std::cout << "Error: variable histogram bins need at least two increasing edges." << std::endl;
+			exit (EXIT_FAILURE);
+		}
+		nbins = edges.size() - 1;
+		axis_min = edges.front();
+		axis_max = edges.back();
+		inv_width = 0;
+		bin_edges = edges;
+	}
+
+	unsigned int histogram_axis::find_bin(double x) const
+	{
+		// lower edges are inclusive, upper edges exclusive as for ROOT histograms
+		if (x < axis_min)
+			return 0;
+		if (x >= axis_max)
+			return nbins + 1;
+		if (bin_edges.empty())
+			return std::min(nbins, 1 + static_cast<unsigned int>((x - axis_min) * inv_width));
+		return std::upper_bound(bin_edges.begin(), bin_edges.end(), x) - bin_edges.begin();
+	}
+
+	double histogram_axis::lower_edge(unsigned int bin) const
+	{
+		if (!bin_edges.empty())
+			return bin_edges[std::min(std::max(bin, 1u), nbins + 1) - 1];
+		if (bin > nbins)
+			return axis_max;
+		return axis_min + (static_cast<double>(std::max(bin, 1u)) - 1) * (axis_max - axis_min) / nbins;
+	}
+
+	double histogram_axis::upper_edge(unsigned int bin) const
+	{
+		return lower_edge(bin + 1);
+	}
+
+	double histogram_axis::center(unsigned int bin) const
+	{
+		return (lower_edge(bin) + upper_edge(bin)) / 2;
+	}
+
+	bool histogram_axis::operator == (const histogram_axis & other) const
+	{
+		return nbins == other.nbins && axis_min == other.axis_min && axis_max == other.axis_max && bin_edges == other.bin_edges;
+	}
+
+	void histogram_axis::write_binary(std::ostream & os) const
+	{
+		unsigned int n = nbins, nr_edges = bin_edges.size();
+		os.write(reinterpret_cast<const char*>(&n), sizeof(n));
+		os.write(reinterpret_cast<const char*>(&axis_min), sizeof(double));
+		os.write(reinterpret_cast<const char*>(&axis_max), sizeof(double));
+		os.write(reinterpret_cast<const char*>(&nr_edges), sizeof(nr_edges));
+		if (nr_edges > 0)
+			os.write(reinterpret_cast<const char*>(&bin_edges[0]), nr_edges * sizeof(double));
+	}
+
+	bool histogram_axis::read_binary(std::istream & is)
+	{
+		unsigned int n = 0, nr_edges = 0;
+		double min = 0, max = 0;
+		is.read(reinterpret_cast<char*>(&n), sizeof(n));
+		is.read(reinterpret_cast<char*>(&min), sizeof(double));
+		is.read(reinterpret_cast<char*>(&max), sizeof(double));
+		is.read(reinterpret_cast<char*>(&nr_edges), sizeof(nr_edges));
+		if (!is || n == 0 || n > max_binary_bins || (nr_edges != 0 && nr_edges != n + 1))
+			return false;
+		std::vector<double> edges(nr_edges);
+		if (nr_edges > 0)
+			is.read(reinterpret_cast<char*>(&edges[0]), nr_edges * sizeof(double));
+		if (!is)
+			return false;
+		*this = nr_edges > 0 ? histogram_axis(edges) : histogram_axis(n, min, max);
+		return true;
+	}
+
+
+	/* one dimensional histogram data */
+
+	histogram_data::histogram_data(const histogram_axis & axis) : data_axis(axis)
+	{
+		sum_w.assign(data_axis.nr_bins() + 2, 0);
+		sum_w2.assign(data_axis.nr_bins() + 2, 0);
+		nr_entries = 0;
+	}
+
+	void histogram_data::fill(double x, double weight)
+	{
+		unsigned int bin = data_axis.find_bin(x);
+		sum_w[bin] += weight;
+		sum_w2[bin] += weight * weight;
+		nr_entries++;
+	}
+
+	void histogram_data::merge(const histogram_data & other)
+	{
+		if (data_axis != other.data_axis)
+		{
+			std::cout << "Error: can not merge histograms with different binning." << std::endl;
+			exit (EXIT_FAILURE);
+		}
+		for (unsigned int bin = 0; bin < sum_w.size(); ++bin)
+		{
+			sum_w[bin] += other.sum_w[bin];
+			sum_w2[bin] += other.sum_w2[bin];
+		}
+		nr_entries += other.nr_entries;
+	}
+
+	void histogram_data::scale(double factor)
+	{
+		for (unsigned int bin = 0; bin < sum_w.size(); ++bin)
+		{
+			sum_w[bin] *= factor;
+			sum_w2[bin] *= factor * factor;
+		}
+	}
+
+	void histogram_data::clear()
+	{
+		std::fill(sum_w.begin(), sum_w.end(), 0);
+		std::fill(sum_w2.begin(), sum_w2.end(), 0);
+		nr_entries = 0;
+	}
+
+	histogram_data histogram_data::rebinned(const histogram_axis & axis) const
+	{
+		histogram_data result(axis);
+		for (unsigned int bin = 1; bin <= nr_bins(); ++bin)
+		{
+			unsigned int new_bin = axis.find_bin(data_axis.center(bin));
+			result.sum_w[new_bin] += sum_w[bin];
+			result.sum_w2[new_bin] += sum_w2[bin];
+		}
+		unsigned int overflow = axis.nr_bins() + 1;
+		result.sum_w[0] += sum_w[0];
+		result.sum_w2[0] += sum_w2[0];
+		result.sum_w[overflow] += sum_w[nr_bins() + 1];
+		result.sum_w2[overflow] += sum_w2[nr_bins() + 1];
+		result.nr_entries = nr_entries;
+		return result;
+	}
+
+	// sum of the bin contents without under- and overflow
+	double histogram_data::integral() const
+	{
+		double sum = 0;
+		for (unsigned int bin = 1; bin <= nr_bins(); ++bin)
+			sum += sum_w[bin];
+		return sum;
+	}
+
+	// maximal bin content without under- and overflow
+	double histogram_data::maximum() const
+	{
+		return *std::max_element(sum_w.begin() + 1, sum_w.end() - 1);
+	}
+
+
+	void histogram_data::write_binary(std::ostream & os) const
+	{
+		unsigned long long n = nr_entries;
+		data_axis.write_binary(os);
+		os.write(reinterpret_cast<const char*>(&n), sizeof(n));
+		os.write(reinterpret_cast<const char*>(&sum_w[0]), sum_w.size() * sizeof(double));
+		os.write(reinterpret_cast<const char*>(&sum_w2[0]), sum_w2.size() * sizeof(double));
+	}
+
+	bool histogram_data::read_binary(std::istream & is)
+	{
+		histogram_axis axis;
+		unsigned long long n = 0;
+		if (!axis.read_binary(is))
+			return false;
+		is.read(reinterpret_cast<char*>(&n), sizeof(n));
+		*this = histogram_data(axis);
+		nr_entries = n;
+		is.read(reinterpret_cast<char*>(&sum_w[0]), sum_w.size() * sizeof(double));
+		is.read(reinterpret_cast<char*>(&sum_w2[0]), sum_w2.size() * sizeof(double));
+		return !!is;
+	}
+
+
+	/* two dimensional histogram data */
+
+	histogram2D_data::histogram2D_data(const histogram_axis & x_axis, const histogram_axis & y_axis) : data_x_axis(x_axis), data_y_axis(y_axis)
+	{
+		unsigned int size = (data_x_axis.nr_bins() + 2) * (data_y_axis.nr_bins() + 2);
+		sum_w.assign(size, 0);
+		sum_w2.assign(size, 0);
+		nr_entries = 0;
+	}
+
+	void histogram2D_data::fill(double x, double y, double weight)
+	{
+		unsigned int i = index(data_x_axis.find_bin(x), data_y_axis.find_bin(y));
+		sum_w[i] += weight;
+		sum_w2[i] += weight * weight;
+		nr_entries++;
+	}
+
+	void histogram2D_data::merge(const histogram2D_data & other)
+	{
+		if (data_x_axis != other.data_x_axis || data_y_axis != other.data_y_axis)
+		{
+			std::cout << "Error: can not merge 2D histograms with different binning." << std::endl;
+			exit (EXIT_FAILURE);
+		}
+		for (unsigned int i = 0; i < sum_w.size(); ++i)
+		{
+			sum_w[i] += other.sum_w[i];
+			sum_w2[i] += other.sum_w2[i];
+		}
+		nr_entries += other.nr_entries;
+	}
+
+	void histogram2D_data::scale(double factor)
+	{
+		for (unsigned int i = 0; i < sum_w.size(); ++i)
+		{
+			sum_w[i] *= factor;
+			sum_w2[i] *= factor * factor;
+		}
+	}
+
+	void histogram2D_data::clear()
+	{
+		std::fill(sum_w.begin(), sum_w.end(), 0);
+		std::fill(sum_w2.begin(), sum_w2.end(), 0);
+		nr_entries = 0;
+	}
+
+	void histogram2D_data::write_binary(std::ostream & os) const
+	{
+		unsigned long long n = nr_entries;
+		data_x_axis.write_binary(os);
+		data_y_axis.write_binary(os);
+		os.write(reinterpret_cast<const char*>(&n), sizeof(n));
+		os.write(reinterpret_cast<const char*>(&sum_w[0]), sum_w.size() * sizeof(double));
+		os.write(reinterpret_cast<const char*>(&sum_w2[0]), sum_w2.size() * sizeof(double));
+	}
+
+	bool histogram2D_data::read_binary(std::istream & is)
+	{
+		histogram_axis x_axis, y_axis;
+		unsigned long long n = 0;
+		if (!x_axis.read_binary(is) || !y_axis.read_binary(is))
+			return false;
+		if (static_cast<unsigned long long>(x_axis.nr_bins() + 2) * (y_axis.nr_bins() + 2) > max_binary_bins2D)
+			return false;
+		is.read(reinterpret_cast<char*>(&n), sizeof(n));
+		*this = histogram2D_data(x_axis, y_axis);
+		nr_entries = n;
+		is.read(reinterpret_cast<char*>(&sum_w[0]), sum_w.size() * sizeof(double));
+		is.read(reinterpret_cast<char*>(&sum_w2[0]), sum_w2.size() * sizeof(double));
+		return !!is;
+	}
+
+/* NAMESPACE */
+}
@@ -0,0 +1,165 @@
+/* Histogram data classes
+ *
+ * ROOT independent binned data with fixed or variable bins, weighted fills 
+ * and sum-of-squares errors, which can be filled online in per-thread shards
+ * and merged bin by bin. The binary format allows to merge results of
+ * independent jobs.
+*/
+
+#ifndef INC_HISTOGRAM_DATA
+#define INC_HISTOGRAM_DATA
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+
+/* NAMESPACE */
+namespace analysis 
+{
+
+	/* binning of one axis: bin 0 is the underflow and bin nbins + 1 the overflow */
+	class histogram_axis
+	{
+
+	public:
+
+		/* constructors: fixed bins in a range or variable bins given by their edges */
+		histogram_axis(unsigned int nbins = 1, double min = 0, double max = 1);
+		histogram_axis(const std::vector<double> & edges);
+
+		/* binning */
+		unsigned int nr_bins() const { return nbins; }
+		unsigned int find_bin(double x) const;
+		double lower_edge(unsigned int bin) const;
+		double upper_edge(unsigned int bin) const;
+		double center(unsigned int bin) const;
+		bool is_fixed() const { return bin_edges.empty(); }
+		const std::vector<double> & edges() const { return bin_edges; }
+		bool operator == (const histogram_axis & other) const;
+		bool operator != (const histogram_axis & other) const { return !(*this == other); }
+
+		/* binary input & output */
+		void write_binary(std::ostream & os) const;
+		bool read_binary(std::istream & is);
+
+	private:
+		unsigned int nbins;
+		double axis_min;
+		double axis_max;
+		double inv_width;
+		std::vector<double> bin_edges;
+
+	};
+
+	/* one dimensional histogram data */
+	class histogram_data
+	{
+
+	public:
+
+		/* constructors */
+		histogram_data(const histogram_axis & axis = histogram_axis());
+
+		/* filling and merging */
+		void fill(double x, double weight = 1);
+		void merge(const histogram_data & other);
+		void scale(double factor);
+		void clear();
+
+		/* copy with a wider axis on the same grid, each bin has to lie within a bin of the new
+		   axis: the contents are moved to the new bins and the under- and overflow, which can 
+		   not be split, stay in the under- and overflow */
+		histogram_data rebinned(const histogram_axis & axis) const;
+
+		/* access */
+		const histogram_axis & axis() const { return data_axis; }
+		unsigned int nr_bins() const { return data_axis.nr_bins(); }
+		double content(unsigned int bin) const { return sum_w[bin]; }
+		double error(unsigned int bin) const { return std::sqrt(sum_w2[bin]); }
+		double sum_squares(unsigned int bin) const { return sum_w2[bin]; }
+		unsigned long entries() const { return nr_entries; }
+		double integral() const;
+		double maximum() const;
+
+		/* binary input & output */
+		void write_binary(std::ostream & os) const;
+		bool read_binary(std::istream & is);
+
+	private:
+		histogram_axis data_axis;
+		std::vector<double> sum_w;
+		std::vector<double> sum_w2;
+		unsigned long nr_entries;
+
+	};
+
+	/* two dimensional histogram data, bins are stored as [x bin][y bin] */
+	class histogram2D_data
+	{
+
+	public:
+
+		/* constructors */
+		histogram2D_data(const histogram_axis & x_axis = histogram_axis(), const histogram_axis & y_axis = histogram_axis());
+
+		/* filling and merging */
+		void fill(double x, double y, double weight = 1);
+		void merge(const histogram2D_data & other);
+		void scale(double factor);
+		void clear();
+
+		/* access */
+		const histogram_axis & x_axis() const { return data_x_axis; }
+		const histogram_axis & y_axis() const { return data_y_axis; }
+		double content(unsigned int xbin, unsigned int ybin) const { return sum_w[index(xbin, ybin)]; }
+		double error(unsigned int xbin, unsigned int ybin) const { return std::sqrt(sum_w2[index(xbin, ybin)]); }
+		unsigned long entries() const { return nr_entries; }
+
+		/* binary input & output */
+		void write_binary(std::ostream & os) const;
+		bool read_binary(std::istream & is);
+
+	private:
+		unsigned int index(unsigned int xbin, unsigned int ybin) const { return xbin * (data_y_axis.nr_bins() + 2) + ybin; }
+
+		histogram_axis data_x_axis;
+		histogram_axis data_y_axis;
+		std::vector<double> sum_w;
+		std::vector<double> sum_w2;
+		unsigned long nr_entries;
+
+	};
+
+	/* per-thread shards of histogram data with the same binning: each thread fills 
+	   its own shard without locking and the shards are merged at the end */
+	template <typename Hist>
+	class histogram_shards
+	{
+
+	public:
+
+		histogram_shards(const Hist & prototype, unsigned int nr_shards) : shards(std::max(1u, nr_shards), prototype) {}
+
+		unsigned int size() const { return shards.size(); }
+		Hist & operator[] (unsigned int n) { return shards[n]; }
+		const Hist & operator[] (unsigned int n) const { return shards[n]; }
+
+		Hist merged() const
+		{
+			Hist result = shards[0];
+			for (unsigned int i = 1; i < shards.size(); ++i)
+				result.merge(shards[i]);
+			return result;
+		}
+
+	private:
+		std::vector<Hist> shards;
+
+	};
+
+/* NAMESPACE */
+}
+
+#endif
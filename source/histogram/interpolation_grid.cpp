@@ -0,0 +1,406 @@
+/* Interpolation grid class
+ *
+ * Linear interpolation of scattered (x, y, z) values, e.g. efficiency or limit
+ * scans. Complete rectilinear grids are interpolated bilinearly, other point
+ * sets are triangulated (Delaunay) once and interpolated barycentrically.
+*/
+
+#include "interpolation_grid.h"
+
+
+/* NAMESPACE */
+namespace analysis
+{
+
+	// tolerance in the unit square for points on circumcircles and triangle edges
+	const double grid_epsilon = 1e-12;
+
+	/* constructors */
+
+	interpolation_grid::interpolation_grid()
+	{
+		x_min = 0;
+		x_scale = 1;
+		y_min = 0;
+		y_scale = 1;
+		outside = 0;
+		rectilinear = false;
+		nr_cells = 0;
+	}
+
+	interpolation_grid::interpolation_grid(const std::vector< std::vector<double> > & list_xyz) : interpolation_grid()
+	{
+		build(list_xyz);
+	}
+
+	void interpolation_grid::build(const std::vector< std::vector<double> > & list_xyz)
+	{
+		std::vector<double> x, y, z;
+		for (unsigned int i = 0; i < list_xyz.size(); ++i)
+		{
+			if (list_xyz[i].size() < 3)
+			{
+				std::cout << "Error: interpolation grid entry " << i << " is not of the form {x, y, z}." << std::endl;
+				exit (EXIT_FAILURE);
+			}
+			x.push_back(list_xyz[i][0]);
+			y.push_back(list_xyz[i][1]);
+			z.push_back(list_xyz[i][2]);
+		}
+		build(x, y, z);
+	}
+
+	void interpolation_grid::build(const std::vector<double> & x, const std::vector<double> & y, const std::vector<double> & z)
+	{
+		if (x.size() != y.size() || x.size() != z.size())
+		{
+			std::cout << "Error: interpolation grid needs the same number of x, y and z values." << std::endl;
+			exit (EXIT_FAILURE);
+		}
+
+		// sort the points by x and y and drop duplicates, keeping the first z
+		std::vector<unsigned int> order(x.size());
+		for (unsigned int i = 0; i < order.size(); ++i)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&x, &y](unsigned int a, unsigned int b)
+		{
+			return x[a] < x[b] || (x[a] == x[b] && y[a] < y[b]);
+		});
+		std::vector<double> sorted_x, sorted_y;
+		point_z.clear();
+		for (unsigned int i = 0; i < order.size(); ++i)
+		{
+			unsigned int p = order[i];
+			if (!sorted_x.empty() && x[p] == sorted_x.back() && y[p] == sorted_y.back())
+				continue;
+			sorted_x.push_back(x[p]);
+			sorted_y.push_back(y[p]);
+			point_z.push_back(z[p]);
+		}
+
+		// scale the coordinates to the unit square, such that the triangulation
+		// does not depend on the units of the two axes
+		x_min = y_min = 0;
+		x_scale = y_scale = 1;
+		if (!sorted_x.empty())
+		{
+			x_min = sorted_x.front();
+			x_scale = sorted_x.back() - x_min;
+			y_min = *std::min_element(sorted_y.begin(), sorted_y.end());
+			y_scale = *std::max_element(sorted_y.begin(), sorted_y.end()) - y_min;
+			if (x_scale <= 0)
+				x_scale = 1;
+			if (y_scale <= 0)
+				y_scale = 1;
+		}
+		point_u.resize(sorted_x.size());
+		point_v.resize(sorted_y.size());
+		for (unsigned int i = 0; i < sorted_x.size(); ++i)
+		{
+			point_u[i] = (sorted_x[i] - x_min) / x_scale;
+			point_v[i] = (sorted_y[i] - y_min) / y_scale;
+		}
+
+		// use the rectilinear grid if all points of it are given, otherwise triangulate
+		triangles.clear();
+		cell_start.clear();
+		cell_triangles.clear();
+		nr_cells = 0;
+		rectilinear = build_rectilinear(sorted_x, sorted_y);
+		if (!rectilinear)
+		{
+			build_triangulation();
+			build_index();
+			if (triangles.empty())
+				std::cout << "Warning: interpolation grid of " << size() << " points has no area to interpolate in." << std::endl;
+		}
+	}
+
+	/* interpolation */
+
+	double interpolation_grid::interpolate(double x, double y) const
+	{
+		if (rectilinear)
+			return interpolate_rectilinear(x, y);
+
+		double b0, b1, b2;
+		int t = find_triangle((x - x_min) / x_scale, (y - y_min) / y_scale, b0, b1, b2);
+		if (t < 0)
+			return outside;
+		return b0 * point_z[triangles[3 * t]] + b1 * point_z[triangles[3 * t + 1]] + b2 * point_z[triangles[3 * t + 2]];
+	}
+
+	std::vector<double> interpolation_grid::interpolate(const std::vector<double> & x, const std::vector<double> & y) const
+	{
+		if (x.size() != y.size())
+		{
+			std::cout << "Error: interpolation needs the same number of x and y values." << std::endl;
+			exit (EXIT_FAILURE);
+		}
+		std::vector<double> z(x.size());
+		for (unsigned int i = 0; i < x.size(); ++i)
+			z[i] = interpolate(x[i], y[i]);
+		return z;
+	}
+
+	bool interpolation_grid::is_inside(double x, double y) const
+	{
+		if (rectilinear)
+			return x >= grid_x.front() && x <= grid_x.back() && y >= grid_y.front() && y <= grid_y.back();
+		double b0, b1, b2;
+		return find_triangle((x - x_min) / x_scale, (y - y_min) / y_scale, b0, b1, b2) >= 0;
+	}
+
+	/* rectilinear grid */
+
+	bool interpolation_grid::build_rectilinear(const std::vector<double> & x, const std::vector<double> & y)
+	{
+		grid_x = x;
+		grid_y = y;
+		std::sort(grid_y.begin(), grid_y.end());
+		grid_x.erase(std::unique(grid_x.begin(), grid_x.end()), grid_x.end());
+		grid_y.erase(std::unique(grid_y.begin(), grid_y.end()), grid_y.end());
+
+		// the points are unique, so all grid points are present if their numbers agree
+		unsigned int nx = grid_x.size(), ny = grid_y.size();
+		if (nx < 2 || ny < 2 || nx * ny != x.size())
+		{
+			grid_x.clear();
+			grid_y.clear();
+			grid_z.clear();
+			return false;
+		}
+
+		// the points are sorted by x and then y, which is the storage order
+		grid_z = point_z;
+		return true;
+	}
+
+	double interpolation_grid::interpolate_rectilinear(double x, double y) const
+	{
+		if (x < grid_x.front() || x > grid_x.back() || y < grid_y.front() || y > grid_y.back())
+			return outside;
+
+		// find the cell by bisection of both axes
+		unsigned int nx = grid_x.size(), ny = grid_y.size();
+		unsigned int ix = std::min<unsigned int>(std::upper_bound(grid_x.begin(), grid_x.end(), x) - grid_x.begin(), nx - 1) - 1;
+		unsigned int iy = std::min<unsigned int>(std::upper_bound(grid_y.begin(), grid_y.end(), y) - grid_y.begin(), ny - 1) - 1;
+		double tx = (x - grid_x[ix]) / (grid_x[ix + 1] - grid_x[ix]);
+		double ty = (y - grid_y[iy]) / (grid_y[iy + 1] - grid_y[iy]);
+
+		// bilinear interpolation of the cell corners
+		double z00 = grid_z[ix * ny + iy], z01 = grid_z[ix * ny + iy + 1];
+		double z10 = grid_z[(ix + 1) * ny + iy], z11 = grid_z[(ix + 1) * ny + iy + 1];
+		return (1 - tx) * ((1 - ty) * z00 + ty * z01) + tx * ((1 - ty) * z10 + ty * z11);
+	}
+
+	/* triangulation */
+
+	void interpolation_grid::build_triangulation()
+	{
+		// sweep over the points sorted by u: each point lies outside the convex hull of the
+		// previous ones and is connected to the hull edges it sees, such that the triangles
+		// cover the whole convex hull; Lawson flips then make the triangulation Delaunay
+		unsigned int n = point_u.size();
+		if (n < 3)
+			return;
+		const std::vector<double> & u = point_u;
+		const std::vector<double> & v = point_v;
+		auto orient = [&u, &v](unsigned int a, unsigned int b, unsigned int c)
+		{
+			return (u[b] - u[a]) * (v[c] - v[a]) - (v[b] - v[a]) * (u[c] - u[a]);
+		};
+
+		// counter-clockwise triangles, indexed by their directed edges
+		std::unordered_map<unsigned long long, unsigned int> edge_triangle;
+		auto edge_key = [n](unsigned int a, unsigned int b) { return static_cast<unsigned long long>(a) * n + b; };
+		auto set_triangle = [this, &edge_triangle, &edge_key](unsigned int t, unsigned int a, unsigned int b, unsigned int c)
+		{
+			if (3 * t == triangles.size())
+				triangles.resize(3 * t + 3);
+			triangles[3 * t] = a; triangles[3 * t + 1] = b; triangles[3 * t + 2] = c;
+			edge_triangle[edge_key(a, b)] = t;
+			edge_triangle[edge_key(b, c)] = t;
+			edge_triangle[edge_key(c, a)] = t;
+		};
+
+		// the first points on a line are connected to the first point off it
+		unsigned int k = 2;
+		while (k < n && std::abs(orient(0, k - 1, k)) < grid_epsilon)
+			++k;
+		if (k == n)
+			return;
+		bool left = orient(0, k - 1, k) > 0;
+		std::vector<unsigned int> hull_order(1, 0);
+		for (unsigned int j = 0; j + 1 < k; ++j)
+		{
+			if (left)
+				set_triangle(nr_triangles(), j, j + 1, k);
+			else
+				set_triangle(nr_triangles(), j + 1, j, k);
+			hull_order.push_back(left ? j + 1 : k - 1 - j);
+		}
+		hull_order.insert(left ? hull_order.end() : hull_order.begin() + 1, k);
+
+		// convex hull as a counter-clockwise linked list, the last point added is on it
+		std::vector<unsigned int> next(n), prev(n);
+		for (unsigned int j = 0; j < hull_order.size(); ++j)
+		{
+			next[hull_order[j]] = hull_order[(j + 1) % hull_order.size()];
+			prev[hull_order[(j + 1) % hull_order.size()]] = hull_order[j];
+		}
+		unsigned int last = k;
+		for (unsigned int i = k + 1; i < n; ++i)
+		{
+			// the visible hull edges are next to the last point added
+			unsigned int first = last, end = last;
+			while (orient(end, next[end], i) < -grid_epsilon)
+			{
+				set_triangle(nr_triangles(), end, i, next[end]);
+				end = next[end];
+			}
+			while (orient(prev[first], first, i) < -grid_epsilon)
+			{
+				set_triangle(nr_triangles(), prev[first], i, first);
+				first = prev[first];
+			}
+
+			// points on the hull within the tolerance are not connected
+			if (first == end)
+				continue;
+			next[first] = i;
+			prev[i] = first;
+			next[i] = end;
+			prev[end] = i;
+			last = i;
+		}
+
+		// flip the edges whose opposite vertex lies inside the circumcircle of the triangle
+		auto third = [this](unsigned int t, unsigned int a, unsigned int b)
+		{
+			const unsigned int *p = &triangles[3 * t];
+			return p[0] != a && p[0] != b ? p[0] : (p[1] != a && p[1] != b ? p[1] : p[2]);
+		};
+		auto in_circle = [&u, &v](unsigned int a, unsigned int b, unsigned int c, unsigned int d)
+		{
+			double adx = u[a] - u[d], ady = v[a] - v[d];
+			double bdx = u[b] - u[d], bdy = v[b] - v[d];
+			double cdx = u[c] - u[d], cdy = v[c] - v[d];
+			return (adx * adx + ady * ady) * (bdx * cdy - cdx * bdy) + (bdx * bdx + bdy * bdy) * (cdx * ady - adx * cdy) + (cdx * cdx + cdy * cdy) * (adx * bdy - bdx * ady);
+		};
+		std::vector< std::pair<unsigned int, unsigned int> > edges;
+		for (unsigned int j = 0; j < triangles.size(); j += 3)
+		{
+			edges.push_back(std::make_pair(triangles[j], triangles[j + 1]));
+			edges.push_back(std::make_pair(triangles[j + 1], triangles[j + 2]));
+			edges.push_back(std::make_pair(triangles[j + 2], triangles[j]));
+		}
+		while (!edges.empty())
+		{
+			unsigned int a = edges.back().first, b = edges.back().second;
+			edges.pop_back();
+			auto t1 = edge_triangle.find(edge_key(a, b));
+			auto t2 = edge_triangle.find(edge_key(b, a));
+			if (t1 == edge_triangle.end() || t2 == edge_triangle.end())
+				continue;
+			unsigned int c = third(t1->second, a, b), d = third(t2->second, a, b);
+			if (in_circle(a, b, c, d) <= grid_epsilon || orient(a, d, c) <= grid_epsilon || orient(d, b, c) <= grid_epsilon)
+				continue;
+
+			// replace the triangles (a, b, c) and (b, a, d) by (a, d, c) and (d, b, c)
+			unsigned int s1 = t1->second, s2 = t2->second;
+			edge_triangle.erase(t1);
+			edge_triangle.erase(edge_key(b, a));
+			set_triangle(s1, a, d, c);
+			set_triangle(s2, d, b, c);
+			edges.push_back(std::make_pair(a, d));
+			edges.push_back(std::make_pair(d, b));
+			edges.push_back(std::make_pair(b, c));
+			edges.push_back(std::make_pair(c, a));
+		}
+
+		// keep the triangles with an area
+		unsigned int kept = 0;
+		for (unsigned int j = 0; j < triangles.size(); j += 3)
+		{
+			const unsigned int *p = &triangles[j];
+			if (std::abs(orient(p[0], p[1], p[2])) < grid_epsilon)
+				continue;
+			std::copy(p, p + 3, triangles.begin() + kept);
+			kept += 3;
+		}
+		triangles.resize(kept);
+	}
+
+	void interpolation_grid::build_index()
+	{
+		// square cells with about one triangle per cell, each triangle is
+		// listed in all cells overlapped by its bounding box
+		unsigned int nr_tri = nr_triangles();
+		nr_cells = std::max(1u, static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<double>(nr_tri)))));
+		std::vector<unsigned int> cell_range(4 * nr_tri);
+		cell_start.assign(nr_cells * nr_cells + 1, 0);
+		for (unsigned int t = 0; t < nr_tri; ++t)
+		{
+			const unsigned int *p = &triangles[3 * t];
+			double u_min = std::min(point_u[p[0]], std::min(point_u[p[1]], point_u[p[2]]));
+			double u_max = std::max(point_u[p[0]], std::max(point_u[p[1]], point_u[p[2]]));
+			double v_min = std::min(point_v[p[0]], std::min(point_v[p[1]], point_v[p[2]]));
+			double v_max = std::max(point_v[p[0]], std::max(point_v[p[1]], point_v[p[2]]));
+			unsigned int *range = &cell_range[4 * t];
+			range[0] = std::min(nr_cells - 1, static_cast<unsigned int>(std::max(0.0, u_min - grid_epsilon) * nr_cells));
+			range[1] = std::min(nr_cells - 1, static_cast<unsigned int>(std::max(0.0, u_max + grid_epsilon) * nr_cells));
+			range[2] = std::min(nr_cells - 1, static_cast<unsigned int>(std::max(0.0, v_min - grid_epsilon) * nr_cells));
+			range[3] = std::min(nr_cells - 1, static_cast<unsigned int>(std::max(0.0, v_max + grid_epsilon) * nr_cells));
+			for (unsigned int cu = range[0]; cu <= range[1]; ++cu)
+				for (unsigned int cv = range[2]; cv <= range[3]; ++cv)
+					cell_start[cu * nr_cells + cv + 1]++;
+		}
+		for (unsigned int c = 0; c < nr_cells * nr_cells; ++c)
+			cell_start[c + 1] += cell_start[c];
+
+		std::vector<unsigned int> fill(cell_start.begin(), cell_start.end() - 1);
+		cell_triangles.resize(cell_start.back());
+		for (unsigned int t = 0; t < nr_tri; ++t)
+		{
+			const unsigned int *range = &cell_range[4 * t];
+			for (unsigned int cu = range[0]; cu <= range[1]; ++cu)
+				for (unsigned int cv = range[2]; cv <= range[3]; ++cv)
+					cell_triangles[fill[cu * nr_cells + cv]++] = t;
+		}
+	}
+
+	int interpolation_grid::find_triangle(double u, double v, double & b0, double & b1, double & b2) const
+	{
+		if (nr_cells == 0 || !(u >= -grid_epsilon && u <= 1 + grid_epsilon && v >= -grid_epsilon && v <= 1 + grid_epsilon))
+			return -1;
+
+		// test the triangles of the cell with barycentric coordinates, the tolerance applies to the
+		// sub-triangle areas such that points on the edges of thin triangles are inside
+		unsigned int cu = std::min(nr_cells - 1, static_cast<unsigned int>(std::max(0.0, u) * nr_cells));
+		unsigned int cv = std::min(nr_cells - 1, static_cast<unsigned int>(std::max(0.0, v) * nr_cells));
+		unsigned int cell = cu * nr_cells + cv;
+		for (unsigned int i = cell_start[cell]; i < cell_start[cell + 1]; ++i)
+		{
+			unsigned int t = cell_triangles[i];
+			const unsigned int *p = &triangles[3 * t];
+			double u0 = point_u[p[0]], v0 = point_v[p[0]];
+			double u1 = point_u[p[1]], v1 = point_v[p[1]];
+			double u2 = point_u[p[2]], v2 = point_v[p[2]];
+			double det = (v1 - v2) * (u0 - u2) + (u2 - u1) * (v0 - v2);
+			double a0 = ((v1 - v2) * (u - u2) + (u2 - u1) * (v - v2)) * (det > 0 ? 1 : -1);
+			double a1 = ((v2 - v0) * (u - u2) + (u0 - u2) * (v - v2)) * (det > 0 ? 1 : -1);
+			double a2 = std::abs(det) - a0 - a1;
+			if (a0 >= -grid_epsilon && a1 >= -grid_epsilon && a2 >= -grid_epsilon)
+			{
+				b0 = a0 / std::abs(det);
+				b1 = a1 / std::abs(det);
+				b2 = 1 - b0 - b1;
+				return t;
+			}
+		}
+		return -1;
+	}
+
+/* NAMESPACE */
+}
@@ -0,0 +1,84 @@
+/* Interpolation grid class
+ *
+ * Linear interpolation of scattered (x, y, z) values, e.g. efficiency or limit
+ * scans. Complete rectilinear grids are interpolated bilinearly, other point
+ * sets are triangulated (Delaunay) over their convex hull once and interpolated
+ * barycentrically.
+*/
+
+#ifndef INC_INTERPOLATION_GRID
+#define INC_INTERPOLATION_GRID
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+/* NAMESPACE */
+namespace analysis
+{
+
+	class interpolation_grid
+	{
+
+	public:
+
+		/* constructors: from a list of {x, y, z} entries, duplicate (x, y) keep the first z */
+		interpolation_grid();
+		interpolation_grid(const std::vector< std::vector<double> > & list_xyz);
+		void build(const std::vector< std::vector<double> > & list_xyz);
+		void build(const std::vector<double> & x, const std::vector<double> & y, const std::vector<double> & z);
+
+		/* interpolation: points outside the convex hull of the data give the outside value */
+		double interpolate(double x, double y) const;
+		std::vector<double> interpolate(const std::vector<double> & x, const std::vector<double> & y) const;
+		bool is_inside(double x, double y) const;
+		void set_outside(double value) { outside = value; }
+
+		/* grid properties */
+		unsigned int size() const { return point_z.size(); }
+		bool is_rectilinear() const { return rectilinear; }
+		unsigned int nr_triangles() const { return triangles.size() / 3; }
+
+	private:
+
+		/* rectilinear grid */
+		bool build_rectilinear(const std::vector<double> & x, const std::vector<double> & y);
+		double interpolate_rectilinear(double x, double y) const;
+
+		/* triangulation, in coordinates scaled to the unit square */
+		void build_triangulation();
+		void build_index();
+		int find_triangle(double u, double v, double & b0, double & b1, double & b2) const;
+
+		/* data points, with coordinates scaled to the unit square */
+		std::vector<double> point_u;
+		std::vector<double> point_v;
+		std::vector<double> point_z;
+		double x_min, x_scale;
+		double y_min, y_scale;
+		double outside;
+
+		/* rectilinear grid: z is stored as [ix * ny + iy] */
+		bool rectilinear;
+		std::vector<double> grid_x;
+		std::vector<double> grid_y;
+		std::vector<double> grid_z;
+
+		/* triangles as vertex index triplets and a bucket index of the triangles
+		   overlapping each cell, stored as offsets into one list */
+		std::vector<unsigned int> triangles;
+		unsigned int nr_cells;
+		std::vector<unsigned int> cell_start;
+		std::vector<unsigned int> cell_triangles;
+
+	};
+
+/* NAMESPACE */
+}
+
+#endif
@@ -0,0 +1,128 @@
+/* Quantile sketch class
+ *
+ * Mergeable streaming quantile estimate (KLL style): values are kept in 
+ * levels of compactors, an item on level h represents 2^h values, such that
+ * the memory grows only logarithmically with the number of values.
+*/
+
+#include "quantile_sketch.h"
+
+
+/* NAMESPACE */
+namespace analysis 
+{
+
+	/* constructor */
+
+	quantile_sketch::quantile_sketch(unsigned int k)
+	{
+		sketch_k = std::max(8u, k);
+		clear();
+	}
+
+	/* adding values and merging sketches */
+
+	void quantile_sketch::add(double x)
+	{
+		levels[0].push_back(x);
+		nr_values++;
+		value_min = std::min(value_min, x);
+		value_max = std::max(value_max, x);
+		if (levels[0].size() > capacity(0))
+			compress();
+	}
+
+	void quantile_sketch::merge(const quantile_sketch & other)
+	{
+		if (levels.size() < other.levels.size())
+			levels.resize(other.levels.size());
+		for (unsigned int h = 0; h < other.levels.size(); ++h)
+			levels[h].insert(levels[h].end(), other.levels[h].begin(), other.levels[h].end());
+		nr_values += other.nr_values;
+		value_min = std::min(value_min, other.value_min);
+		value_max = std::max(value_max, other.value_max);
+		compress();
+	}
+
+	void quantile_sketch::clear()
+	{
+		levels.assign(1, std::vector<double>());
+		nr_values = 0;
+		value_min = std::numeric_limits<double>::infinity();
+		value_max = -std::numeric_limits<double>::infinity();
+	}
+
+	// the top level holds k items, lower levels geometrically less down to two
+	unsigned int quantile_sketch::capacity(unsigned int level) const
+	{
+		unsigned int depth = levels.size() - 1 - level;
+		return std::max(2u, static_cast<unsigned int>(std::ceil(sketch_k * std::pow(2.0 / 3.0, depth))));
+	}
+
+	// compacts full levels: half of the sorted items, randomly the even or odd 
+	// positions, move one level up with double weight
+	void quantile_sketch::compress()
+	{
+		for (unsigned int h = 0; h < levels.size(); ++h)
+		{
+			if (levels[h].size() <= capacity(h))
+				continue;
+			if (h + 1 == levels.size())
+				levels.push_back(std::vector<double>());
+
+			std::vector<double> & level = levels[h];
+			std::sort(level.begin(), level.end());
+			// a random item stays on this level if the number is odd, 
+			// keeping always the largest one would bias the promoted items
+			double rest = 0;
+			bool has_rest = level.size() % 2 == 1;
+			if (has_rest)
+			{
+				unsigned int r = coin() % level.size();
+				rest = level[r];
+				level.erase(level.begin() + r);
+			}
+			for (unsigned int i = coin() % 2; i < level.size(); i += 2)
+				levels[h + 1].push_back(level[i]);
+			level.clear();
+			if (has_rest)
+				level.push_back(rest);
+		}
+	}
+
+	/* estimates */
+
+	double quantile_sketch::quantile(double q) const
+	{
+		if (nr_values == 0)
+			return 0;
+		if (q <= 0)
+			return value_min;
+		if (q >= 1)
+			return value_max;
+
+		// weighted items sorted by value
+		std::vector< std::pair<double, double> > items;
+		double total = 0;
+		for (unsigned int h = 0; h < levels.size(); ++h)
+		{
+			double weight = std::ldexp(1.0, h);
+			for (unsigned int i = 0; i < levels[h].size(); ++i)
+				items.push_back(std::make_pair(levels[h][i], weight));
+			total += weight * levels[h].size();
+		}
+		std::sort(items.begin(), items.end());
+
+		double rank = q * total;
+		double cumulative = 0;
+		for (unsigned int i = 0; i < items.size(); ++i)
+		{
+			cumulative += items[i].second;
+			if (cumulative >= rank)
+				return items[i].first;
+		}
+		return value_max;
+	}
+
+/* NAMESPACE */
+}
@@ -0,0 +1,58 @@
+/* Quantile sketch class
+ *
+ * Mergeable streaming quantile estimate (KLL style): values are kept in 
+ * levels of compactors, an item on level h represents 2^h values, such that
+ * the memory grows only logarithmically with the number of values.
+*/
+
+#ifndef INC_QUANTILE_SKETCH
+#define INC_QUANTILE_SKETCH
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+
+/* NAMESPACE */
+namespace analysis 
+{
+
+	class quantile_sketch
+	{
+
+	public:
+
+		/* constructor: k controls the accuracy, the rank error is of order 1/k */
+		quantile_sketch(unsigned int k = 200);
+
+		/* adding values and merging sketches */
+		void add(double x);
+		void merge(const quantile_sketch & other);
+		void clear();
+
+		/* estimates */
+		double quantile(double q) const;
+		unsigned long count() const { return nr_values; }
+		double min() const { return value_min; }
+		double max() const { return value_max; }
+
+	private:
+		unsigned int capacity(unsigned int level) const;
+		void compress();
+
+		unsigned int sketch_k;
+		std::vector< std::vector<double> > levels;
+		unsigned long nr_values;
+		double value_min;
+		double value_max;
+		std::minstd_rand coin;
+
+	};
+
+/* NAMESPACE */
+}
+
+#endif
@@ -0,0 +1,123 @@
+/* Render queue class
+ *
+ * Collects finished histograms and renders them in ROOT batch mode across 
+ * worker processes, each worker sets the shared style once. Rendering can
+ * run in the background while the analysis continues.
+*/
+
+#include "render_queue.h"
+
+
+/* NAMESPACE */
+namespace analysis 
+{
+
+	/* con & destructor */
+
+	render_queue::render_queue(int workers)
+	{
+		nr_workers = std::max(1, workers);
+	}
+
+	render_queue::~render_queue()
+	{
+		wait();
+	}
+
+	/* queue */
+
+	void render_queue::add(const histogram & hist)
+	{
+		list_hist.push_back(hist);
+	}
+
+	void render_queue::add(const histogram2D & hist)
+	{
+		list_hist2D.push_back(hist);
+	}
+
+	unsigned int render_queue::size() const
+	{
+		return list_hist.size() + list_hist2D.size();
+	}
+
+	/* rendering */
+
+	void render_queue::start()
+	{
+		unsigned int nr_plots = size();
+		if (nr_plots == 0)
+			return;
+		
+		// the forked workers get a snapshot of the queue, flush the 
+		// output first such that it is not duplicated by the workers
+		unsigned int workers = std::min(static_cast<unsigned int>(nr_workers), nr_plots);
+		std::cout.flush();
+		fflush(stdout);
+		for (unsigned int w = 0; w < workers; ++w)
+		{
+			pid_t pid = fork();
+			if (pid == 0)
+			{
+				render_worker(w, workers);
+				std::cout.flush();
+				fflush(stdout);
+				_exit(EXIT_SUCCESS);
+			}
+			else if (pid > 0)
+				running.push_back(pid);
+			else
+			{
+				// render the remaining share in this process if no worker could be created
+				std::cout << "Warning: could not start render worker, rendering in the main process." << std::endl;
+				for (unsigned int r = w; r < workers; ++r)
+					render_worker(r, workers);
+				break;
+			}
+		}
+
+		// the queue is handed to the workers
+		list_hist.clear();
+		list_hist2D.clear();
+	}
+
+	bool render_queue::wait()
+	{
+		bool success = true;
+		for (unsigned int i = 0; i < running.size(); ++i)
+		{
+			int status = 0;
+			if (waitpid(running[i], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+			{
+				std::cout << "Warning: render worker " << running[i] << " did not finish successfully." << std::endl;
+				success = false;
+			}
+		}
+		running.clear();
+		return success;
+	}
+
+	bool render_queue::render()
+	{
+		start();
+		return wait();
+	}
+
+	void render_queue::render_worker(unsigned int worker, unsigned int workers)
+	{
+		// render without display and set the style of each histogram type once
+		bool batch = gROOT->IsBatch();
+		gROOT->SetBatch(kTRUE);
+		if (worker < list_hist.size())
+			histogram::set_style();
+		for (unsigned int i = worker; i < list_hist.size(); i += workers)
+			list_hist[i].draw(false);
+		if (worker < list_hist2D.size())
+			histogram2D::set_style();
+		for (unsigned int i = worker; i < list_hist2D.size(); i += workers)
+			list_hist2D[i].draw(false);
+		gROOT->SetBatch(batch);
+	}
+
+/* NAMESPACE */
+}
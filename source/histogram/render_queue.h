@@ -0,0 +1,65 @@
+/* Render queue class
+ *
+ * Collects finished histograms and renders them in ROOT batch mode across 
+ * worker processes, each worker sets the shared style once. Rendering can
+ * run in the background while the analysis continues.
+*/
+
+#ifndef INC_RENDER_QUEUE
+#define INC_RENDER_QUEUE
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <TROOT.h>
+
+#include "histogram.h"
+#include "histogram2D.h"
+
+
+/* NAMESPACE */
+namespace analysis 
+{
+
+	class render_queue
+	{
+
+	public:
+
+		/* con & destructor: the destructor waits for running workers */
+		render_queue(int workers = 1);
+		~render_queue();
+		
+		/* queue a copy of a finished histogram, later changes do not affect the queue */
+		void add(const histogram & hist);
+		void add(const histogram2D & hist);
+		unsigned int size() const;
+
+		/* start renders the queued histograms in the background and empties the queue,
+		   wait blocks until all started workers are done; render does both */
+		void start();
+		bool wait();
+		bool render();
+
+	private:
+
+		void render_worker(unsigned int worker, unsigned int nr_workers);
+
+		std::vector<histogram> list_hist;
+		std::vector<histogram2D> list_hist2D;
+		std::vector<pid_t> running;
+		int nr_workers;
+
+	};
+
+/* NAMESPACE */
+}
+
+#endif
@@ -33,11 +33,27 @@ namespace analysis
 		_nfilt(5),_jet_algorithm(fastjet::cambridge_algorithm),_jet_algorithm_recluster(fastjet::cambridge_algorithm)
 		{}
 
+	HEPTopTagger::HEPTopTagger(double mtmass, double mwmass) : 
+		debugg(false),
+		_cs(0), _mtmass(mtmass), _mwmass(mwmass), 
+		_mass_drop_threshold(0.8), _max_subjet_mass(30.),
+		_mtmin(mtmass - 25.),_mtmax(mtmass + 25.), _rmin(0.85*mwmass/mtmass),_rmax(1.15*mwmass/mtmass),
+		_m23cut(0.35),_m13cutmin(0.2),_m13cutmax(1.3),
+		_nfilt(5),_jet_algorithm(fastjet::cambridge_algorithm),_jet_algorithm_recluster(fastjet::cambridge_algorithm)
+		{}
+
 
 	// ========================================== // 
 	//	   		    Class Functions			   	  //
 	// ========================================== //
 
+	void HEPTopTagger::run_tagger(const fastjet::ClusterSequence & cs, const fastjet::PseudoJet & jet)
+	{
+		_cs = &cs;
+		_jet = jet;
+		run_tagger();
+	}
+
 	void HEPTopTagger::run_tagger()
 	{
 		_delta_top=1000000000000.0;
@@ -67,26 +83,54 @@ namespace analysis
 		// these events are not interesting 
 		if(_top_parts.size() < 3){return;}
 
-		for(unsigned rr=0; rr<_top_parts.size(); rr++){
-		for(unsigned ll=rr+1; ll<_top_parts.size(); ll++){
-		  for(unsigned kk=ll+1; kk<_top_parts.size(); kk++){
+		// constituents of the hard parts and their pairwise distances and invariant masses, 
+		// shared by all triplets
+		unsigned nparts = _top_parts.size();
+		std::vector< std::vector<fastjet::PseudoJet> > parts_constits(nparts);
+		std::vector<fastjet::PseudoJet> parts_sum(nparts);
+		for(unsigned ii=0; ii<nparts; ii++){
+		parts_constits[ii] = _cs->constituents(_top_parts[ii]);
+		parts_sum[ii] = Sum(parts_constits[ii]);
+		}
+		std::vector<double> parts_dist2(nparts*nparts), parts_m2(nparts*nparts);
+		for(unsigned ii=0; ii<nparts; ii++){
+		for(unsigned jj=ii; jj<nparts; jj++){
+		parts_dist2[ii*nparts+jj] = parts_dist2[jj*nparts+ii] = _top_parts[ii].squared_distance(_top_parts[jj]);
+		parts_m2[ii*nparts+jj] = parts_m2[jj*nparts+ii] = (ii == jj) ? parts_sum[ii].m2() : (parts_sum[ii]+parts_sum[jj]).m2();
+		}
+		}
+
+		// filtering only removes constituents and can not increase the invariant mass of a 
+		// triplet, so triplets below the top mass window are skipped before filtering
+		double mtmin2 = _mtmin > 0 ? _mtmin*_mtmin*(1.-1e-6) : 0.;
+		fastjet::JetDefinition reclustering(_jet_algorithm_recluster, 3.14/2);
+		std::vector <fastjet::PseudoJet> top_constits;
+
+		for(unsigned rr=0; rr<nparts; rr++){
+		for(unsigned ll=rr+1; ll<nparts; ll++){
+		  for(unsigned kk=ll+1; kk<nparts; kk++){
+		// triplet mass from the pairwise masses: m123^2 = m12^2 + m13^2 + m23^2 - m1^2 - m2^2 - m3^2
+		double triplet_m2 = parts_m2[rr*nparts+ll] + parts_m2[rr*nparts+kk] + parts_m2[ll*nparts+kk] 
+		  - parts_m2[rr*nparts+rr] - parts_m2[ll*nparts+ll] - parts_m2[kk*nparts+kk];
+		if( triplet_m2 < mtmin2 ) continue;
+
 		// define top_constituents candidate before filtering 	      
-		std::vector <fastjet::PseudoJet> top_constits = _cs->constituents(_top_parts[rr]);
-		_cs->add_constituents(_top_parts[ll],top_constits);
-		_cs->add_constituents(_top_parts[kk],top_constits);	      
+		top_constits.clear();
+		top_constits.insert(top_constits.end(), parts_constits[rr].begin(), parts_constits[rr].end());
+		top_constits.insert(top_constits.end(), parts_constits[ll].begin(), parts_constits[ll].end());
+		top_constits.insert(top_constits.end(), parts_constits[kk].begin(), parts_constits[kk].end());
 
 			  // define Filtering: filt_top_R and jetdefinition 
 		double filt_top_R 
-		  = std::min(0.3,0.5*sqrt(std::min(_top_parts[kk].squared_distance(_top_parts[ll]),
-					 std::min(_top_parts[rr].squared_distance(_top_parts[ll]),
-						 _top_parts[kk].squared_distance(_top_parts[rr])))));
+		  = std::min(0.3,0.5*sqrt(std::min(parts_dist2[kk*nparts+ll],
+					 std::min(parts_dist2[rr*nparts+ll],
+						 parts_dist2[kk*nparts+rr]))));
 		fastjet::JetDefinition filtering_def(_jet_algorithm, filt_top_R);
 		std::vector<fastjet::PseudoJet> top_constits_filtered = Filtering(top_constits,filtering_def);
 		fastjet::PseudoJet topcandidate = Sum(top_constits_filtered);
 		if( topcandidate.m() < _mtmin || _mtmax < topcandidate.m() ) continue;
 		_top_count++;
 		// obtain 3 subjets
-		fastjet::JetDefinition reclustering(_jet_algorithm_recluster, 3.14/2);
 		fastjet::ClusterSequence cssubtop(top_constits_filtered,reclustering);
 		std::vector <fastjet::PseudoJet> top_subs = sorted_by_pt(cssubtop.exclusive_jets(3));	      
 		_candjets.push_back(top_subs); //
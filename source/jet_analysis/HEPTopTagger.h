@@ -29,7 +29,11 @@ namespace analysis
 
 		HEPTopTagger(const fastjet::ClusterSequence & cs, const fastjet::PseudoJet & jet, double mtmass, double mwmass);
 
+		// configured tagger without a jet, which is set for each run
+		HEPTopTagger(double mtmass, double mwmass);
+
 		void run_tagger();
+		void run_tagger(const fastjet::ClusterSequence & cs, const fastjet::PseudoJet & jet);
 		bool is_maybe_top() const {return _is_maybe_top;}
 		bool is_masscut_passed() const {return _is_masscut_passed;}
 		const fastjet::PseudoJet & top_candidate() const {return _top_candidate;}
@@ -60,7 +64,7 @@ namespace analysis
 	private:
 	
 		const fastjet::ClusterSequence * _cs;
-		const fastjet::PseudoJet _jet;
+		fastjet::PseudoJet _jet;
 		const double _mtmass, _mwmass;
 		double _mass_drop_threshold;
 		double _max_subjet_mass; // stop when subjet mass < 30 GeV
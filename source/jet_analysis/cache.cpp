@@ -0,0 +1,232 @@
+/* Jet analysis class: Shower and cluster cache
+ *
+ * Stores the lhco events and tagged fat jets of an initialisation in a binary
+ * file, keyed by the LHE input and all shower, clustering and tagging settings.
+*/
+
+#include <iomanip>
+#include <sstream>
+
+#include "jet_analysis.h"
+
+
+/* NAMESPACE */
+namespace analysis
+{
+
+	/* shower and cluster cache */
+
+	// version of the binary cache format, increase when the layout changes
+	const unsigned int cache_version = 3;
+
+	std::string jet_analysis::cache_file(tagger_function TopTagger)
+	{
+		// Identify the top tagger, user defined taggers can not be cached
+		std::string tagger_name;
+		if ( TopTagger == &jet_analysis::JHTopTagging )
+			tagger_name = "JHTopTagger";
+		else if ( TopTagger == &jet_analysis::HEPTopTagging )
+			tagger_name = "HEPTopTagger";
+		else
+		{
+			std::cout << "Warning: unknown top tagger, the shower and cluster cache is not used." << std::endl;
+			return "";
+		}
+
+		// Hash the LHE input of all merged samples and the possibly imported lhco file
+		unsigned long long hash = hash_file(lhe_input);
+		for (int njet = 1; DoMerging && njet <= MergingNJetMax; ++njet)
+		{
+			std::string input_file = lhe_input;
+			input_file.insert(input_file.size() - 4, "_j" + boost::lexical_cast<std::string>(njet));
+			hash = hash_file(input_file, hash);
+		}
+		if ( importedLHCO )
+			hash = hash_file(lhco_input, hash);
+
+		// Collect all settings which influence the showered and clustered events
+		std::ostringstream settings;
+		settings << std::setprecision(17);
+		settings << "input " << hash << " " << importedLHCO << "\n";
+		settings << "events " << nEvent << " " << nWorkers << " " << Seed << " " << fast_showering << "\n";
+		settings << "detector " << MaxEta << " " << jetMinPt << "\n";
+		settings << "electron " << electronMaxEta << " " << electronMinPt << " " << deltaR_IsoEl << " " << pTminTrack_IsoEl << " " << pTfracMax_IsoEl << "\n";
+		settings << "muon " << muonMaxEta << " " << muonMinPt << " " << deltaR_IsoMuon << " " << pTminTrack_IsoMuon << " " << pTfracMax_IsoMuon << "\n";
+		settings << "photon " << photonMaxEta << " " << photonMinPt << " " << deltaR_IsoGamma << " " << pTminTrack_IsoGamma << " " << pTfracMax_IsoGamma << "\n";
+		settings << "overlap " << overlap.settings() << "\n";
+		settings << "merging " << DoMerging;
+		if ( DoMerging )
+			settings << " " << MergingProcess << " " << MergingNJetMax << " " << MergingScale << " " << PythiaDecay;
+		settings << "\n";
+		settings << "pileup " << DoPileup;
+		if ( DoPileup )
+			settings << " " << pileup_mu << " " << pileup_pool_size << " " << pileup_ecm << " " << pileup_file << " " << hash_file(pileup_file);
+		settings << "\n";
+		settings << "clustering " << algorithm_fat << " " << Rsize_fat << " " << algorithm_skinny << " " << Rsize_skinny << "\n";
+		settings << "toptagger " << DoTopTagger << " " << tagger_name << " " << JHTopTagger_delta_p << " " << JHTopTagger_delta_r << "\n";
+		settings << "bdrs " << DoBDRS << " " << BDRS_w_min << " " << BDRS_w_max << " " << BDRS_higgs_min << " " << BDRS_higgs_max << "\n";
+
+		// The cache file name is the hash of the settings, which are also stored in the file to exclude collisions
+		std::string key = settings.str();
+		unsigned long long key_hash = hash_string(key);
+		std::ostringstream name;
+		name << "jet_analysis_" << std::hex << std::setw(16) << std::setfill('0') << key_hash << ".cache";
+		cache_key = key;
+
+		return (boost::filesystem::path(cache_dir) / name.str()).string();
+	}
+
+	bool jet_analysis::read_cache(const std::string & file)
+	{
+		std::ifstream ifs(file.c_str(), std::ios::binary);
+		if ( !ifs.is_open() )
+			return false;
+
+		// Check the cache version and settings, the key is only read if it has the expected length
+		unsigned int version = 0;
+		ifs.read(reinterpret_cast<char*>(&version), sizeof(version));
+		unsigned int key_size = 0;
+		ifs.read(reinterpret_cast<char*>(&key_size), sizeof(key_size));
+		std::string key;
+		if ( ifs && version == cache_version && key_size == cache_key.size() )
+		{
+			key.assign(key_size, ' ');
+			if ( key_size > 0 )
+				ifs.read(&key[0], key_size);
+		}
+		if ( !ifs || version != cache_version || key_size != cache_key.size() || key != cache_key )
+		{
+			std::cout << "Warning: shower and cluster cache " << file << " does not match the settings." << std::endl;
+			return false;
+		}
+
+		// Merged cross section
+		double sigma, sigmaErr;
+		ifs.read(reinterpret_cast<char*>(&sigma), sizeof(double));
+		ifs.read(reinterpret_cast<char*>(&sigmaErr), sizeof(double));
+
+		// Read events and tagged jets into temporary records, only accepted when the file is complete
+		std::vector< tagged_event > cached_records;
+		unsigned int nr_events = 0;
+		ifs.read(reinterpret_cast<char*>(&nr_events), sizeof(nr_events));
+		for (unsigned int iEv = 0; ifs && iEv < nr_events; ++iEv)
+		{
+			// lhco objects
+			event *ev = new event;
+			unsigned int nr_particles = 0;
+			ifs.read(reinterpret_cast<char*>(&nr_particles), sizeof(nr_particles));
+			for (unsigned int i = 0; ifs && i < nr_particles; ++i)
+			{
+				lhco *p = new lhco;
+				p->read_binary(ifs);
+				ev->push_back(p);
+			}
+
+			// tagged fat jets with their tagging information
+			cached_records.push_back(tagged_event());
+			cached_records.back().ev = ev;
+			std::vector< fastjet::PseudoJet > & taggedJets = cached_records.back().taggedJets;
+			unsigned int nr_jets = 0;
+			ifs.read(reinterpret_cast<char*>(&nr_jets), sizeof(nr_jets));
+			for (unsigned int j = 0; ifs && j < nr_jets; ++j)
+			{
+				double momentum[4];
+				char tags[3];
+				ifs.read(reinterpret_cast<char*>(momentum), sizeof(momentum));
+				ifs.read(tags, sizeof(tags));
+
+				fastjet::PseudoJet jet(momentum[0], momentum[1], momentum[2], momentum[3]);
+				jet.set_user_info(new TagInfo(tags[0], tags[1], tags[2]));
+				taggedJets.push_back(jet);
+			}
+		}
+
+		// Reject incomplete files
+		if ( !ifs )
+		{
+			std::cout << "Warning: shower and cluster cache " << file << " is incomplete." << std::endl;
+			for (unsigned int i = 0; i < cached_records.size(); ++i)
+				delete cached_records[i].ev;
+			return false;
+		}
+
+		for (unsigned int i = 0; i < cached_records.size(); ++i)
+		{
+			records.push_back(tagged_event());
+			records.back().ev = cached_records[i].ev;
+			records.back().taggedJets.swap(cached_records[i].taggedJets);
+			selection.push_back(records.size() - 1);
+		}
+		firstEvent = false;
+
+		std::cout << "\nLoaded " << nr_events << " showered and clustered events from cache " << file << std::endl;
+		if ( DoMerging )
+			std::cout << "\n\nFinal cross section: " << sigma << " +- " << sigmaErr << " pb.";
+		std::cout << "\n" << std::endl;
+		return true;
+	}
+
+	void jet_analysis::write_cache(const std::string & file, const double & sigma, const double & sigmaErr)
+	{
+		// Write to a temporary file first, such that aborted runs leave no incomplete cache
+		std::string tmp_file = file + ".tmp";
+		boost::system::error_code ec;
+		boost::filesystem::create_directories(boost::filesystem::path(file).parent_path(), ec);
+		std::ofstream ofs(tmp_file.c_str(), std::ios::binary);
+		if ( !ofs.is_open() )
+		{
+			std::cout << "Warning: could not write shower and cluster cache " << file << std::endl;
+			return;
+		}
+
+		// Cache version and settings
+		unsigned int key_size = cache_key.size();
+		ofs.write(reinterpret_cast<const char*>(&cache_version), sizeof(cache_version));
+		ofs.write(reinterpret_cast<const char*>(&key_size), sizeof(key_size));
+		ofs.write(cache_key.data(), key_size);
+
+		// Merged cross section
+		ofs.write(reinterpret_cast<const char*>(&sigma), sizeof(double));
+		ofs.write(reinterpret_cast<const char*>(&sigmaErr), sizeof(double));
+
+		// Events and tagged jets
+		unsigned int nr_events = selection.size();
+		ofs.write(reinterpret_cast<const char*>(&nr_events), sizeof(nr_events));
+		for (unsigned int iEv = 0; iEv < nr_events; ++iEv)
+		{
+			// lhco objects
+			const event *ev = records[selection[iEv]].ev;
+			unsigned int nr_particles = ev->size();
+			ofs.write(reinterpret_cast<const char*>(&nr_particles), sizeof(nr_particles));
+			for (unsigned int i = 0; i < nr_particles; ++i)
+				static_cast<const lhco*>((*ev)[i])->write_binary(ofs);
+
+			// tagged fat jets with their tagging information: the constituents are not stored, since
+			// the cluster sequence of an event is gone when the records are written after the loop
+			const std::vector< fastjet::PseudoJet > & taggedJets = records[selection[iEv]].taggedJets;
+			unsigned int nr_jets = taggedJets.size();
+			ofs.write(reinterpret_cast<const char*>(&nr_jets), sizeof(nr_jets));
+			for (unsigned int j = 0; j < nr_jets; ++j)
+			{
+				const fastjet::PseudoJet & jet = taggedJets[j];
+				double momentum[4] = { jet.px(), jet.py(), jet.pz(), jet.E() };
+				char tags[3] = { jet.user_info<TagInfo>().top_tag(), jet.user_info<TagInfo>().w_tag(), jet.user_info<TagInfo>().h_tag() };
+				ofs.write(reinterpret_cast<const char*>(momentum), sizeof(momentum));
+				ofs.write(tags, sizeof(tags));
+			}
+		}
+
+		ofs.close();
+		if ( !ofs )
+		{
+			std::cout << "Warning: could not write shower and cluster cache " << file << std::endl;
+			boost::filesystem::remove(tmp_file, ec);
+			return;
+		}
+		boost::filesystem::rename(tmp_file, file, ec);
+		std::cout << "Stored showered and clustered events in cache " << file << std::endl;
+	}
+
+
+/* NAMESPACE */
+}
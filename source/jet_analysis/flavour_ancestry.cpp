@@ -0,0 +1,103 @@
+/* Flavour ancestry class
+ *
+ * Marks the descendants of the outgoing b quarks of the hard process in a 
+ * single pass over a Pythia event record, one bit per b quark.
+*/
+
+#include "flavour_ancestry.h"
+
+
+/* NAMESPACE */
+namespace analysis
+{
+
+	/* con- & destructor */
+
+	flavour_ancestry::flavour_ancestry()
+	{
+		nr_b_quarks = 0;
+	}
+
+	flavour_ancestry::~flavour_ancestry()
+	{
+	}
+
+
+	/* ancestry construction */
+
+	void flavour_ancestry::fill(const Pythia8::Event & particles)
+	{
+		int size = particles.size();
+		particle_mask.assign(size, 0);
+		nr_b_quarks = 0;
+
+		// Daughters are stored after their mothers, such that one pass propagates the bits of the 
+		// mothers; further passes are only needed if a particle has a mother stored behind it
+		bool backward = true;
+		for (int pass = 0; backward && pass < size; ++pass)
+		{
+			backward = false;
+			bool changed = false;
+			for (int i = 0; i < size; ++i)
+			{
+				const Pythia8::Particle & p = particles[i];
+				unsigned int mask = particle_mask[i];
+
+				// outgoing b quarks of the hard process
+				if ( pass == 0 && p.idAbs() == 5 && p.status() == -23 && nr_b_quarks < 32 )
+					mask |= 1u << nr_b_quarks++;
+
+				// mothers as in Particle::motherList: none, a single mother or carbon copy, 
+				// a range of mothers from string fragmentation or two separate mothers
+				int status = std::abs(p.status());
+				int mother1 = p.mother1();
+				int mother2 = p.mother2();
+				int last_mother = -1;
+				if ( status == 11 || status == 12 || (mother1 == 0 && mother2 == 0) )
+					last_mother = -1;
+				else if ( mother2 == 0 || mother2 == mother1 )
+				{
+					mask |= particle_mask[mother1];
+					last_mother = mother1;
+				}
+				else if ( (status > 80 && status < 90) || (status > 100 && status < 107) )
+				{
+					for (int m = mother1; m <= mother2; ++m)
+						mask |= particle_mask[m];
+					last_mother = mother2;
+				}
+				else
+				{
+					mask |= particle_mask[mother1] | particle_mask[mother2];
+					last_mother = std::max(mother1, mother2);
+				}
+				if ( last_mother >= i )
+					backward = true;
+
+				if ( mask != particle_mask[i] )
+				{
+					particle_mask[i] = mask;
+					changed = true;
+				}
+			}
+			backward = backward && changed;
+		}
+	}
+
+
+	/* access */
+
+	int flavour_ancestry::nr_b() const
+	{
+		return nr_b_quarks;
+	}
+
+	unsigned int flavour_ancestry::b_mask(int i) const
+	{
+		if ( i < 0 || i >= static_cast<int>(particle_mask.size()) )
+			return 0;
+		return particle_mask[i];
+	}
+
+/* NAMESPACE */
+}
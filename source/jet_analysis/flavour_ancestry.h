@@ -0,0 +1,56 @@
+/* Flavour ancestry class
+ *
+ * Marks the descendants of the outgoing b quarks of the hard process in a 
+ * single pass over a Pythia event record, one bit per b quark.
+ *
+ * Compared to Pythia8::Event::isAncestor the marking is more inclusive: isAncestor
+ * only follows a unique mother and, for hadrons from string fragmentation (status 
+ * 81-86), a single parton of the string, and gives up at any other vertex with 
+ * several mothers. Here all mothers are followed, the whole mother range for status
+ * 81-89 and 101-106 (R-hadrons), such that every hadron of a string which contains
+ * a b quark descends from it. Every particle for which isAncestor finds a b quark
+ * therefore has its bit set as well, tests/test_jets.cpp checks this.
+*/
+
+#ifndef INC_FLAVOUR_ANCESTRY
+#define INC_FLAVOUR_ANCESTRY
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "Pythia8/Pythia.h"
+
+
+/* NAMESPACE */
+namespace analysis
+{
+
+	class flavour_ancestry
+	{
+
+	public:
+		/* con- & destructor */
+		flavour_ancestry();
+		~flavour_ancestry();
+
+		/* marks the descendants of the b quarks with status -23 */
+		void fill(const Pythia8::Event & particles);
+
+		/* number of b quarks, at most the 32 first ones are traced */
+		int nr_b() const;
+
+		/* bits of the b quarks particle i descends from, in order of the event record */
+		unsigned int b_mask(int i) const;
+
+	private:
+		/* ancestry bits of the particles of the event */
+		std::vector<unsigned int> particle_mask;
+		int nr_b_quarks;
+
+	};
+
+/* NAMESPACE */
+}
+
+#endif
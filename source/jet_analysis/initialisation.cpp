@@ -3,6 +3,15 @@
  * 
 */
 
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#include "boost/optional.hpp"
+
 #include "jet_analysis.h"
 
 
@@ -10,9 +19,12 @@
 namespace analysis 
 {
 
+	// version of the cross section estimate cache, increase when the estimation changes
+	const unsigned int xsec_estimate_version = 1;
+
 	/* initialisation function */
 
-	void jet_analysis::initialise(fastjet::PseudoJet (jet_analysis::*TopTagger)(const fastjet::PseudoJet &))
+	void jet_analysis::initialise(tagger_function TopTagger)
 	{
 		/* basic setup */
 		
@@ -23,126 +35,84 @@ namespace analysis
 			exit (EXIT_FAILURE);
 		}
 
-		// Pythia settings and merging variables
-		Pythia8::Pythia pythia;
-		pythia.settings.flag("Print:quiet", true);
-		if ( fast_showering )
+		// Check merging settings
+		if (DoMerging && !MergingSettings())
 		{
-			pythia.settings.flag("PartonLevel:MPI", false);
-			pythia.settings.flag("PartonLevel:Remnants", false);
-			pythia.settings.flag("Check:Event", false);
-			pythia.settings.flag("HadronLevel:all", false);
+			std::cout << "Error while initialising Pythia (Merging settings)" << std::endl;
+			exit (EXIT_FAILURE);
+		}
+
+		// Load showered and clustered events from the cache if available, not in the streaming mode 
+		// since only the records kept by the visitor are stored
+		std::string cacheFile;
+		if (useCache && visitor)
+			std::cout << "Warning: the shower and cluster cache is not used when streaming events to a visitor." << std::endl;
+		else if (useCache)
+		{
+			cacheFile = cache_file(TopTagger);
+			if (!cacheFile.empty() && read_cache(cacheFile))
+				return;
 		}
-		int njetmerged, njetcounterLO;
+
+		// Tagger instances shared by all showering workers
+		build_taggers();
+
+		// Pileup pool shared by all showering workers: read from the store if available, 
+		// otherwise generated once and stored
+		if ( DoPileup && pileup.nr_events() == 0 )
+		{
+			if ( pileup_file.empty() || !pileup.read(pileup_file) )
+			{
+				pileup.generate(pileup_pool_size, pileup_ecm, Seed, MaxEta);
+				if ( !pileup_file.empty() )
+					pileup.write(pileup_file);
+			}
+		}
+
+		// Merging variables
+		int njetcounterLO;
 
 		// Initialise lhco input files
 		std::vector< event* > events_lhco;
-		int lhcoEvent;
+		int lhcoEvent = 0;
 		if (importedLHCO)
 			read_lhco(events_lhco, lhco_input);
 
-		// Select FastJet algorithm and parameters
-		std::vector< fastjet::PseudoJet >  isolLeptons;
-		std::vector< fastjet::PseudoJet >  isolPhotons;
-		std::vector< fastjet::PseudoJet >  fjInputs;
-	
-		fastjet::RecombinationScheme      recombScheme = fastjet::E_scheme;
-		fastjet::Strategy                 strategy = fastjet::Best;
-
-		fastjet::JetDefinition            *fatJetDef;
-		fatJetDef = new fastjet::JetDefinition(algorithm_fat, Rsize_fat, recombScheme, strategy);
-
-		fastjet::JetDefinition            *skinnyJetDef;
-		skinnyJetDef = new fastjet::JetDefinition(algorithm_skinny, Rsize_skinny, recombScheme, strategy);
-
 
 		//============= Initialisation with possibly matching procedure =============//
-		// Merging setup
 		if (DoMerging)
-		{
-			// Check merging settings
-			if (!MergingSettings())
-			{
-				std::cout << "Error while initialising Pythia (Merging settings)" << std::endl;
-				exit (EXIT_FAILURE);
-			}
-			pythia.settings.flag("Merging:doKTMerging", true);
-			pythia.settings.word("Merging:Process", MergingProcess);
-			pythia.settings.mode("Merging:nJetMax", MergingNJetMax);
-			pythia.settings.parm("Merging:TMS", MergingScale);
 			njetcounterLO = MergingNJetMax;
-		}
 		else
 			njetcounterLO = 0; // only 0-jet sample
 
 
 		//============= Cross section estimation procedure =============//
-		// Save estimates in vectors
-		std::vector< double > xsecLO;
-		std::vector< double > nAcceptLO;
-		bool fsr, isr, mpi, had;
+		// The estimates (cross section, accepted events) are computed in a separate thread from the highest 
+		// jet multiplicity downwards, such that the analysis of a sample starts as soon as its estimate is known
+		std::vector< std::promise< std::pair< double, double > > > estimates(njetcounterLO + 1);
+		std::vector< std::future< std::pair< double, double > > > estimatesLO;
+		for (unsigned int njet = 0; njet < estimates.size(); ++njet)
+			estimatesLO.push_back(estimates[njet].get_future());
+		std::thread estimation;
 
 		if (DoMerging)
 		{
 			std::cout << "\n\n ================ Start cross section estimation ================" << std::endl << std::endl;
 
-			// Switch off all showering and MPI when extimating the cross section after the merging scale cut
-			fsr = pythia.flag("PartonLevel:FSR");
-  			isr = pythia.flag("PartonLevel:ISR");
-  			mpi = pythia.flag("PartonLevel:MPI");
-  			had = pythia.flag("HadronLevel:all");
-			pythia.settings.flag("PartonLevel:FSR", false);
-  			pythia.settings.flag("PartonLevel:ISR", false);
-  			pythia.settings.flag("PartonLevel:MPI", false);
-  			pythia.settings.flag("HadronLevel:all", false);
-
-  			pythia.settings.flag("Merging:doXSectionEstimate", true);
-  			pythia.settings.flag("Merging:mayRemoveDecayProducts", PythiaDecay);
-
-			while(njetcounterLO >= 0) 
+			estimation = std::thread([this, &estimates]()
 			{
-				// Set appropriate LHE file name
-				std::string input_file;
-				input_file = lhe_input;
-				if (njetcounterLO > 0)
-					input_file.insert(input_file.size() - 4, "_j" + boost::lexical_cast<std::string>(njetcounterLO)); // check me
-
-				// LHE initialisation
-				pythia.settings.mode("Merging:nRequested", njetcounterLO);
-				pythia.settings.word("Beams:LHEF", input_file);
-				if (!pythia.init(/*input_file*/))
+				for (int njet = MergingNJetMax; njet >= 0; --njet)
 				{
-					std::cout << "Error while initialising Pythia (pythia.init)" << std::endl;
-					exit (EXIT_FAILURE);
+					// Set appropriate LHE file name
+					std::string input_file = lhe_input;
+					if (njet > 0)
+						input_file.insert(input_file.size() - 4, "_j" + boost::lexical_cast<std::string>(njet)); // check me
+
+					double xsec, naccept;
+					estimate_xsec(input_file, njet, xsec, naccept);
+					estimates[njet].set_value(std::make_pair(xsec, naccept));
 				}
-
-				// Start event loop
-				for( int iEvent = 0; iEvent < nEvent; ++iEvent )
-				{
-					// Generate event
-					if ( !pythia.next() )
-					{
-						if( pythia.info.atEndOfFile() ) 
-							break;
-						else 
-							continue;
-					}
-				} // End of event loop
-
-				// Store cross section
-				xsecLO.push_back(pythia.info.sigmaGen());
-				nAcceptLO.push_back(pythia.info.nAccepted());
-
-				// Restart with ME of a reduced the number of jets
-				if( njetcounterLO > 0 )
-					njetcounterLO--;
-				else
-					break;
-
-			} // End while( njetcounterLO>=0 )
-
-			// Reset values
-			njetcounterLO = MergingNJetMax;
+			});
 		}
 
 
@@ -152,7 +122,15 @@ namespace analysis
   		// Cross section and error variables
 		double sigmaTotal  = 0.;
 		double errorTotal  = 0.;
-		int sizeLO = static_cast<int>(xsecLO.size()), iNow;
+
+		// Time spent per stage of the event loop
+		double timeShower = 0., timeParticles = 0., timeClustering = 0., timeTagging = 0.;
+
+		// Details of the first event are printed when merging the worker outputs
+		bool printFirstEvent = firstEvent;
+
+		// Split the LHE events in consecutive ranges, one for each worker
+		int nRange = (nEvent + nWorkers - 1) / nWorkers;
 
   		// Loop over different LHE files with additional external jets
 		while(njetcounterLO >= 0)
@@ -163,384 +141,576 @@ namespace analysis
 			if (njetcounterLO > 0)
 				input_file.insert(input_file.size() - 4, "_j" + boost::lexical_cast<std::string>(njetcounterLO)); // check me
 
-			// Additional merging settings: LHE input and total jet to be merged
+			// Normalisation of the merging weights of this sample
+			double norm = 0.;
 			if ( DoMerging )
 			{
-				// Possibly switch showering and multiple interaction back on
-				pythia.settings.flag("Merging:doXSectionEstimate", false);
-				pythia.settings.flag("Merging:mayRemoveDecayProducts", PythiaDecay);
-				pythia.settings.flag("PartonLevel:FSR", fsr);
-  				pythia.settings.flag("PartonLevel:ISR", isr);
-  				pythia.settings.flag("PartonLevel:MPI", mpi);
-  				pythia.settings.flag("HadronLevel:all", had);
-
-				pythia.settings.mode("Merging:nRequested", njetcounterLO);
-    			pythia.settings.word("Beams:LHEF", input_file);
-    			iNow = sizeLO-1-njetcounterLO;
+    			std::pair< double, double > estimate = estimatesLO[njetcounterLO].get();
+    			norm = estimate.first / estimate.second;
     			std::cout << "\n\nStart analysis of " << njetcounterLO << " jets sample" << std::endl;
 			}
 
-			// LHE initialisation
-			if ( !pythia.init(/*input_file*/) )
+			// Showering jobs: one pythia instance with its own seed per worker
+			std::vector< shower_job > jobs;
+			for (int iWorker = 0; iWorker < nWorkers && iWorker * nRange < nEvent; ++iWorker)
+			{
+				shower_job job;
+				job.input_file = input_file;
+				job.njet = njetcounterLO;
+				job.seed = Seed + iWorker;
+				job.first = iWorker * nRange;
+				job.last = std::min(nEvent, job.first + nRange);
+				job.norm = norm;
+				job.sigma = 0.;
+				job.error = 0.;
+				job.time_shower = 0.;
+				job.time_particles = 0.;
+				job.time_clustering = 0.;
+				job.time_tagging = 0.;
+				jobs.push_back(job);
+			}
+
+			// Run the jobs: the first worker processes its first event alone, such that 
+			// the clustering and tagging details are printed only once
+			if ( jobs.size() == 1 )
+				shower_events(jobs[0], TopTagger);
+			else if ( jobs.size() > 1 )
 			{
-				std::cout << "Error while initialising Pythia (pythia.init)" << std::endl;
-				exit (EXIT_FAILURE);
+				std::promise< void > first_done;
+				std::future< void > first_ready = first_done.get_future();
+
+				std::vector< std::thread > workers;
+				workers.push_back(std::thread(&jet_analysis::shower_events, this, std::ref(jobs[0]), TopTagger, &first_done));
+				first_ready.wait();
+				for (unsigned int iWorker = 1; iWorker < jobs.size(); ++iWorker)
+					workers.push_back(std::thread(&jet_analysis::shower_events, this, std::ref(jobs[iWorker]), TopTagger, nullptr));
+				for (unsigned int iWorker = 0; iWorker < workers.size(); ++iWorker)
+					workers[iWorker].join();
 			}
 
 
-			// event loop 
-			for (int iEvent = 0; iEvent < nEvent; ++iEvent)
+			//============= Merge the worker outputs in order of the LHE events =============//
+			for (unsigned int iWorker = 0; iWorker < jobs.size(); ++iWorker)
 			{
-				// Generate event
-				if ( !pythia.next() )
+				// Cross section estimate in merging procedure
+				sigmaTotal += jobs[iWorker].sigma;
+				errorTotal += jobs[iWorker].error;
+
+				// Time spent per stage, summed over the workers
+				timeShower += jobs[iWorker].time_shower;
+				timeParticles += jobs[iWorker].time_particles;
+				timeClustering += jobs[iWorker].time_clustering;
+				timeTagging += jobs[iWorker].time_tagging;
+
+				// Objects removed per overlap removal rule, summed over the workers
+				overlap.add_removed(jobs[iWorker].removed_overlap);
+
+				for (unsigned int iEv = 0; iEv < jobs[iWorker].records.size(); ++iEv)
 				{
-					if( pythia.info.atEndOfFile() ) 
-						break;
-					else 
+					// lhco event index: in the non-merging case, lhcoEvent coincides with the LHE event number
+					tagged_event & record = jobs[iWorker].records[iEv];
+					event *ev = record.ev;
+					if ( importedLHCO )
+					{
+						if ( lhcoEvent >= static_cast<int>(events_lhco.size()) )
+						{
+							std::cout << "Error: fewer events in input LHCO file than showered LHE events." << std::endl;
+							exit (EXIT_FAILURE);
+						}
+						ev = events_lhco[lhcoEvent];
+						record.ev = ev;
+					}
+					lhcoEvent++;
+
+					// Streaming mode with imported lhco events: the records are visited once the lhco event is known
+					if ( visitor && importedLHCO && !visit_record(record) )
 						continue;
+
+					// Print details of first event
+					if ( printFirstEvent )
+					{
+						std::cout << std::endl << "First event details:" << std::endl;
+						ev->write(std::cout);
+						std::cout << std::endl;
+						printFirstEvent = false;
+					}
+
+					// Fill the (lhco, taggedJets) records, moving the tagged jets of the worker
+					records.push_back(tagged_event());
+					records.back().ev = ev;
+					records.back().taggedJets.swap(record.taggedJets);
+					selection.push_back(records.size() - 1);
 				}
-				
-				// Print evolution
-				if ( (iEvent + 1) % 100 == 0 )
-					std::cout << "Event number: " << iEvent + 1 << "\r" << std::flush;
-
-				// Get event weight(s) of merging procedure
-				double weight = 1.0, evtweight;
-				if ( DoMerging )
-				{
-					weight = pythia.info.mergingWeight();
-					evtweight = pythia.info.weight();
-					weight *= evtweight;
-				}
+			}
+
+
+			//============= Restart with ME of a reduced the number of jets =============//
+			if( njetcounterLO > 0 )
+				njetcounterLO--;
+			else
+				break;
+
+		} // End while( njetcounterLO>=0 )
+
+		if ( estimation.joinable() )
+			estimation.join();
+
+		double sigmaErr = 0.;
+		if ( DoMerging )
+		{		
+			sigmaTotal *= 1e9;
+			sigmaErr = sqrt(errorTotal)*1e9;
+			std::cout << "\n\nFinal cross section: " << sigmaTotal << " +- " << sigmaErr << " pb.";
+		}
+
+		std::cout << "\n\nTime per stage (summed over workers): showering " << timeShower << " s, particle selection " 
+			<< timeParticles << " s, clustering " << timeClustering << " s, tagging " << timeTagging << " s.";
+		std::cout << "\n" << std::endl;	
+		if ( !importedLHCO && overlap.nr_rules() > 0 )
+			overlap.write(std::cout);
 
-				// Do not consider zero-weight events in merging procedure
-				if ( weight == 0. ) 
+		// Store showered and clustered events in the cache
+		if ( !cacheFile.empty() )
+			write_cache(cacheFile, sigmaTotal, sigmaErr);
+
+	}
+
+	void jet_analysis::estimate_xsec(const std::string & input_file, const int & njet, double & xsec, double & naccept)
+	{
+		// Estimates are cached per LHE input and merging settings
+		boost::filesystem::path estimateFile;
+		std::string key;
+		if ( useCache )
+		{
+			std::ostringstream settings;
+			settings << std::setprecision(17);
+			settings << "xsec estimate " << xsec_estimate_version << "\n";
+			settings << "input " << hash_file(input_file) << " " << njet << "\n";
+			settings << "events " << nEvent << " " << Seed << " " << fast_showering << "\n";
+			settings << "merging " << MergingProcess << " " << MergingNJetMax << " " << MergingScale << " " << PythiaDecay << "\n";
+			key = settings.str();
+
+			std::ostringstream name;
+			name << "xsec_" << std::hex << std::setw(16) << std::setfill('0') << hash_string(key) << ".estimate";
+			estimateFile = boost::filesystem::path(cache_dir) / name.str();
+			if ( read_xsec_estimate(estimateFile, key, xsec, naccept) )
+			{
+				std::cout << "Loaded cross section estimate of " << njet << " jets sample from cache " << estimateFile.string() << std::endl;
+				return;
+			}
+		}
+
+		// Pythia instance of the estimation
+		Pythia8::Pythia pythia;
+		configure_pythia(pythia);
+
+		// Switch off all showering and MPI when extimating the cross section after the merging scale cut
+		pythia.settings.flag("PartonLevel:FSR", false);
+		pythia.settings.flag("PartonLevel:ISR", false);
+		pythia.settings.flag("PartonLevel:MPI", false);
+		pythia.settings.flag("HadronLevel:all", false);
+
+		pythia.settings.flag("Merging:doXSectionEstimate", true);
+		pythia.settings.flag("Merging:mayRemoveDecayProducts", PythiaDecay);
+
+		// LHE initialisation
+		pythia.settings.mode("Merging:nRequested", njet);
+		pythia.settings.word("Beams:LHEF", input_file);
+		if (!pythia.init(/*input_file*/))
+		{
+			std::cout << "Error while initialising Pythia (pythia.init)" << std::endl;
+			exit (EXIT_FAILURE);
+		}
+
+		// Start event loop
+		for( int iEvent = 0; iEvent < nEvent; ++iEvent )
+		{
+			// Generate event
+			if ( !pythia.next() )
+			{
+				if( pythia.info.atEndOfFile() ) 
+					break;
+				else 
 					continue;
+			}
+		} // End of event loop
 
-				// Cross section estimate in merging procedure
-				double norm;
-				if ( DoMerging )
-				{
-					norm = xsecLO[iNow] / nAcceptLO[iNow];
-					sigmaTotal += weight*norm;
-					errorTotal += Pythia8::pow2(weight*norm);
-				}
+		// Store cross section
+		xsec = pythia.info.sigmaGen();
+		naccept = pythia.info.nAccepted();
+		if ( useCache )
+			write_xsec_estimate(estimateFile, key, xsec, naccept);
+	}
+
+	void jet_analysis::configure_pythia(Pythia8::Pythia & pythia)
+	{
+		// Basic and fast showering settings
+		pythia.settings.flag("Print:quiet", true);
+		pythia.settings.flag("Random:setSeed", true);
+		pythia.settings.mode("Random:seed", Seed);
+		if ( fast_showering )
+		{
+			pythia.settings.flag("PartonLevel:MPI", false);
+			pythia.settings.flag("PartonLevel:Remnants", false);
+			pythia.settings.flag("Check:Event", false);
+			pythia.settings.flag("HadronLevel:all", false);
+		}
 
-				// lhco event index: in the non-merging case, lhcoEvent coincides with iEvent
-				lhcoEvent++;
+		// Merging setup
+		if ( DoMerging )
+		{
+			pythia.settings.flag("Merging:doKTMerging", true);
+			pythia.settings.word("Merging:Process", MergingProcess);
+			pythia.settings.mode("Merging:nJetMax", MergingNJetMax);
+			pythia.settings.parm("Merging:TMS", MergingScale);
+		}
+	}
 
-				// Reset FastJet inputs
-				isolLeptons.clear();
-				isolPhotons.clear();
-				fjInputs.clear();
+	void jet_analysis::shower_events(shower_job & job, tagger_function TopTagger, std::promise< void > *first_done)
+	{
+		// Pythia instance of this worker
+		Pythia8::Pythia pythia;
+		configure_pythia(pythia);
+		pythia.settings.mode("Random:seed", job.seed);
 
-				// Define Etmiss vector
-				double pxmiss = 0.0;
-				double pymiss = 0.0;
+		// Additional merging settings: LHE input and total jet to be merged
+		if ( DoMerging )
+		{
+			pythia.settings.flag("Merging:mayRemoveDecayProducts", PythiaDecay);
+			pythia.settings.mode("Merging:nRequested", job.njet);
+		}
+		pythia.settings.word("Beams:LHEF", job.input_file);
 
-				// Index vector to take trace of outgoing b-quarks of the hardest process
-				std::vector< int > index;
+		// LHE initialisation
+		if ( !pythia.init(/*input_file*/) )
+		{
+			std::cout << "Error while initialising Pythia (pythia.init)" << std::endl;
+			exit (EXIT_FAILURE);
+		}
 
+		// Skip the LHE events of the preceding workers, the first worker never skips
+		if ( job.first > 0 && !pythia.LHAeventSkip(job.first) )
+			return;
 
-				//============= Collect Isolated particles and FastJet input within each event=============//
-				for (int i = 0; i < pythia.event.size(); ++i) 
-				{ 
-					// Identify the index of the outgoing b-quarks of the hardest process
-					long pdg = pythia.event[i].idAbs();
-					int status = pythia.event[i].status();
-					if ( pdg == 5 && status == -23 )
-						index.push_back(i);
+		// Select FastJet algorithm and parameters, the particle and jet vectors are reused for all events
+		std::vector< fastjet::PseudoJet >  isolLeptons;
+		std::vector< fastjet::PseudoJet >  isolPhotons;
+		std::vector< fastjet::PseudoJet >  fjInputs;
+		std::vector< fastjet::PseudoJet >  fatJets;
+		std::vector< fastjet::PseudoJet >  skinnyJets;
 
-					// Final state only
-					if ( !pythia.event[i].isFinal() ) 
-						continue;
+		// Descendants of the outgoing b-quarks of the hardest process for the b-flavour of the skinnyJets
+		flavour_ancestry bAncestry;
+	
+		fastjet::RecombinationScheme      recombScheme = fastjet::E_scheme;
+		fastjet::Strategy                 strategy = fastjet::Best;
 
-					// Don't include particles that go down the beampipe
-					if ( pythia.event[i].eta() > MaxEta )
-						continue;
+		fastjet::JetDefinition            fatJetDef(algorithm_fat, Rsize_fat, recombScheme, strategy);
+		fastjet::JetDefinition            skinnyJetDef(algorithm_skinny, Rsize_skinny, recombScheme, strategy);
 
-					// Don't include invisible particles (neutrinos, neutralinos, heavy photon)
-					long id = pythia.event[i].idAbs();
-					if ( id == 12 || id == 14 || id == 16 || id == 1000022 || id == 8880022 ) 
-						continue;
+		// The skinny jets are only needed for the lhco output. For Cambridge/Aachen the clustering 
+		// history is ordered in Delta R, such that the inclusive skinny jets are the exclusive jets 
+		// of the fat clustering with dcut = (R_skinny/R_fat)^2 and one pass serves both definitions.
+		bool clusterSkinny = !importedLHCO;
+		bool shareClustering = clusterSkinny && algorithm_fat == fastjet::cambridge_algorithm 
+			&& algorithm_skinny == fastjet::cambridge_algorithm && Rsize_skinny <= Rsize_fat;
+		double skinnyDcut = (Rsize_skinny * Rsize_skinny) / (Rsize_fat * Rsize_fat);
 
-					// Take trace of Etmiss vector components from visible particles
-					pxmiss += pythia.event[i].px();
-					pymiss += pythia.event[i].py();
+		// Time spent in the stages of the event loop
+		typedef std::chrono::steady_clock stage_clock;
+		stage_clock::time_point stage_start;
 
-					// Collect isolated leptons
-					if ( isolatedElectron(i, pythia.event) || isolatedMuon(i, pythia.event) ) 
-					{
-						isolLeptons.push_back(pythia.event[i]);
-						continue;
-					}
+		// Random numbers of the pileup overlay of this worker
+		std::mt19937 pileupRng(job.seed);
 
-					// Collect isolated photons
-					if ( isolatedPhoton(i, pythia.event) ) 
-					{
-						isolPhotons.push_back(pythia.event[i]);
-						continue;
-					}
+		// Eta-phi grid of the visible particles for the isolation cones
+		isolation_grid isolGrid(MaxEta, std::max(deltaR_IsoEl, std::max(deltaR_IsoMuon, deltaR_IsoGamma)));
 
-					// Collect FastJet input
-					fjInputs.push_back(pythia.event[i]);
 
-				} // End of particle loop
+		// event loop 
+		for (int iEvent = job.first; iEvent < job.last; ++iEvent)
+		{
+			// Generate event
+			stage_start = stage_clock::now();
+			bool generated = pythia.next();
+			job.time_shower += std::chrono::duration< double >(stage_clock::now() - stage_start).count();
+			if ( !generated )
+			{
+				if( pythia.info.atEndOfFile() ) 
+					break;
+				else 
+					continue;
+			}
+			
+			// Print evolution of the first worker
+			if ( job.first == 0 && (iEvent + 1) % 100 == 0 )
+				std::cout << "Event number: " << iEvent + 1 << "\r" << std::flush;
 
-				// Print Warning
-				if ( fjInputs.size() == 0 ) 
-				{
-					std::cout << "Warning: event no. " << iEvent+1 << " with no FastJet Input." << std::endl;
-					// continue; // TODO: include or not events with no hadronic activity?
-				}
+			// Get event weight(s) of merging procedure
+			double weight = 1.0, evtweight;
+			if ( DoMerging )
+			{
+				weight = pythia.info.mergingWeight();
+				evtweight = pythia.info.weight();
+				weight *= evtweight;
+			}
+
+			// Do not consider zero-weight events in merging procedure
+			if ( weight == 0. ) 
+				continue;
+
+			// Cross section estimate in merging procedure
+			if ( DoMerging )
+			{
+				job.sigma += weight*job.norm;
+				job.error += Pythia8::pow2(weight*job.norm);
+			}
 
-				// Sort isolLeptons, isolPhotons by pT
-				isolLeptons = sorted_by_pt( isolLeptons );
-				isolPhotons = sorted_by_pt( isolPhotons );
+			// Reset FastJet inputs
+			isolLeptons.clear();
+			isolPhotons.clear();
+			fjInputs.clear();
 
+			// Define Etmiss vector
+			double pxmiss = 0.0;
+			double pymiss = 0.0;
 
-				//============= Run FastJet algorithm on fatJets and (if required) on skinnyJets =============//
-				fastjet::ClusterSequence *CSfatJets; 
-				CSfatJets = new fastjet::ClusterSequence(fjInputs, *fatJetDef);
 
-				fastjet::ClusterSequence *CSskinnyJets;
-				CSskinnyJets = new fastjet::ClusterSequence(fjInputs, *skinnyJetDef);
+			//============= Collect Isolated particles and FastJet input within each event=============//
+			stage_start = stage_clock::now();
+			isolGrid.fill(pythia.event);
+			for (int i = 0; i < pythia.event.size(); ++i) 
+			{ 
+				// Final state only
+				if ( !pythia.event[i].isFinal() ) 
+					continue;
 
-				// Print FastJet details
-				if ( firstEvent )
+				// Don't include particles that go down the beampipe
+				if ( pythia.event[i].eta() > MaxEta )
+					continue;
+
+				// Don't include invisible particles (neutrinos, neutralinos, heavy photon)
+				long id = pythia.event[i].idAbs();
+				if ( id == 12 || id == 14 || id == 16 || id == 1000022 || id == 8880022 ) 
+					continue;
+
+				// Take trace of Etmiss vector components from visible particles
+				pxmiss += pythia.event[i].px();
+				pymiss += pythia.event[i].py();
+
+				// Collect isolated leptons
+				if ( isolatedElectron(i, pythia.event, isolGrid) || isolatedMuon(i, pythia.event, isolGrid) ) 
 				{
-					if ( !importedLHCO )
-					{
-						std::cout << "\nSkinny Jets clustering:\n" 
-							 << skinnyJetDef->description() << ". ";
-						std::cout << "Strategy adopted by FastJet was "
-						     << CSskinnyJets->strategy_string() << "." << std::endl;
-					}
+					isolLeptons.push_back(pythia.event[i]);
+					continue;
+				}
 
-					std::cout << "\nFat Jets clustering:\n" 
-						 << fatJetDef->description() << ". ";
-					std::cout << "Strategy adopted by FastJet was " 
-						 << CSfatJets->strategy_string() << "." << std::endl;
+				// Collect isolated photons
+				if ( isolatedPhoton(i, pythia.event, isolGrid) ) 
+				{
+					isolPhotons.push_back(pythia.event[i]);
+					continue;
 				}
 
-				// Extract inclusive jets sorted by pT (note minimum pT veto)
-				std::vector< fastjet::PseudoJet >  fatJets;
-				fatJets = fastjet::sorted_by_pt( CSfatJets->inclusive_jets(jetMinPt) );
-
-				std::vector< fastjet::PseudoJet >  skinnyJets;
-				if ( !importedLHCO )
-					skinnyJets = fastjet::sorted_by_pt( CSskinnyJets->inclusive_jets(jetMinPt) );
-
-				// ===== TODO: implement b-flavour information ===== //
-				// // Determine b-tag information of skinnyJets
-				// for (unsigned int i = 0; i < skinnyJets.size(); ++i)
-				// {
-				// 	std::vector< fastjet::PseudoJet > pieces = skinnyJets[i].constituents();
-				// 	for (unsigned int j = 0; j < pieces.size(); ++j)
-				// 	{
-				// 		bool isB = false;
-				// 		for (unsigned int k = 0; k < index.size(); ++k)
-				// 		{
-				// 	        int iAncestor = index[k];
-				// 	        int iPos = pieces[j].user_info<Pythia8::Particle>().mother1();
-
-				// 	        bool isMatched = pythia.event.isAncestor(iPos,iAncestor);
-
-				// 	        // if a b-quark ancestor is found: set b-tag information, remove b-index and jump at the next skinnyJet (isB = true)
-				// 	        if(isMatched)
-				// 	        {
-				// 	        	skinnyJets[i].set_user_info(new FlavourInfo(true));
-				// 	        	isB = true;
-				// 				index.erase(index.begin()+k);
-				// 				break;
-				// 	        }
-				// 		} // end index loop
-
-				// 		if (isB)
-				// 			break;
-
-				// 		// if no b-quark is found among the ancestors of the skinnyJet constituents, then set no-b information	
-				// 		if (j == (pieces.size()-1))
-				// 			skinnyJets[i].set_user_info(new FlavourInfo(false));
-
-				// 	} // end pieces loop
-
-				// } // end skinnyJets loop
-
-				// // Check b-quark history of final state particles
-				// for (unsigned int i = 0; i < fjInputs.size(); ++i)
-				// {
-				// 	for (unsigned int k = 0; k < index.size(); ++k)
-				// 	{
-				//         int iAncestor = index[k];
-				//         int iPos = fjInputs[i].user_info<Pythia8::Particle>().mother1();
-
-				//         bool isMatched = pythia.event.isAncestor(iPos,iAncestor);
-
-				//         if(isMatched)
-				//         {
-				//         	if(firstEvent)
-				//         		std::cout << "found ancestor, with id: " << iAncestor << std::endl;
-				//         }
-				// 	} // end index loop
-
-				// } // end fjInputs loop
-
-
-				//============= If requested, store clustered events in lhco format, otherwise read from input lhco =============//
-				event *ev = new event;
-
-				if ( !importedLHCO )
+				// Collect FastJet input, the user index refers to the event record
+				fjInputs.push_back(pythia.event[i]);
+				fjInputs.back().set_user_index(i);
+
+			} // End of particle loop
+
+			// Overlay pileup on the FastJet input
+			if ( DoPileup )
+				pileup.overlay(fjInputs, pileup_mu, pileupRng);
+
+			// Print Warning
+			if ( fjInputs.size() == 0 ) 
+			{
+				std::cout << "Warning: event no. " << iEvent+1 << " with no FastJet Input." << std::endl;
+				// continue; // TODO: include or not events with no hadronic activity?
+			}
+
+			// Sort isolLeptons, isolPhotons by pT
+			isolLeptons = sorted_by_pt( isolLeptons );
+			isolPhotons = sorted_by_pt( isolPhotons );
+			job.time_particles += std::chrono::duration< double >(stage_clock::now() - stage_start).count();
+
+
+			//============= Run FastJet algorithm on fatJets and (if required) on skinnyJets =============//
+			stage_start = stage_clock::now();
+			fastjet::ClusterSequence CSfatJets(fjInputs, fatJetDef);
+
+			// the skinny sequence is only built if needed, in place without a heap allocation
+			boost::optional< fastjet::ClusterSequence > CSskinnyJets;
+			if ( clusterSkinny && !shareClustering )
+				CSskinnyJets.emplace(fjInputs, skinnyJetDef);
+
+			// Print FastJet details
+			if ( firstEvent )
+			{
+				if ( CSskinnyJets )
 				{
-					// Translate isolLeptons into lhco format and push back into the list of event pointers
-					for (unsigned int i = 0; i < isolLeptons.size(); ++i)
-					{
-						int p_type;
-						int 	p_id 	= isolLeptons[i].user_info<Pythia8::Particle>().idAbs();
-						double	p_eta 	= isolLeptons[i].eta(), 
-								p_phi 	= isolLeptons[i].phi(), 
-								p_pt 	= isolLeptons[i].pt(),
-								p_ch	= isolLeptons[i].user_info<Pythia8::Particle>().charge();
-
-						if (p_id == 11)
-							p_type = ptype_electron;
-						else
-							p_type = ptype_muon;
-
-						lhco *p = new lhco(p_type, p_eta, p_phi, p_pt, 0.0, p_ch);
-						ev->push_back(p);
-					}
+					std::cout << "\nSkinny Jets clustering:\n" 
+						 << skinnyJetDef.description() << ". ";
+					std::cout << "Strategy adopted by FastJet was "
+					     << CSskinnyJets->strategy_string() << "." << std::endl;
+				}
+				else if ( shareClustering )
+				{
+					std::cout << "\nSkinny Jets clustering:\n" 
+						 << skinnyJetDef.description() << ". ";
+					std::cout << "Obtained from the fat jets clustering with dcut = " 
+						 << skinnyDcut << "." << std::endl;
+				}
 
-					// Translate isolPhotons into lhco format and push back into the list of event pointers
-					for (unsigned int i = 0; i < isolPhotons.size(); ++i)
-					{
-						int p_type = ptype_photon;
-						double	p_eta 	= isolPhotons[i].eta(), 
-								p_phi 	= isolPhotons[i].phi(), 
-								p_pt 	= isolPhotons[i].pt();
+				std::cout << "\nFat Jets clustering:\n" 
+					 << fatJetDef.description() << ". ";
+				std::cout << "Strategy adopted by FastJet was " 
+					 << CSfatJets.strategy_string() << "." << std::endl;
+			}
 
-						lhco *p = new lhco(p_type, p_eta, p_phi, p_pt);
-						ev->push_back(p);
-					}
+			// Extract inclusive jets sorted by pT (note minimum pT veto)
+			fatJets = fastjet::sorted_by_pt( CSfatJets.inclusive_jets(jetMinPt) );
 
-					// Temporary null-assignment of b-tag information
-					for (unsigned int i = 0; i < skinnyJets.size(); ++i)
-						skinnyJets[i].set_user_info(new FlavourInfo(false));
+			skinnyJets.clear();
+			if ( CSskinnyJets )
+				skinnyJets = fastjet::sorted_by_pt( CSskinnyJets->inclusive_jets(jetMinPt) );
+			else if ( shareClustering )
+			{
+				std::vector< fastjet::PseudoJet > exclusiveJets = CSfatJets.exclusive_jets(skinnyDcut);
+				for (unsigned int i = 0; i < exclusiveJets.size(); ++i)
+					if ( exclusiveJets[i].pt() >= jetMinPt )
+						skinnyJets.push_back(exclusiveJets[i]);
+				skinnyJets = fastjet::sorted_by_pt( skinnyJets );
+			}
+			job.time_clustering += std::chrono::duration< double >(stage_clock::now() - stage_start).count();
 
-					// Translate skinnyJets into lhco format and push back into the list of event pointers
-					for (unsigned int i = 0; i < skinnyJets.size(); ++i)
+			//============= Determine b-flavour information of skinnyJets =============//
+			// a skinnyJet is b-flavoured if one of its constituents descends from an outgoing b-quark of the hardest 
+			// process, each b-quark labels only the first such skinnyJet in pT order
+			if ( !skinnyJets.empty() )
+			{
+				bAncestry.fill(pythia.event);
+				unsigned int bAvailable = bAncestry.nr_b() < 32 ? (1u << bAncestry.nr_b()) - 1 : ~0u;
+				for (unsigned int i = 0; i < skinnyJets.size(); ++i)
+				{
+					bool isB = false;
+					std::vector< fastjet::PseudoJet > pieces = skinnyJets[i].constituents();
+					for (unsigned int j = 0; bAvailable && j < pieces.size(); ++j)
 					{
-						// no Jet-Electron overlapping within R=0.2 cone from the electron
-						if ( !JetElectronOverlapping(skinnyJets[i],isolLeptons) )
+						unsigned int bMatched = bAncestry.b_mask(pieces[j].user_index()) & bAvailable;
+						if ( bMatched )
 						{
-							int p_type = ptype_jet;
-							double	p_eta 	= skinnyJets[i].eta(), 
-									p_phi 	= skinnyJets[i].phi(), 
-									p_pt 	= skinnyJets[i].pt(), 
-									p_m 	= skinnyJets[i].m(),
-									p_bjet	= skinnyJets[i].user_info<FlavourInfo>().b_type();
-
-							lhco *p = new lhco(p_type, p_eta, p_phi, p_pt, p_m, 0.0, p_bjet);
-							ev->push_back(p);
+							// remove the first matched b-quark and jump at the next skinnyJet
+							bAvailable &= ~(bMatched & (~bMatched + 1));
+							isB = true;
+							break;
 						}
 					}
+					skinnyJets[i].set_user_info(new FlavourInfo(isB));
+				}
+			}
 
-					// Translate Etmiss into lhco format and push back into the list of event pointers
-					int p_type = ptype_met;
-					double Etmiss = sqrt( pxmiss*pxmiss + pymiss*pymiss );
-					double Etmiss_phi = atan2(pymiss,pxmiss);
-					lhco *p = new lhco(p_type, 0.0, Etmiss_phi, Etmiss);
-					ev->push_back(p);
 
-	  			}
-	  			else
-	  				ev = events_lhco[lhcoEvent-1];
+			//============= If requested, store clustered events in lhco format, otherwise read from input lhco =============//
+			// the input lhco events are assigned when merging the worker outputs
+			event *ev = nullptr;
 
-	  			// Print details of first event
-				if ( firstEvent )
-				{
-					std::cout << std::endl << "First event details:" << std::endl;
-	  				ev->write(std::cout);
-	  				std::cout << std::endl;
-	  			}
-
-
-				//============= Tagging analysis =============//
-				std::vector< fastjet::PseudoJet >  taggedJets;
-	  			for (unsigned int i = 0; i < fatJets.size(); ++i)
-	  			{
-	  				// Top tagging
-	  				if ( DoTopTagger )
-	  				{
-		  				fastjet::PseudoJet TopTagged;
-		  				TopTagged=(this->*TopTagger)(fatJets[i]);
-		  				if ( printTopTagDetails )
-		  					printTopTagDetails = false;
-		  				if ( TopTagged!=0 )
-		  				{
-		  					taggedJets.push_back(TopTagged);
-		  					continue;
-		  				}
-	  				}
-	  				
-	  				// BDRS tagging: only on non-top tagged fat jets
-	  				if ( DoBDRS )
-	  				{
-						fastjet::PseudoJet BDRSTagged;
-						BDRSTagged = BDRSTagging(fatJets[i]);
-						if ( printBDRSDetails )
-							printBDRSDetails = false;
-						if ( BDRSTagged!=0 )
-						{
-							taggedJets.push_back(BDRSTagged);
-							continue;
-						}
-					}
+			if ( !importedLHCO )
+			{
+				ev = new event;
 
-					// push_back remaining non-tagged fatjets
-					fastjet::PseudoJet fatjet = fatJets[i];
-					fatjet.set_user_info(new TagInfo());
-					taggedJets.push_back(fatjet);
+				// Translate isolLeptons into lhco format and push back into the list of event pointers
+				for (unsigned int i = 0; i < isolLeptons.size(); ++i)
+				{
+					int p_type;
+					int 	p_id 	= isolLeptons[i].user_info<Pythia8::Particle>().idAbs();
+					double	p_eta 	= isolLeptons[i].eta(), 
+							p_phi 	= isolLeptons[i].phi(), 
+							p_pt 	= isolLeptons[i].pt(),
+							p_ch	= isolLeptons[i].user_info<Pythia8::Particle>().charge();
+
+					if (p_id == 11)
+						p_type = ptype_electron;
+					else
+						p_type = ptype_muon;
+
+					lhco *p = new lhco(p_type, p_eta, p_phi, p_pt, 0.0, p_ch);
+					ev->push_back(p);
+				}
 
-	  			}
+				// Translate isolPhotons into lhco format and push back into the list of event pointers
+				for (unsigned int i = 0; i < isolPhotons.size(); ++i)
+				{
+					int p_type = ptype_photon;
+					double	p_eta 	= isolPhotons[i].eta(), 
+							p_phi 	= isolPhotons[i].phi(), 
+							p_pt 	= isolPhotons[i].pt();
 
+					lhco *p = new lhco(p_type, p_eta, p_phi, p_pt);
+					ev->push_back(p);
+				}
 
-	  			//============= Fill the (lhco, taggedJets) map =============//
-				map_lhco_taggedJets.insert(std::make_pair(ev,taggedJets));
+				// Translate skinnyJets into lhco format and push back into the list of event pointers
+				for (unsigned int i = 0; i < skinnyJets.size(); ++i)
+				{
+					int p_type = ptype_jet;
+					double	p_eta 	= skinnyJets[i].eta(), 
+							p_phi 	= skinnyJets[i].phi(), 
+							p_pt 	= skinnyJets[i].pt(), 
+							p_m 	= skinnyJets[i].m(),
+							p_bjet	= skinnyJets[i].user_info<FlavourInfo>().b_type();
+
+					lhco *p = new lhco(p_type, p_eta, p_phi, p_pt, p_m, 0.0, p_bjet);
+					ev->push_back(p);
+				}
 
-				// Exit First event loop
-				if ( firstEvent )
-			   		firstEvent = false;
+				// Overlap removal, by default no jets within R=0.2 cone from an electron
+				overlap.apply(ev, job.removed_overlap);
 
-				delete CSfatJets;
-				delete CSskinnyJets;
+				// Translate Etmiss into lhco format and push back into the list of event pointers
+				int p_type = ptype_met;
+				double Etmiss = sqrt( pxmiss*pxmiss + pymiss*pymiss );
+				double Etmiss_phi = atan2(pymiss,pxmiss);
+				lhco *p = new lhco(p_type, 0.0, Etmiss_phi, Etmiss);
+				ev->push_back(p);
 
-			} // End of event loop
+  			}
 
+			//============= Tagging analysis =============//
+			stage_start = stage_clock::now();
+			std::vector< fastjet::PseudoJet > taggedJets = tag_fatjets(fatJets, TopTagger);
+			job.time_tagging += std::chrono::duration< double >(stage_clock::now() - stage_start).count();
 
-			//============= Restart with ME of a reduced the number of jets =============//
-			if( njetcounterLO > 0 )
-				njetcounterLO--;
-			else
-				break;
 
-		} // End while( njetcounterLO>=0 )
+			//============= Store the (lhco, taggedJets) pair in order of generation =============//
+			job.records.push_back(tagged_event());
+			job.records.back().ev = ev;
+			job.records.back().taggedJets.swap(taggedJets);
 
-		// // Print statistics
-		// pythia.statistics();
+			// Streaming mode: the visitor decides immediately whether the record is kept in memory
+			if ( visitor && !importedLHCO && !visit_record(job.records.back()) )
+				job.records.pop_back();
 
-		if ( DoMerging )
-		{		
-			sigmaTotal *= 1e9;
-			double sigmaErr = sqrt(errorTotal)*1e9;
-			std::cout << "\n\nFinal cross section: " << sigmaTotal << " +- " << sigmaErr << " pb.";
-		}
+			// Exit First event loop and release the other workers: tagging details are not printed by them
+			if ( firstEvent )
+		   		firstEvent = false;
+			if ( first_done )
+			{
+				printTopTagDetails = false;
+				printBDRSDetails = false;
+				first_done->set_value();
+				first_done = nullptr;
+			}
 
-		std::cout << "\n" << std::endl;	
-		
-		delete fatJetDef;
-		delete skinnyJetDef;
+		} // End of event loop
 
+		// Release the other workers if no event was accepted
+		if ( first_done )
+		{
+			printTopTagDetails = false;
+			printBDRSDetails = false;
+			first_done->set_value();
+		}
 	}
 
 
@@ -0,0 +1,140 @@
+/* Isolation grid class
+ *
+ * Bins the visible final state particles of a Pythia event once in an 
+ * eta-phi grid, such that isolation cone sums only visit neighbouring cells.
+*/
+
+#include "isolation_grid.h"
+
+
+/* NAMESPACE */
+namespace analysis
+{
+
+	/* con- & destructor */
+
+	isolation_grid::isolation_grid(double max_eta, double cell_size)
+	{
+		set_geometry(max_eta, cell_size);
+	}
+
+	isolation_grid::~isolation_grid()
+	{
+	}
+
+	/* grid construction */
+
+	void isolation_grid::set_geometry(double max_eta, double cell_size)
+	{
+		grid_max_eta = max_eta;
+		grid_cell_size = cell_size > 0 ? cell_size : 0.4;
+
+		// cells are at least as wide as the requested cell size
+		nr_eta_cells = std::max(1, static_cast<int>(2 * grid_max_eta / grid_cell_size));
+		nr_phi_cells = std::max(1, static_cast<int>(2 * M_PI / grid_cell_size));
+		eta_width = 2 * grid_max_eta / nr_eta_cells;
+		phi_width = 2 * M_PI / nr_phi_cells;
+	}
+
+	void isolation_grid::fill(const Pythia8::Event & particles)
+	{
+		int size = particles.size();
+		p_eta.assign(size, 0.);
+		p_phi.assign(size, 0.);
+		p_pt.assign(size, 0.);
+		particle_cell.assign(size, -1);
+		cell_start.assign(nr_eta_cells * nr_phi_cells + 1, 0);
+
+		// precompute kinematics and count the visible final state particles per cell
+		for (int i = 0; i < size; ++i)
+		{
+			const Pythia8::Particle & p = particles[i];
+			if (!p.isFinal())
+				continue;
+
+			p_eta[i] = p.eta();
+			p_phi[i] = p.phi();
+			p_pt[i] = p.pT();
+
+			// only visible particles within the detector range enter the cone sums
+			long id = p.idAbs();
+			if (id == 12 || id == 14 || id == 16 || id == 1000022 || id == 8880022)
+				continue;
+			if (std::abs(p_eta[i]) >= grid_max_eta)
+				continue;
+
+			int cell = eta_cell(p_eta[i]) * nr_phi_cells + phi_cell(p_phi[i]);
+			particle_cell[i] = cell;
+			cell_start[cell + 1]++;
+		}
+
+		// order the particles by cell
+		for (unsigned int c = 1; c < cell_start.size(); ++c)
+			cell_start[c] += cell_start[c - 1];
+		cell_particle.resize(cell_start.back());
+		std::vector<int> cell_fill(cell_start.begin(), cell_start.end() - 1);
+		for (int i = 0; i < size; ++i)
+			if (particle_cell[i] >= 0)
+				cell_particle[cell_fill[particle_cell[i]]++] = i;
+	}
+
+	/* cone sum */
+
+	double isolation_grid::cone_pt(double eta0, double phi0, double r, double pt_min, int j) const
+	{
+		double r2 = r * r;
+
+		// range of neighbouring cells which may overlap with the cone
+		int center_eta = eta_cell(eta0);
+		int center_phi = phi_cell(phi0);
+		int reach_eta = static_cast<int>(std::ceil(r / eta_width));
+		int reach_phi = static_cast<int>(std::ceil(r / phi_width));
+		int min_eta = std::max(0, center_eta - reach_eta);
+		int max_eta = std::min(nr_eta_cells - 1, center_eta + reach_eta);
+		int min_phi = center_phi - reach_phi;
+		int max_phi = center_phi + reach_phi;
+		if (2 * reach_phi + 1 >= nr_phi_cells)
+		{
+			min_phi = 0;
+			max_phi = nr_phi_cells - 1;
+		}
+
+		double sum_pt = 0.;
+		for (int ce = min_eta; ce <= max_eta; ++ce)
+		{
+			for (int cp = min_phi; cp <= max_phi; ++cp)
+			{
+				int cell = ce * nr_phi_cells + (cp + nr_phi_cells) % nr_phi_cells;
+				for (int k = cell_start[cell]; k < cell_start[cell + 1]; ++k)
+				{
+					int i = cell_particle[k];
+					if (i == j || p_pt[i] <= pt_min)
+						continue;
+
+					double delta_eta = p_eta[i] - eta0;
+					double delta_phi = std::abs(p_phi[i] - phi0);
+					delta_phi = std::min(delta_phi, 2 * M_PI - delta_phi);
+					if (delta_eta * delta_eta + delta_phi * delta_phi < r2)
+						sum_pt += p_pt[i];
+				}
+			}
+		}
+		return sum_pt;
+	}
+
+	/* cell index */
+
+	int isolation_grid::eta_cell(double eta) const
+	{
+		int cell = static_cast<int>(std::floor((eta + grid_max_eta) / eta_width));
+		return std::min(std::max(cell, 0), nr_eta_cells - 1);
+	}
+
+	int isolation_grid::phi_cell(double phi) const
+	{
+		int cell = static_cast<int>(std::floor((phi + M_PI) / phi_width));
+		return ((cell % nr_phi_cells) + nr_phi_cells) % nr_phi_cells;
+	}
+
+/* NAMESPACE */
+}
@@ -0,0 +1,64 @@
+/* Isolation grid class
+ *
+ * Bins the visible final state particles of a Pythia event once in an 
+ * eta-phi grid, such that isolation cone sums only visit neighbouring cells.
+*/
+
+#ifndef INC_ISOLATION_GRID
+#define INC_ISOLATION_GRID
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Pythia8/Pythia.h"
+
+
+/* NAMESPACE */
+namespace analysis
+{
+
+	class isolation_grid
+	{
+
+	public:
+		/* con- & destructor */
+		isolation_grid(double max_eta = 4.9, double cell_size = 0.4);
+		~isolation_grid();
+
+		/* grid construction */
+		void set_geometry(double max_eta, double cell_size);
+		void fill(const Pythia8::Event & particles);
+
+		/* sum of pT > pt_min of the particles within deltaR < r around (eta, phi), excluding particle j */
+		double cone_pt(double eta, double phi, double r, double pt_min, int j = -1) const;
+
+	private:
+		/* cell index of eta and phi */
+		int eta_cell(double eta) const;
+		int phi_cell(double phi) const;
+
+		/* geometry */
+		double grid_max_eta;
+		double grid_cell_size;
+		int nr_eta_cells;
+		int nr_phi_cells;
+		double eta_width;
+		double phi_width;
+
+		/* precomputed kinematics of the final state particles: eta, phi, pt */
+		std::vector<double> p_eta;
+		std::vector<double> p_phi;
+		std::vector<double> p_pt;
+
+		/* visible final state particles ordered by cell, cell_start[c] is the first entry of cell c */
+		std::vector<int> cell_start;
+		std::vector<int> cell_particle;
+		std::vector<int> particle_cell;
+
+	};
+
+/* NAMESPACE */
+}
+
+#endif
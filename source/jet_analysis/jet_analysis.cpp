@@ -16,12 +16,16 @@ namespace analysis
 	{
 		// basic settings and flags
 		nEvent = 1000;
+		nWorkers = 1;
+		Seed = 19780503; // pythia default seed
 		firstEvent = true;
 		printTopTagDetails = true;
 		printBDRSDetails = true;
 		fast_showering = false;
 		importedLHE = false;
 		importedLHCO = false;
+		useCache = false;
+		visitor = nullptr;
 
 		// detector range and Isolation parameters
 		MaxEta = 4.9;
@@ -45,6 +49,9 @@ namespace analysis
 		pTminTrack_IsoGamma = 1.0;
 		pTfracMax_IsoGamma = 0.1;
 
+		// overlap removal: no jets within R=0.2 cone from an electron, in rapidity as PseudoJet::delta_R
+		overlap.add_rule("jet-electron", ptype_jet, ptype_electron, 0.2, true);
+
 		// merging procedure flags
 		DoMerging = false;
 		Process = false;
@@ -52,6 +59,12 @@ namespace analysis
 		Scale = false;
 		PythiaDecay = false;
 
+		// pileup parameters
+		DoPileup = false;
+		pileup_mu = 0.;
+		pileup_pool_size = 1000;
+		pileup_ecm = 13000.;
+
 		// jet clustering parameters
 		algorithm_fat = fastjet::cambridge_algorithm;
 		Rsize_fat = 1.4;
@@ -69,10 +82,20 @@ namespace analysis
 		BDRS_w_max = 95.;
 		BDRS_higgs_min = 100.;
 		BDRS_higgs_max = 130.;
+
+		// tagger instances are built in the initialisation
+		jh_tagger = nullptr;
+		hep_tagger = nullptr;
+		md_tagger = nullptr;
+		bdrs_filter = nullptr;
 	}
 
 	jet_analysis::~jet_analysis()
 	{
+		delete jh_tagger;
+		delete hep_tagger;
+		delete md_tagger;
+		delete bdrs_filter;
 	}
 
 	/* tagging information */
@@ -9,8 +9,10 @@
 #include <cmath>
 #include <cstdlib>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <string> 
 #include <vector> 
 
@@ -27,9 +29,13 @@
 #include "fastjet/tools/Filter.hh"
 
 #include "HEPTopTagger.h"
+#include "flavour_ancestry.h"
+#include "isolation_grid.h"
+#include "pileup_pool.h"
 #include "../cuts/cuts.h"
 #include "../particle/lhco.h"
 #include "../event/event.h"
+#include "../event/overlap_removal.h"
 #include "../utility/utility.h"
 
 
@@ -37,11 +43,98 @@
 namespace analysis
 {
 
+	/* record of an lhco event and its tagged fat jets */
+	struct tagged_event
+	{
+		event *ev;
+		std::vector< fastjet::PseudoJet > taggedJets;
+	};
+
+	/* requirement base class for tagged event records */
+	class tagged_cut
+	{
+
+	public:
+		// constructor can be default
+		tagged_cut() = default;
+		// virtual destructor needed for being a overloadable class
+		virtual ~tagged_cut() {};
+		// all requirements are based on this class and should overload this
+		// operator, and return true for records that pass the requirement
+		virtual bool operator() (const tagged_event & record) { return false; }
+
+	};
+
+	/* visitor base class for the streaming mode, receiving the records as they are produced */
+	class tagged_visitor
+	{
+
+	public:
+		// constructor can be default
+		tagged_visitor() = default;
+		// virtual destructor needed for being a overloadable class
+		virtual ~tagged_visitor() {};
+		// called once per record, never concurrently, and in order of generation for a single 
+		// worker; return true to keep the record in memory, rejected records are deleted
+		// (with imported lhco events it is called when the worker outputs are merged, see set_visitor)
+		virtual bool operator() (const tagged_event & record) { return false; }
+
+	};
+
+	/* view on a member of the selected records, without copying */
+	template < class Type >
+	class tagged_view
+	{
+
+	public:
+		tagged_view(const std::vector< tagged_event > & records, const std::vector< unsigned int > & selection, Type tagged_event::*member) 
+			: v_records(records), v_selection(selection), v_member(member) {}
+
+		unsigned int size() const { return v_selection.size(); }
+		bool empty() const { return v_selection.empty(); }
+		const Type & operator[] (unsigned int i) const { return v_records[v_selection[i]].*v_member; }
+
+	private:
+		const std::vector< tagged_event > & v_records;
+		const std::vector< unsigned int > & v_selection;
+		Type tagged_event::*v_member;
+
+	};
+
+	/* showering job of a single worker: initialisation.cpp */
+	struct shower_job
+	{
+		// input sample, pythia seed and range of LHE events [first, last)
+		std::string input_file;
+		int njet;
+		int seed;
+		int first;
+		int last;
+		double norm;
+
+		// output in order of generation: tagged event records and cross section sums
+		std::vector< tagged_event > records;
+		double sigma;
+		double error;
+
+		// time in seconds spent per stage of the event loop
+		double time_shower;
+		double time_particles;
+		double time_clustering;
+		double time_tagging;
+
+		// objects removed per overlap removal rule
+		std::vector< unsigned long long > removed_overlap;
+	};
+
 	/* jet analysis */
 	class jet_analysis
 	{
 
 	public:
+		/* tagger member function used in the initialisation */
+		typedef fastjet::PseudoJet (jet_analysis::*tagger_function)(const fastjet::PseudoJet &);
+
 		/* class con- & destructor: jet_analysis.cpp */
 		jet_analysis();
 		~jet_analysis();
@@ -51,6 +144,12 @@ namespace analysis
 		void set_fast_showering();
 		void import_lhco(const std::string & name);
 		void set_nEvents(const int & events);
+		void set_nWorkers(const int & workers);
+		void set_seed(const int & seed);
+		void set_cache(const std::string & directory);
+		void set_visitor(tagged_visitor & record_visitor);
+		void set_pileup(const double & mu, const int & pool_size = 1000, const double & ecm = 13000.);
+		void set_pileup_pool(const std::string & file);
 		void set_Isolation(const std::string & type, const double & eta, const double & pt, const double & Rcone, const double & ptMinTrack = 1.0, const double & ptfracMax = 0.1);
 		void set_Rsize_fat(const double & R);
 		void set_Rsize_skinny(const double & R);
@@ -60,6 +159,8 @@ namespace analysis
 		void set_BDRS_higgs_range(const double & higgs_min, const double & higgs_max);
 		void undo_TopTagging();
 		void undo_BDRSTagging();
+		void set_overlap_removal(const overlap_removal & rules);
+		const overlap_removal & get_overlap_removal() const;
 
 		/* merging settings: settings.cpp */
 		void set_merging_process(const std::string & process);
@@ -72,25 +173,43 @@ namespace analysis
 		bool isolatedElectron(const int & j, const Pythia8::Event & particles);
 		bool isolatedMuon(const int & j, const Pythia8::Event & particles);
 		bool isolatedPhoton(const int & j, const Pythia8::Event & particles);
-		bool JetElectronOverlapping(const fastjet::PseudoJet & jet, const std::vector< fastjet::PseudoJet > & leptons);
+		bool isolatedElectron(const int & j, const Pythia8::Event & particles, const isolation_grid & grid);
+		bool isolatedMuon(const int & j, const Pythia8::Event & particles, const isolation_grid & grid);
+		bool isolatedPhoton(const int & j, const Pythia8::Event & particles, const isolation_grid & grid);
 
 		/* tag and cut functions: tagandcut.cpp */
 		fastjet::PseudoJet JHTopTagging(const fastjet::PseudoJet & jet);
 		fastjet::PseudoJet HEPTopTagging(const fastjet::PseudoJet & jet);
 		fastjet::PseudoJet BDRSTagging(const fastjet::PseudoJet & jet);
+		void build_taggers();
+		std::vector< fastjet::PseudoJet > tag_fatjets(const std::vector< fastjet::PseudoJet > & fatJets, tagger_function TopTagger);
+		void tag_fatjets(std::vector< std::vector< fastjet::PseudoJet > > & chunk, tagger_function TopTagger);
 		double reduce_sample(cuts cut_list);
+		double require(tagged_cut & requirement);
 		double require_fatjet_pt(const double & ptcut, const int & n = 1);
 		double require_top_tagged(const int & n);
 		double require_higgs_tagged(const int & n);
 		double require_w_tagged(const int & n);
 		double require_t_or_w_tagged(const int & n);
 		
-		/* extract lhco or fatjets from map: tagandcut.cpp */
-		std::vector< event* > events();
-		std::vector< std::vector< fastjet::PseudoJet > > fatjets();
+		/* access the selected records: tagandcut.cpp */
+		void add_record(event *ev, const std::vector< fastjet::PseudoJet > & taggedJets);
+		bool visit_record(tagged_event & record);
+		unsigned int nr_selected() const;
+		const tagged_event & selected(unsigned int i) const;
+		tagged_view< event* > events() const;
+		tagged_view< std::vector< fastjet::PseudoJet > > fatjets() const;
+
+		/* shower and cluster cache: cache.cpp */
+		std::string cache_file(tagger_function TopTagger);
+		bool read_cache(const std::string & file);
+		void write_cache(const std::string & file, const double & sigma, const double & sigmaErr);
 
 		/* initialisation function: initialisation.cpp */
-		void initialise(fastjet::PseudoJet (jet_analysis::*TopTagger)(const fastjet::PseudoJet &) = &jet_analysis::JHTopTagging);
+		void initialise(tagger_function TopTagger = &jet_analysis::JHTopTagging);
+		void configure_pythia(Pythia8::Pythia & pythia);
+		void estimate_xsec(const std::string & input_file, const int & njet, double & xsec, double & naccept);
+		void shower_events(shower_job & job, tagger_function TopTagger, std::promise< void > *first_done = nullptr);
 	
 	public: // TODO: private
 		
@@ -98,12 +217,19 @@ namespace analysis
 		std::string lhe_input;
 		std::string lhco_input;
 		int nEvent;
+		int nWorkers;
+		int Seed;
 		bool firstEvent;
 		bool printTopTagDetails;
 		bool printBDRSDetails;
 		bool fast_showering;
 		bool importedLHE;
 		bool importedLHCO;
+		bool useCache;
+		std::string cache_dir;
+		std::string cache_key;
+		tagged_visitor *visitor;
+		std::mutex visitor_mutex;
 
 		/* detector range and isolation parameters */
 		double MaxEta;
@@ -127,6 +253,9 @@ namespace analysis
 		double pTminTrack_IsoGamma;
 		double pTfracMax_IsoGamma; 
 
+		/* overlap removal rules applied to the lhco events, with counters of the removed objects */
+		overlap_removal overlap;
+
 		/* merging flags and parameters */
 		bool DoMerging;
 		bool Process;
@@ -137,6 +266,14 @@ namespace analysis
 		int MergingNJetMax;
 		double MergingScale;
 
+		/* pileup parameters and pool of minimum-bias events */
+		bool DoPileup;
+		double pileup_mu;
+		int pileup_pool_size;
+		double pileup_ecm;
+		std::string pileup_file;
+		pileup_pool pileup;
+
 		/* jet clustering parameters */
 		fastjet::JetAlgorithm algorithm_fat;
 		double Rsize_fat;
@@ -155,8 +292,15 @@ namespace analysis
 		double BDRS_higgs_min;
 		double BDRS_higgs_max;
 
-		/* map (lhco, taggedJets) */
-		std::map< event *, std::vector< fastjet::PseudoJet > > map_lhco_taggedJets;
+		/* tagger instances, built once by build_taggers and shared by all workers */
+		fastjet::JHTopTagger *jh_tagger;
+		HEPTopTagger *hep_tagger;
+		fastjet::MassDropTagger *md_tagger;
+		fastjet::Filter *bdrs_filter;
+
+		/* (lhco, taggedJets) records in order of generation and indices of the records passing all requirements */
+		std::vector< tagged_event > records;
+		std::vector< unsigned int > selection;
 
 	};
 
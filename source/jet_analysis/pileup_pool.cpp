@@ -0,0 +1,171 @@
+/* Pileup pool class
+ *
+ * Stores the visible final states of a pool of minimum-bias events in flat 
+ * arrays, such that pileup is overlaid on hard events by index sampling.
+*/
+
+#include <algorithm>
+
+#include "pileup_pool.h"
+
+
+/* NAMESPACE */
+namespace analysis
+{
+
+	// version of the binary pool format, increase when the layout changes
+	const unsigned int pileup_pool_version = 2;
+
+	/* con- & destructor */
+
+	pileup_pool::pileup_pool()
+	{
+		event_start.push_back(0);
+	}
+
+	pileup_pool::~pileup_pool()
+	{
+	}
+
+
+	/* pool construction */
+
+	void pileup_pool::generate(int nr_events, double ecm, int seed, double max_eta)
+	{
+		// Minimum-bias events without printout
+		Pythia8::Pythia pythia;
+		pythia.settings.flag("Print:quiet", true);
+		pythia.settings.flag("SoftQCD:nonDiffractive", true);
+		pythia.settings.parm("Beams:eCM", ecm);
+		pythia.settings.flag("Random:setSeed", true);
+		pythia.settings.mode("Random:seed", seed);
+		if (!pythia.init())
+		{
+			std::cout << "Error while initialising Pythia (pileup pool)" << std::endl;
+			exit (EXIT_FAILURE);
+		}
+
+		std::cout << "\nGenerating pileup pool of " << nr_events << " minimum-bias events." << std::endl;
+		for (int iEvent = 0; iEvent < nr_events; ++iEvent)
+		{
+			if (!pythia.next())
+				continue;
+
+			// visible final state particles within the detector range, as for the hard events
+			for (int i = 0; i < pythia.event.size(); ++i)
+			{
+				const Pythia8::Particle & p = pythia.event[i];
+				if (!p.isFinal() || std::abs(p.eta()) > max_eta)
+					continue;
+				long id = p.idAbs();
+				if (id == 12 || id == 14 || id == 16 || id == 1000022 || id == 8880022)
+					continue;
+
+				p_px.push_back(p.px());
+				p_py.push_back(p.py());
+				p_pz.push_back(p.pz());
+				p_e.push_back(p.e());
+			}
+			event_start.push_back(p_px.size());
+		}
+	}
+
+	bool pileup_pool::read(const std::string & file)
+	{
+		std::ifstream ifs(file.c_str(), std::ios::binary);
+		if (!ifs.is_open())
+			return false;
+
+		unsigned int version = 0, nr_ev = 0, nr_part = 0;
+		ifs.read(reinterpret_cast<char*>(&version), sizeof(version));
+		ifs.read(reinterpret_cast<char*>(&nr_ev), sizeof(nr_ev));
+		ifs.read(reinterpret_cast<char*>(&nr_part), sizeof(nr_part));
+		if (!ifs || version != pileup_pool_version)
+		{
+			std::cout << "Warning: pileup pool " << file << " has an unknown format." << std::endl;
+			return false;
+		}
+
+		std::vector<unsigned int> start(nr_ev + 1);
+		std::vector<float> px(nr_part), py(nr_part), pz(nr_part), e(nr_part);
+		ifs.read(reinterpret_cast<char*>(start.data()), start.size() * sizeof(unsigned int));
+		ifs.read(reinterpret_cast<char*>(px.data()), nr_part * sizeof(float));
+		ifs.read(reinterpret_cast<char*>(py.data()), nr_part * sizeof(float));
+		ifs.read(reinterpret_cast<char*>(pz.data()), nr_part * sizeof(float));
+		ifs.read(reinterpret_cast<char*>(e.data()), nr_part * sizeof(float));
+		// the event ranges need to be ordered, such that the overlay stays within the particles
+		if (!ifs || start.front() != 0 || start.back() != nr_part || !std::is_sorted(start.begin(), start.end()))
+		{
+			std::cout << "Warning: pileup pool " << file << " is incomplete." << std::endl;
+			return false;
+		}
+
+		event_start.swap(start);
+		p_px.swap(px);
+		p_py.swap(py);
+		p_pz.swap(pz);
+		p_e.swap(e);
+		std::cout << "\nLoaded pileup pool of " << nr_events() << " minimum-bias events from " << file << std::endl;
+		return true;
+	}
+
+	bool pileup_pool::write(const std::string & file) const
+	{
+		std::ofstream ofs(file.c_str(), std::ios::binary);
+		if (!ofs.is_open())
+		{
+			std::cout << "Warning: could not write pileup pool " << file << std::endl;
+			return false;
+		}
+
+		unsigned int nr_ev = nr_events(), nr_part = nr_particles();
+		ofs.write(reinterpret_cast<const char*>(&pileup_pool_version), sizeof(pileup_pool_version));
+		ofs.write(reinterpret_cast<const char*>(&nr_ev), sizeof(nr_ev));
+		ofs.write(reinterpret_cast<const char*>(&nr_part), sizeof(nr_part));
+		ofs.write(reinterpret_cast<const char*>(event_start.data()), event_start.size() * sizeof(unsigned int));
+		ofs.write(reinterpret_cast<const char*>(p_px.data()), nr_part * sizeof(float));
+		ofs.write(reinterpret_cast<const char*>(p_py.data()), nr_part * sizeof(float));
+		ofs.write(reinterpret_cast<const char*>(p_pz.data()), nr_part * sizeof(float));
+		ofs.write(reinterpret_cast<const char*>(p_e.data()), nr_part * sizeof(float));
+		return ofs.good();
+	}
+
+
+	/* access */
+
+	int pileup_pool::nr_events() const
+	{
+		return event_start.size() - 1;
+	}
+
+	int pileup_pool::nr_particles() const
+	{
+		return p_px.size();
+	}
+
+
+	/* overlay */
+
+	int pileup_pool::overlay(std::vector< fastjet::PseudoJet > & inputs, double mu, std::mt19937 & rng) const
+	{
+		if (nr_events() == 0 || mu <= 0.)
+			return 0;
+
+		// number of pileup events and the pool events drawn with replacement
+		std::poisson_distribution<int> nr_pileup(mu);
+		std::uniform_int_distribution<int> pick(0, nr_events() - 1);
+		int n = nr_pileup(rng);
+		for (int k = 0; k < n; ++k)
+		{
+			int ev = pick(rng);
+			for (unsigned int i = event_start[ev]; i < event_start[ev + 1]; ++i)
+			{
+				inputs.push_back(fastjet::PseudoJet(p_px[i], p_py[i], p_pz[i], p_e[i]));
+				inputs.back().set_user_index(-1);
+			}
+		}
+		return n;
+	}
+
+/* NAMESPACE */
+}
@@ -0,0 +1,58 @@
+/* Pileup pool class
+ *
+ * Stores the visible final states of a pool of minimum-bias events in flat 
+ * arrays, such that pileup is overlaid on hard events by index sampling.
+*/
+
+#ifndef INC_PILEUP_POOL
+#define INC_PILEUP_POOL
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Pythia8/Pythia.h"
+#include "fastjet/PseudoJet.hh"
+
+
+/* NAMESPACE */
+namespace analysis
+{
+
+	class pileup_pool
+	{
+
+	public:
+		/* con- & destructor */
+		pileup_pool();
+		~pileup_pool();
+
+		/* pool construction: generate minimum-bias events with Pythia or use a stored pool */
+		void generate(int nr_events, double ecm, int seed, double max_eta);
+		bool read(const std::string & file);
+		bool write(const std::string & file) const;
+
+		/* number of events and particles in the pool */
+		int nr_events() const;
+		int nr_particles() const;
+
+		/* appends the particles of a Poisson(mu) distributed number of pool events, with user index -1 */
+		int overlay(std::vector< fastjet::PseudoJet > & inputs, double mu, std::mt19937 & rng) const;
+
+	private:
+		/* four-momenta of the particles of all events, event_start[e] is the first particle of event e */
+		std::vector<float> p_px;
+		std::vector<float> p_py;
+		std::vector<float> p_pz;
+		std::vector<float> p_e;
+		std::vector<unsigned int> event_start;
+
+	};
+
+/* NAMESPACE */
+}
+
+#endif
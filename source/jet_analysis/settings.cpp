@@ -34,6 +34,50 @@ namespace analysis
 		nEvent = events;
 	}
 
+	void jet_analysis::set_nWorkers(const int & workers)
+	{
+		if (workers < 1)
+		{
+			std::cout << "Wrong number of workers. Using a single worker." << std::endl;
+			nWorkers = 1;
+			return;
+		}
+		nWorkers = workers;
+	}
+
+	void jet_analysis::set_seed(const int & seed)
+	{
+		Seed = seed;
+	}
+
+	void jet_analysis::set_cache(const std::string & directory)
+	{
+		useCache = true;
+		cache_dir = directory;
+	}
+
+	// streaming mode: the records are visited by the showering workers and only the kept ones
+	// stay in memory; with imported lhco events the pairing with the lhco events is only known
+	// when the worker outputs are merged, hence all records of a pass are buffered first and
+	// the streaming mode saves no memory in that case
+	void jet_analysis::set_visitor(tagged_visitor & record_visitor)
+	{
+		visitor = &record_visitor;
+	}
+
+	void jet_analysis::set_pileup(const double & mu, const int & pool_size, const double & ecm)
+	{
+		DoPileup = mu > 0.;
+		pileup_mu = mu;
+		pileup_pool_size = pool_size;
+		pileup_ecm = ecm;
+	}
+
+	void jet_analysis::set_pileup_pool(const std::string & file)
+	{
+		pileup_file = file;
+	}
+
 	// TODO: update using p_type
 	void jet_analysis::set_Isolation(const std::string & type, const double & eta, const double & pt, const double & Rcone, const double & ptMinTrack, const double & ptfracMax)
 	{
@@ -116,6 +160,17 @@ namespace analysis
 		DoBDRS = false;
 	}
 
+	void jet_analysis::set_overlap_removal(const overlap_removal & rules)
+	{
+		overlap = rules;
+		overlap.reset_counters();
+	}
+
+	const overlap_removal & jet_analysis::get_overlap_removal() const
+	{
+		return overlap;
+	}
+
 	/* merging settings */
 
 	void jet_analysis::set_merging_process(const std::string & process)
@@ -3,6 +3,9 @@
  * 
 */
 
+#include <algorithm>
+#include <thread>
+
 #include "jet_analysis.h"
 
 
@@ -12,17 +15,56 @@ namespace analysis
 
 	/* tag and cut functions */
 
+	// BDRS filtering radius of a mass drop tagged jet: half the distance of its parents, at most 0.3
+	class BDRS_filter_radius : public fastjet::FunctionOfPseudoJet< double >
+	{
+	public:
+		double result(const fastjet::PseudoJet & tagged) const
+		{
+			double Rjj = tagged.pieces()[0].delta_R(tagged.pieces()[1]);
+			return std::min(Rjj/2, 0.3); // somewhat arbitrary choice
+		}
+	};
+	static BDRS_filter_radius bdrs_filter_radius;
+
+	void jet_analysis::build_taggers()
+	{
+		// JH Top-tagger algorithm
+		delete jh_tagger;
+		jh_tagger = new fastjet::JHTopTagger(JHTopTagger_delta_p, JHTopTagger_delta_r);
+		jh_tagger->set_top_selector(fastjet::SelectorMassRange(150,200));
+		jh_tagger->set_W_selector  (fastjet::SelectorMassRange( 65, 95));
+
+		// HEP Top-tagger algorithm, the jet is set for each run on a copy
+		double topmass=172.3;
+		double wmass=80.4;
+		delete hep_tagger;
+		hep_tagger = new HEPTopTagger(topmass, wmass);
+		hep_tagger->set_top_range(150.,200.);
+
+		/* from example 12 of FastJet */
+
+		// Mass drop tagger with \mu=0.667 and ycut=0.09
+		delete md_tagger;
+		md_tagger = new fastjet::MassDropTagger(0.667, 0.09);
+
+		// Filter of the tagged jet, to remove UE & pileup contamination: C/A with a radius 
+		// depending on the tagged jet and the three hardest pieces
+		unsigned nfilt = 3;
+		delete bdrs_filter;
+		bdrs_filter = new fastjet::Filter(&bdrs_filter_radius, fastjet::SelectorNHardest(nfilt));
+	}
+
 	fastjet::PseudoJet jet_analysis::JHTopTagging(const fastjet::PseudoJet & jet)
 	{
-		// Definition of JH Top-tagger algorithm
-		fastjet::JHTopTagger top_tagger(JHTopTagger_delta_p, JHTopTagger_delta_r);
-		top_tagger.set_top_selector(fastjet::SelectorMassRange(150,200));
-		top_tagger.set_W_selector  (fastjet::SelectorMassRange( 65, 95));
-		fastjet::PseudoJet tagged = top_tagger(jet);
+		// Taggers are built in the initialisation, or on first use outside of it
+		if ( !jh_tagger )
+			build_taggers();
+		fastjet::PseudoJet tagged = (*jh_tagger)(jet);
 
 		// Print Top-tagging details
 		if ( printTopTagDetails )
-			std::cout << "\nRan the following top tagger:\n" << top_tagger.description() << std::endl;
+			std::cout << "\nRan the following top tagger:\n" << jh_tagger->description() << std::endl;
 
 		// Set TagInfo
 		if ( tagged!=0 ) // return top-tagged jet
@@ -38,12 +80,11 @@ namespace analysis
 
 	fastjet::PseudoJet jet_analysis::HEPTopTagging(const fastjet::PseudoJet & jet)
 	{
-		// Definition of HEP Top-tagger algorithm
-		double topmass=172.3;
-		double wmass=80.4;
-		HEPTopTagger top_tagger(*(jet.associated_cs()),jet,topmass,wmass);
-		top_tagger.set_top_range(150.,200.);
-		top_tagger.run_tagger();		
+		// The HEPTopTagger stores its results, so each run uses a copy of the configured tagger
+		if ( !hep_tagger )
+			build_taggers();
+		HEPTopTagger top_tagger(*hep_tagger);
+		top_tagger.run_tagger(*(jet.associated_cs()), jet);
 
 		// Print Top-tagging details
 		if ( printTopTagDetails )
@@ -80,32 +121,18 @@ namespace analysis
 	fastjet::PseudoJet jet_analysis::BDRSTagging(const fastjet::PseudoJet & jet)
 	{
 		/* from example 12 of FastJet */
-
-		// Definition of Mass drop tagger with \mu=0.667 and ycut=0.09
-		fastjet::MassDropTagger md_tagger(0.667, 0.09);
-		fastjet::PseudoJet tagged = md_tagger(jet);
+		if ( !md_tagger )
+			build_taggers();
+		fastjet::PseudoJet tagged = (*md_tagger)(jet);
 
 		// Print BDRS-tagging details
 		if ( printBDRSDetails )
-			std::cout << "\nRan the following BDRS tagger:\n" << md_tagger.description() << std::endl << std::endl;
+			std::cout << "\nRan the following BDRS tagger:\n" << md_tagger->description() << std::endl << std::endl;
 
 		if ( tagged!=0 )
 		{
 			// Filter the tagged jet, to remove UE & pileup contamination
-			fastjet::PseudoJet parent1 = tagged.pieces()[0];
-	  		fastjet::PseudoJet parent2 = tagged.pieces()[1];
-	  		double   Rjj = parent1.delta_R(parent2);
-	  		double   Rfilt = std::min(Rjj/2, 0.3); // somewhat arbitrary choice
-	  		unsigned nfilt = 3;               // number of pieces we'll take
-
-	  		fastjet::JetAlgorithm			cambridge = fastjet::cambridge_algorithm;
-	  		fastjet::RecombinationScheme    recombScheme = fastjet::E_scheme;
-			fastjet::Strategy               strategy = fastjet::Best;
-			fastjet::Filter filter(
-				fastjet::JetDefinition(cambridge, Rfilt, recombScheme, strategy),
-				fastjet::SelectorNHardest(nfilt)
-				);
-	  		fastjet::PseudoJet filtered = filter(tagged);
+	  		fastjet::PseudoJet filtered = (*bdrs_filter)(tagged);
 	  		std::vector< fastjet::PseudoJet > filtered_pieces = filtered.pieces();
 
 	  		// Set TagInfo
@@ -139,324 +166,250 @@ namespace analysis
 	}
 
 
-	/* apply cut function */
+	/* batch tagging of fat jets */
 
-	double jet_analysis::reduce_sample(cuts cut_list)
-	{	
-		// map_lhco_taggedJets iterator definition
-		std::map< event *, std::vector< fastjet::PseudoJet > >::iterator it;
-
-		// extract vector of event pointers "events"
-		std::vector< event * > events;
-		for (it=map_lhco_taggedJets.begin(); it!=map_lhco_taggedJets.end(); ++it)
-			events.push_back(it->first);
-
-		// perform the cuts defined in cut_list on "events"
-		cut_list.apply(events);
-		cut_list.write(std::cout);
-		double eff = cut_list.efficiency();
-
-		// retrieve from map_lhco_taggedJets only the elements which passed the cuts
-		std::map< event *, std::vector< fastjet::PseudoJet > > reduced_map;
-		for (unsigned int i = 0; i < events.size(); ++i)
-		{
-			it = map_lhco_taggedJets.find(events[i]);
-			if ( it!=map_lhco_taggedJets.end() )
-				reduced_map.insert( 
-					std::make_pair( events[i], 
-									map_lhco_taggedJets[events[i]] ) 
-					); // end insert
-		}
-
-		// resize the map_lhco_taggedJets
-		map_lhco_taggedJets = reduced_map;
-
-		// return total efficiency
-		return eff;
-	}
-
-	double jet_analysis::require_fatjet_pt(const double & ptcut, const int & n)
+	// tags all fat jets of an event: top tagging first, BDRS tagging on the remaining jets, 
+	// and the untagged jets with an empty TagInfo
+	std::vector< fastjet::PseudoJet > jet_analysis::tag_fatjets(const std::vector< fastjet::PseudoJet > & fatJets, tagger_function TopTagger)
 	{
-		std::map< event *, std::vector< fastjet::PseudoJet > >::iterator it;
-		std::map< event *, std::vector< fastjet::PseudoJet > > reduced_map;
-		int map_size = 0, passed = 0;
-		double eff;
-
-		for (it=map_lhco_taggedJets.begin(); it!=map_lhco_taggedJets.end(); ++it)
+		std::vector< fastjet::PseudoJet > taggedJets;
+		taggedJets.reserve(fatJets.size());
+		for (unsigned int i = 0; i < fatJets.size(); ++i)
 		{
-			map_size++;
-			int jetcount = 0;
-
-			if ((it->second).size()!=0)
+			// Top tagging
+			if ( DoTopTagger )
 			{
-				for (unsigned int i = 0; i < (it->second).size(); ++i)
+				fastjet::PseudoJet TopTagged;
+				TopTagged=(this->*TopTagger)(fatJets[i]);
+				if ( printTopTagDetails )
+					printTopTagDetails = false;
+				if ( TopTagged!=0 )
 				{
-					fastjet::PseudoJet fatjet;
-					fatjet = (it->second)[i];
-
-					if (fatjet.pt() > ptcut)
-						jetcount++;
-
-				} 
+					taggedJets.push_back(TopTagged);
+					continue;
+				}
+			}
 
-				if (jetcount >= n)
+			// BDRS tagging: only on non-top tagged fat jets
+			if ( DoBDRS )
+			{
+				fastjet::PseudoJet BDRSTagged;
+				BDRSTagged = BDRSTagging(fatJets[i]);
+				if ( printBDRSDetails )
+					printBDRSDetails = false;
+				if ( BDRSTagged!=0 )
 				{
-					passed++;
-					reduced_map.insert( std::make_pair(it->first,it->second) );
+					taggedJets.push_back(BDRSTagged);
+					continue;
 				}
+			}
 
-			} 
-
-		} 
-
-		// calculate efficiency
-		eff = (map_size == 0 ? 0.0 : static_cast<double>(passed) / map_size);
-
-		// resize the map_lhco_taggedJets
-		map_lhco_taggedJets = reduced_map;
-
-		return eff;
+			// push_back remaining non-tagged fatjets
+			fastjet::PseudoJet fatjet = fatJets[i];
+			fatjet.set_user_info(new TagInfo());
+			taggedJets.push_back(fatjet);
+		}
+		return taggedJets;
 	}
 
-	double jet_analysis::require_top_tagged(const int & n)
+	// tags the fat jets of a chunk of events in place with nWorkers threads, for callers which
+	// cluster the fat jets themselves; the cluster sequences have to be alive during the call
+	void jet_analysis::tag_fatjets(std::vector< std::vector< fastjet::PseudoJet > > & chunk, tagger_function TopTagger)
 	{
-		std::map< event *, std::vector< fastjet::PseudoJet > >::iterator it;
-		std::map< event *, std::vector< fastjet::PseudoJet > > reduced_map;
-		int map_size = 0, passed = 0;
-		double eff;
-
-		for (it=map_lhco_taggedJets.begin(); it!=map_lhco_taggedJets.end(); ++it)
+		if ( chunk.empty() )
+			return;
+		if ( !jh_tagger )
+			build_taggers();
+
+		// the first event is tagged alone, such that the tagging details are printed only once
+		chunk[0] = tag_fatjets(chunk[0], TopTagger);
+		printTopTagDetails = false;
+		printBDRSDetails = false;
+
+		// remaining events in contiguous ranges per worker
+		unsigned int nr_workers = std::max(1, nWorkers);
+		unsigned int range = (chunk.size() - 1 + nr_workers - 1) / nr_workers;
+		std::vector< std::thread > workers;
+		for (unsigned int first = 1; first < chunk.size(); first += range)
 		{
-			map_size++;
-			int toptag = 0;
-
-			if ((it->second).size()!=0)
+			unsigned int last = std::min< unsigned int >(chunk.size(), first + range);
+			workers.push_back(std::thread([this, &chunk, TopTagger, first, last]()
 			{
-				for (unsigned int i = 0; i < (it->second).size(); ++i)
-				{
-					fastjet::PseudoJet tagged;
-					tagged = (it->second)[i];
-
-					if (tagged.user_info<TagInfo>().top_tag())
-					{
-						// std::cout << "Found tagged top" << std::endl;
-						// std::cout << "top candidate:     " << tagged << std::endl;
-						// std::cout << "|_ W   candidate:  " << tagged.structure_of<fastjet::JHTopTagger>().W() << std::endl;
-						// std::cout << "|  |_  W subjet 1: " << tagged.structure_of<fastjet::JHTopTagger>().W1() << std::endl;
-						// std::cout << "|  |_  W subjet 2: " << tagged.structure_of<fastjet::JHTopTagger>().W2() << std::endl;
-						// std::cout << "|  cos(theta_W) =  " << tagged.structure_of<fastjet::JHTopTagger>().cos_theta_W() << std::endl;
-						// std::cout << "|_ non-W subjet:   " << tagged.structure_of<fastjet::JHTopTagger>().non_W() << std::endl;
-						toptag++;
-					}
-
-				} 
-
-				if (toptag >= n)
-				{
-					passed++;
-					reduced_map.insert( std::make_pair(it->first,it->second) );
-				}
-
-			} 
+				for (unsigned int iEv = first; iEv < last; ++iEv)
+					chunk[iEv] = tag_fatjets(chunk[iEv], TopTagger);
+			}));
+		}
+		for (unsigned int iWorker = 0; iWorker < workers.size(); ++iWorker)
+			workers[iWorker].join();
+	}
 
-		} 
 
-		// calculate efficiency
-		eff = (map_size == 0 ? 0.0 : static_cast<double>(passed) / map_size);
+	/* requirements on the tagged fat jets */
 
-		// resize the map_lhco_taggedJets
-		map_lhco_taggedJets = reduced_map;
+	// at least n fat jets with pT above ptcut
+	class tagged_fatjet_pt : public tagged_cut
+	{
+	public:
+		tagged_fatjet_pt(double ptcut, int n) : pt_min(ptcut), n_min(n) {}
+		bool operator() (const tagged_event & record)
+		{
+			if (record.taggedJets.size() == 0)
+				return false;
 
-		return eff;
-	}
+			int jetcount = 0;
+			for (unsigned int i = 0; i < record.taggedJets.size(); ++i)
+				if (record.taggedJets[i].pt() > pt_min)
+					jetcount++;
+			return jetcount >= n_min;
+		}
+	private:
+		double pt_min;
+		int n_min;
+	};
 
-	double jet_analysis::require_higgs_tagged(const int & n)
+	// at least n fat jets carrying any of the requested tags
+	class tagged_count : public tagged_cut
 	{
-		std::map< event *, std::vector< fastjet::PseudoJet > >::iterator it;
-		std::map< event *, std::vector< fastjet::PseudoJet > > reduced_map;
-		int map_size = 0, passed = 0;
-		double eff;
-
-		for (it=map_lhco_taggedJets.begin(); it!=map_lhco_taggedJets.end(); ++it)
+	public:
+		tagged_count(int n, bool top, bool w, bool h) : n_min(n), top_tag(top), w_tag(w), h_tag(h) {}
+		bool operator() (const tagged_event & record)
 		{
-			map_size++;
-			int higgstag = 0;
+			if (record.taggedJets.size() == 0)
+				return false;
 
-			if ((it->second).size()!=0)
+			int tagcount = 0;
+			for (unsigned int i = 0; i < record.taggedJets.size(); ++i)
 			{
-				for (unsigned int i = 0; i < (it->second).size(); ++i)
-				{
-					fastjet::PseudoJet tagged;
-					tagged = (it->second)[i];
-
-					if (tagged.user_info<TagInfo>().h_tag())
-					{
-						// std::cout << "Found tagged higgs" << std::endl;
-						// std::vector<f astjet::PseudoJet > tagged_pieces = tagged.pieces();
-						// fastjet::PseudoJet candidate;
-						// candidate = join(tagged_pieces[0], tagged_pieces[1]);
-						// double invMass = candidate.m();
-
-						// std::cout << "Filtered pieces are " << std::endl;
-						// for (unsigned i = 0; i < 3 && i < tagged_pieces.size(); i++) 
-						// {
-						// std::cout << " " << tagged_pieces[i] << std::endl;
-						// }
-						// std::cout << "Filtered total is " << std::endl;
-						// std::cout << " " << tagged << std::endl;
-						// std::cout << "Invariant mass of the two leading pieces: " << invMass << std::endl;
-						higgstag++;
-					}
-
-				} 
-
-				if (higgstag >= n)
-				{
-					passed++;
-					reduced_map.insert( std::make_pair(it->first,it->second) );
-				}
+				const TagInfo & info = record.taggedJets[i].user_info<TagInfo>();
+				if ( (top_tag && info.top_tag()) || (w_tag && info.w_tag()) || (h_tag && info.h_tag()) )
+					tagcount++;
+			}
+			return tagcount >= n_min;
+		}
+	private:
+		int n_min;
+		bool top_tag;
+		bool w_tag;
+		bool h_tag;
+	};
 
-			} 
+	/* apply cut function */
 
-		} 
+	double jet_analysis::reduce_sample(cuts cut_list)
+	{	
+		// extract vector of event pointers "events"
+		std::vector< event * > events;
+		events.reserve(selection.size());
+		for (unsigned int i = 0; i < selection.size(); ++i)
+			events.push_back(records[selection[i]].ev);
 
-		// calculate efficiency
-		eff = (map_size == 0 ? 0.0 : static_cast<double>(passed) / map_size);
-		
-		// resize the map_lhco_taggedJets
-		map_lhco_taggedJets = reduced_map;
+		// perform the cuts defined in cut_list on "events", failing events are deleted
+		cut_list.apply(events);
+		cut_list.write(std::cout);
+		double eff = cut_list.efficiency();
 
+		// the remaining events keep their order: keep only their records in the selection
+		unsigned int passed = 0;
+		for (unsigned int i = 0; i < selection.size(); ++i)
+		{
+			tagged_event & record = records[selection[i]];
+			if ( passed < events.size() && record.ev == events[passed] )
+				selection[passed++] = selection[i];
+			else
+				record.ev = nullptr;
+		}
+		selection.resize(passed);
+
+		// return total efficiency
 		return eff;
 	}
 
-	double jet_analysis::require_w_tagged(const int & n)
+	double jet_analysis::require(tagged_cut & requirement)
 	{
-		std::map< event *, std::vector< fastjet::PseudoJet > >::iterator it;
-		std::map< event *, std::vector< fastjet::PseudoJet > > reduced_map;
-		int map_size = 0, passed = 0;
-		double eff;
-
-		for (it=map_lhco_taggedJets.begin(); it!=map_lhco_taggedJets.end(); ++it)
+		// reduce the selection in place to the records passing the requirement
+		unsigned int total = selection.size(), passed = 0;
+		for (unsigned int i = 0; i < total; ++i)
 		{
-			map_size++;
-			int wtag = 0;
-
-			if ((it->second).size()!=0)
-			{
-				for (unsigned int i = 0; i < (it->second).size(); ++i)
-				{
-					fastjet::PseudoJet tagged;
-					tagged = (it->second)[i];
-
-					if (tagged.user_info<TagInfo>().w_tag())
-					{
-						// std::cout << "Found tagged W" << std::endl;
-						// std::vector< fastjet::PseudoJet > tagged_pieces = tagged.pieces();
-						// fastjet::PseudoJet candidate;
-						// candidate = join(tagged_pieces[0], tagged_pieces[1]);
-						// double invMass = candidate.m();
-
-						// std::cout << "Filtered pieces are " << std::endl;
-						// for (unsigned i = 0; i < 3 && i < tagged_pieces.size(); i++) 
-						// {
-						// std::cout << " " << tagged_pieces[i] << std::endl;
-						// }
-						// std::cout << "Filtered total is " << std::endl;
-						// std::cout << " " << tagged << std::endl;
-						// std::cout << "Invariant mass of the two leading pieces: " << invMass << std::endl;
-						wtag++;
-					}
-
-				} 
-
-				if (wtag >= n)
-				{
-					passed++;
-					reduced_map.insert( std::make_pair(it->first,it->second) );
-				}
-
-			} 
-
+			if ( requirement(records[selection[i]]) )
+				selection[passed++] = selection[i];
 		}
+		selection.resize(passed);
 
 		// calculate efficiency
-		eff = (map_size == 0 ? 0.0 : static_cast<double>(passed) / map_size);
-		
-		// resize the map_lhco_taggedJets
-		map_lhco_taggedJets = reduced_map;
-
-		return eff;
+		return (total == 0 ? 0.0 : static_cast<double>(passed) / total);
 	}
 
-	double jet_analysis::require_t_or_w_tagged(const int & n)
+	double jet_analysis::require_fatjet_pt(const double & ptcut, const int & n)
 	{
-		std::map< event *, std::vector< fastjet::PseudoJet > >::iterator it;
-		std::map< event *, std::vector< fastjet::PseudoJet > > reduced_map;
-		int map_size = 0, passed = 0;
-		double eff;
-
-		for (it=map_lhco_taggedJets.begin(); it!=map_lhco_taggedJets.end(); ++it)
-		{
-			map_size++;
-			int twtag = 0;
-
-			if ((it->second).size() != 0)
-			{
-				for (unsigned int i = 0; i < (it->second).size(); ++i)
-				{
-					fastjet::PseudoJet tagged;
-					tagged = (it->second)[i];
+		tagged_fatjet_pt requirement(ptcut, n);
+		return require(requirement);
+	}
 
-					if ( tagged.user_info<TagInfo>().top_tag() || tagged.user_info<TagInfo>().w_tag() )
-						twtag++;
+	double jet_analysis::require_top_tagged(const int & n)
+	{
+		tagged_count requirement(n, true, false, false);
+		return require(requirement);
+	}
 
-				} 
+	double jet_analysis::require_higgs_tagged(const int & n)
+	{
+		tagged_count requirement(n, false, false, true);
+		return require(requirement);
+	}
 
-				if (twtag >= n)
-				{
-					passed++;
-					reduced_map.insert( std::make_pair(it->first,it->second) );
-				}
+	double jet_analysis::require_w_tagged(const int & n)
+	{
+		tagged_count requirement(n, false, true, false);
+		return require(requirement);
+	}
 
-			} 
+	double jet_analysis::require_t_or_w_tagged(const int & n)
+	{
+		tagged_count requirement(n, true, true, false);
+		return require(requirement);
+	}
+	
+	/* access the selected records */
 
-		} 
+	void jet_analysis::add_record(event *ev, const std::vector< fastjet::PseudoJet > & taggedJets)
+	{
+		tagged_event record;
+		record.ev = ev;
+		record.taggedJets = taggedJets;
+		records.push_back(record);
+		selection.push_back(records.size() - 1);
+	}
 
-		// calculate efficiency
-		eff = (map_size == 0 ? 0.0 : static_cast<double>(passed) / map_size);
-		
-		// resize the map_lhco_taggedJets
-		map_lhco_taggedJets = reduced_map;
+	// passes a record to the visitor of the streaming mode, the lhco event of rejected records is deleted
+	bool jet_analysis::visit_record(tagged_event & record)
+	{
+		std::lock_guard< std::mutex > lock(visitor_mutex);
+		if ( (*visitor)(record) )
+			return true;
+		delete record.ev;
+		record.ev = nullptr;
+		record.taggedJets.clear();
+		return false;
+	}
 
-		return eff;
+	unsigned int jet_analysis::nr_selected() const
+	{
+		return selection.size();
 	}
-	
-	/* extract lhco or fatjets from map */
 
-	std::vector< event * > jet_analysis::events()
+	const tagged_event & jet_analysis::selected(unsigned int i) const
 	{
-		// map_lhco_taggedJets iterator definition
-		std::map< event *, std::vector< fastjet::PseudoJet > >::iterator it;
+		return records[selection[i]];
+	}
 
-		// extract vector of event pointers "events"
-		std::vector< event * > events;
-		for (it=map_lhco_taggedJets.begin(); it!=map_lhco_taggedJets.end(); ++it)
-			events.push_back(it->first);
-			
-		return events;
+	tagged_view< event* > jet_analysis::events() const
+	{
+		return tagged_view< event* >(records, selection, &tagged_event::ev);
 	}
 	
-	std::vector< std::vector< fastjet::PseudoJet > > jet_analysis::fatjets()
+	tagged_view< std::vector< fastjet::PseudoJet > > jet_analysis::fatjets() const
 	{
-		// map_lhco_taggedJets iterator definition
-		std::map< event *, std::vector< fastjet::PseudoJet > >::iterator it;
-
-		// extract vector of event pointers "events"
-		std::vector< std::vector< fastjet::PseudoJet > > fatjets;
-		for (it=map_lhco_taggedJets.begin(); it!=map_lhco_taggedJets.end(); ++it)
-			fatjets.push_back(it->second);
-			
-		return fatjets;
+		return tagged_view< std::vector< fastjet::PseudoJet > >(records, selection, &tagged_event::taggedJets);
 	}
 
 
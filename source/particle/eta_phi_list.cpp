@@ -0,0 +1,59 @@
+/* Eta-phi list class
+ *
+ * Stores the eta (or rapidity) and phi of a group of objects in separate arrays,
+ * such that the squared deltaR of all pairs within a group or between two groups
+ * is computed in one vectorisable loop instead of one function call per pair.
+*/
+
+#include "eta_phi_list.h"
+
+
+/* NAMESPACE */
+namespace analysis
+{
+
+	/* pair kernels */
+
+	void eta_phi_list::delta_r2(std::vector<double> & dr2) const
+	{
+		unsigned int n = size();
+		dr2.resize(n * n);
+
+		// compute the upper triangle and mirror it, the diagonal vanishes
+		for (unsigned int i = 0; i < n; ++i)
+		{
+			dr2[i * n + i] = 0;
+			delta_r2_row(i, *this, i + 1, n, dr2.data() + i * n);
+			for (unsigned int j = i + 1; j < n; ++j)
+				dr2[j * n + i] = dr2[i * n + j];
+		}
+	}
+
+	void eta_phi_list::delta_r2(const eta_phi_list & other, std::vector<double> & dr2) const
+	{
+		unsigned int n = size();
+		unsigned int m = other.size();
+		dr2.resize(n * m);
+		for (unsigned int i = 0; i < n; ++i)
+			delta_r2_row(i, other, 0, m, dr2.data() + i * m);
+	}
+
+	void eta_phi_list::delta_r2_row(unsigned int i, const eta_phi_list & other, unsigned int j_begin, unsigned int j_end, double *row) const
+	{
+		// branch free inner loop over plain arrays, such that the compiler can vectorise it
+		const double eta0 = list_eta[i];
+		const double phi0 = list_phi[i];
+		const double *eta = other.list_eta.data();
+		const double *phi = other.list_phi.data();
+		const double twopi = 2 * M_PI;
+		for (unsigned int j = j_begin; j < j_end; ++j)
+		{
+			double deta = eta0 - eta[j];
+			double dphi = std::abs(phi0 - phi[j]);
+			dphi = std::min(dphi, twopi - dphi);
+			row[j] = deta * deta + dphi * dphi;
+		}
+	}
+
+/* NAMESPACE */
+}
@@ -0,0 +1,58 @@
+/* Eta-phi list class
+ *
+ * Stores the eta (or rapidity) and phi of a group of objects in separate arrays,
+ * such that the squared deltaR of all pairs within a group or between two groups
+ * is computed in one vectorisable loop instead of one function call per pair.
+*/
+
+#ifndef INC_ETA_PHI_LIST
+#define INC_ETA_PHI_LIST
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "particle.h"
+
+
+/* NAMESPACE */
+namespace analysis
+{
+
+	class eta_phi_list
+	{
+
+	public:
+
+		/* con & destructor */
+		eta_phi_list() {}
+
+		/* objects: phi is expected within one period, e.g. [-pi, pi] or [0, 2pi] */
+		void add(double eta, double phi) { list_eta.push_back(eta); list_phi.push_back(phi); }
+		void add(const particle *p) { add(p->eta(), p->phi()); }
+		void reserve(unsigned int n) { list_eta.reserve(n); list_phi.reserve(n); }
+		void clear() { list_eta.clear(); list_phi.clear(); }
+		unsigned int size() const { return list_eta.size(); }
+		double eta(unsigned int i) const { return list_eta[i]; }
+		double phi(unsigned int i) const { return list_phi[i]; }
+
+		/* squared deltaR of all pairs within the list, stored as [i * size() + j], and
+		   between this and another list, stored as [i * other.size() + j]; compare
+		   the results with squared thresholds */
+		void delta_r2(std::vector<double> & dr2) const;
+		void delta_r2(const eta_phi_list & other, std::vector<double> & dr2) const;
+
+	private:
+
+		/* squared deltaR of object i of this list with objects [j_begin, j_end) of other */
+		void delta_r2_row(unsigned int i, const eta_phi_list & other, unsigned int j_begin, unsigned int j_end, double *row) const;
+
+		std::vector<double> list_eta;
+		std::vector<double> list_phi;
+
+	};
+
+/* NAMESPACE */
+}
+
+#endif
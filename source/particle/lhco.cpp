@@ -149,5 +149,34 @@ namespace analysis
 		p_type = 1 << type;
 	}
 
+	void lhco::write_binary(std::ostream& os) const
+	{
+		// full precision of all lhco data members, used by caches
+		os.write(reinterpret_cast<const char*>(&p_type), sizeof(p_type));
+		os.write(reinterpret_cast<const char*>(&p_eta), sizeof(double));
+		os.write(reinterpret_cast<const char*>(&p_phi), sizeof(double));
+		os.write(reinterpret_cast<const char*>(&p_pt), sizeof(double));
+		os.write(reinterpret_cast<const char*>(&p_jmass), sizeof(double));
+		os.write(reinterpret_cast<const char*>(&p_ntrk), sizeof(double));
+		os.write(reinterpret_cast<const char*>(&p_btag), sizeof(double));
+		os.write(reinterpret_cast<const char*>(&p_hadem), sizeof(double));
+		os.write(reinterpret_cast<const char*>(&p_dum1), sizeof(double));
+		os.write(reinterpret_cast<const char*>(&p_dum2), sizeof(double));
+	}
+
+	void lhco::read_binary(std::istream& is)
+	{
+		is.read(reinterpret_cast<char*>(&p_type), sizeof(p_type));
+		is.read(reinterpret_cast<char*>(&p_eta), sizeof(double));
+		is.read(reinterpret_cast<char*>(&p_phi), sizeof(double));
+		is.read(reinterpret_cast<char*>(&p_pt), sizeof(double));
+		is.read(reinterpret_cast<char*>(&p_jmass), sizeof(double));
+		is.read(reinterpret_cast<char*>(&p_ntrk), sizeof(double));
+		is.read(reinterpret_cast<char*>(&p_btag), sizeof(double));
+		is.read(reinterpret_cast<char*>(&p_hadem), sizeof(double));
+		is.read(reinterpret_cast<char*>(&p_dum1), sizeof(double));
+		is.read(reinterpret_cast<char*>(&p_dum2), sizeof(double));
+	}
+
 /* NAMESPACE */
 }
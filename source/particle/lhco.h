@@ -67,6 +67,8 @@ namespace analysis
 		void read(std::ifstream& ifs);
 		void write(ogzstream& ogzs) const;
 		void read(igzstream& igzs);
+		void write_binary(std::ostream& os) const;
+		void read_binary(std::istream& is);
 
 	private:
 
@@ -112,13 +112,20 @@ namespace analysis
 	double delta_phi(const particle *p1, const particle *p2)
 	{
 		double dphi = std::abs(p1->phi() - p2->phi());
-		double twopi = 8 * std::atan(1);
-		return std::min(dphi, twopi - dphi);
+		return std::min(dphi, 2 * M_PI - dphi);
 	}
 	
 	double delta_r(const particle *p1, const particle *p2)
 	{
-		return std::sqrt(pow(delta_eta(p1, p2), 2.0) + pow(delta_phi(p1, p2), 2.0));
+		return std::sqrt(delta_r2(p1, p2));
+	}
+
+	// squared deltaR, to compare with squared thresholds
+	double delta_r2(const particle *p1, const particle *p2)
+	{
+		double deta = p1->eta() - p2->eta();
+		double dphi = delta_phi(p1, p2);
+		return deta * deta + dphi * dphi;
 	}
 
 /* NAMESPACE */
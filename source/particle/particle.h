@@ -122,6 +122,7 @@ namespace analysis
 	double delta_eta(const particle *p1, const particle *p2);
 	double delta_phi(const particle *p1, const particle *p2);
 	double delta_r(const particle *p1, const particle *p2);
+	double delta_r2(const particle *p1, const particle *p2);
 
 /* NAMESPACE */
 }
@@ -31,15 +31,71 @@ namespace analysis
 	
 	/* plot data */
 	
-	void plot::add_sample(const std::vector<event*> &events, plot_default *plot_imp, const std::string &name, double weight)
+	void plot::add_sample(const std::vector<event*> &events, plot_default *plot_imp, const std::string &name, double weight, cut *precondition)
 	{
-		std::vector<double> result;
+		// fill the histogram while evaluating the events
+		unsigned int sample = hist.new_sample(name, weight);
+		if (precondition)
+			precondition->prepare(events);
+		plot_imp->prepare(events);
 		for (unsigned int j = 0; j < events.size(); j++)
 		{
-			double res = (*plot_imp)(events[j]);
-			result.push_back(res);
+			if (precondition && !(*precondition)(events[j]))
+				continue;
+			hist.fill(sample, (*plot_imp)(events[j]));
 		}
-		hist.add_sample(result, name, weight);	
+	}
+
+	void plot::add_sample(const histogram_data &data, const std::string &name, double weight)
+	{
+		// binned data, e.g. merged from results files
+		hist.add_sample(data, name, weight);
+	}
+
+	unsigned int plot::new_sample(const std::string &name, double weight)
+	{
+		return hist.new_sample(name, weight);
+	}
+
+	void plot::fill(unsigned int sample, double value)
+	{
+		hist.fill(sample, value);
+	}
+
+	void plot::fill(unsigned int sample, const histogram_data &shard)
+	{
+		hist.fill(sample, shard);
+	}
+
+	bool plot::has_binning() const
+	{
+		return hist.has_binning();
+	}
+
+	histogram_data plot::binning() const
+	{
+		return hist.binning();
+	}
+
+	bool plot::has_range() const
+	{
+		return hist.has_range();
+	}
+
+	histogram plot::shard(unsigned int sample) const
+	{
+		return hist.shard(sample);
+	}
+
+	void plot::merge(unsigned int sample, const histogram &shard)
+	{
+		hist.merge(sample, shard);
+	}
+
+	const histogram_data & plot::data(unsigned int sample)
+	{
+		hist.fix_binning();
+		return hist.data(sample);
 	}
 
 	void plot::run()
@@ -50,6 +106,14 @@ namespace analysis
 		hist.draw();
 	}
 
+	void plot::run(render_queue &queue)
+	{
+		// set histogram title based on name
+		hist.set_title(plot_folder + plot_name);
+		// draw histograms later in the queue
+		queue.add(hist);
+	}
+
 	/* plot properties */
 
 	void plot::set_name(std::string n)
@@ -7,12 +7,16 @@
 #define INC_PLOT
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "boost/lexical_cast.hpp"
 
+#include "../cuts/cuts.h"
 #include "../event/event.h"
+#include "../event/observables.h"
 #include "../histogram/histogram.h"
+#include "../histogram/render_queue.h"
 
 
 /* NAMESPACE */
@@ -31,6 +35,9 @@ namespace analysis
 		// all cuts are based on this class and should overload this
 		// operator, and return true for events that pass the cuts
 		virtual double operator() (const event *ev) { return 0; }
+		// called with all events of a sample before they are plotted, plots 
+		// which are faster for a whole sample can precompute their values here
+		virtual void prepare(const std::vector<event*> &events) {}
 	
 	};
 
@@ -44,9 +51,27 @@ namespace analysis
 		plot(std::string name = "", std::string folder = "");
 		~plot();
 
-		/* plot data */
-		void add_sample(const std::vector<event*> &events, plot_default *plot_imp, const std::string &name = "", double weight = 1);
+		/* plot data: only events passing the precondition are filled (all events if null),
+		   the weight is not rescaled for the skipped events */
+		void add_sample(const std::vector<event*> &events, plot_default *plot_imp, const std::string &name = "", double weight = 1, cut *precondition = nullptr);
+		void add_sample(const histogram_data &data, const std::string &name = "", double weight = 1);
 		void run(); 
+		void run(render_queue &queue);
+
+		/* online filling of samples, e.g. from per-thread shards */
+		unsigned int new_sample(const std::string &name = "", double weight = 1);
+		void fill(unsigned int sample, double value);
+		void fill(unsigned int sample, const histogram_data &shard);
+		bool has_binning() const;
+		histogram_data binning() const;
+
+		/* online filling with the automatic range after the warm-up, e.g. from per-thread shards */
+		bool has_range() const;
+		histogram shard(unsigned int sample) const;
+		void merge(unsigned int sample, const histogram &shard);
+
+		/* binned data of a sample, e.g. to store it in results: fixes the automatic range */
+		const histogram_data & data(unsigned int sample);
 		
 		/* plot properties */
 		void set_name(std::string n);
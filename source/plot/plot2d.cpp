@@ -33,15 +33,16 @@ namespace analysis
 
 	void plot2d::add_sample(const std::vector<event*> &events, const std::string &name, double weight)
 	{
-		std::vector< std::vector<double> > result;
+		if (!x_ftor || !y_ftor)
+			return;
+		x_ftor->prepare(events);
+		y_ftor->prepare(events);
 		for (unsigned int j = 0; j < events.size(); j++)
 		{
 			event *ev = events[j];
-			// use ftor's to get the plot data
-			if (!!x_ftor && !!y_ftor)
-				result.push_back({(*x_ftor)(ev), (*y_ftor)(ev)});
+			// use ftor's to get the plot data and fill the histogram directly
+			hist.fill((*x_ftor)(ev), (*y_ftor)(ev));
 		}
-		hist.add_sample_xy(result);	
 	}
 
 	void plot2d::run()
@@ -52,6 +53,14 @@ namespace analysis
 		hist.draw();
 	}
 
+	void plot2d::run(render_queue &queue)
+	{
+		// set histogram title based on name
+		hist.set_title(plot_folder + plot_name);
+		// draw histograms later in the queue
+		queue.add(hist);
+	}
+
 	/* plot properties */
 
 	void plot2d::set_name(std::string n)
@@ -13,6 +13,7 @@
 
 #include "../event/event.h"
 #include "../histogram/histogram2D.h"
+#include "../histogram/render_queue.h"
 #include "../plot/plot.h"
 
 
@@ -33,6 +34,7 @@ namespace analysis
 		/* plot data */
 		void add_sample(const std::vector<event*> &events, const std::string &name = "", double weight = 1);
 		void run(); 
+		void run(render_queue &queue);
 		
 		/* plot properties */
 		std::string name() const;
@@ -8,143 +8,119 @@
 namespace analysis
 {
 
-	/* plot: pt */
-	class plot_pt : public plot_default
+	/* plot: observable */
+	class plot_observable : public plot_default
 	{
 	public:
-		plot_pt(unsigned int t, unsigned int n, double eta = 5.0) : type(t), number(n), eta_max(eta) {}
+		plot_observable(observables &obs, const std::string &name) : list(obs), handle(obs.handle(name)) {}
+		plot_observable(observables &obs, unsigned int h) : list(obs), handle(h) {}
+
+		void prepare(const std::vector<event*> &events)
+		{
+			list.prepare(events);
+		}
 
 		double operator() (const event *ev) 
 		{ 
-			particle *p = ev->get(type, number, eta_max);
-			if (p)
-				return p->pt();
-			return 0;
+			return list.value(ev, handle);
 		}
 
 	private:
-		unsigned int type;
-		unsigned int number;
-		double eta_max;
+		observables &list;
+		unsigned int handle;
+	};
+
+	/* plot: pt */
+	class plot_pt : public plot_observable
+	{
+	public:
+		plot_pt(unsigned int t, unsigned int n, double eta = 5.0, observables &obs = default_observables()) :
+			plot_observable(obs, add_pt(obs, t, n, eta)) {}
 	};
 	
 	/* plot: eta */
-	class plot_eta : public plot_default
+	class plot_eta : public plot_observable
 	{
 	public:
-		plot_eta(unsigned int t, unsigned int n) : type(t), number(n) {}
-
-		double operator() (const event *ev) 
-		{ 
-			particle *p = ev->get(type, number);
-			if (p)
-				return p->eta();
-			return 0;
-		}
-
-	private:
-		unsigned int type;
-		unsigned int number;
+		plot_eta(unsigned int t, unsigned int n, observables &obs = default_observables()) :
+			plot_observable(obs, add_eta(obs, t, n)) {}
 	};
 	
 	/* plot: phi */
-	class plot_phi : public plot_default
+	class plot_phi : public plot_observable
 	{
 	public:
-		plot_phi(unsigned int t, unsigned int n) : type(t), number(n) {}
-
-		double operator() (const event *ev) 
-		{ 
-			particle *p = ev->get(type, number);
-			if (p)
-				return p->phi();
-			return 0;
-		}
-
-	private:
-		unsigned int type;
-		unsigned int number;
+		plot_phi(unsigned int t, unsigned int n, observables &obs = default_observables()) :
+			plot_observable(obs, add_phi(obs, t, n)) {}
 	};
 	
-	/* cut: delta pt */
-	class plot_deltapt : public plot_default
+	/* plot: delta pt, 0 if one of the particles is missing */
+	class plot_deltapt : public plot_observable
 	{
 	public:
-		plot_deltapt(unsigned int t1, unsigned int n1, unsigned int t2, unsigned int n2, double eta = 5.0) :
-			type1(t1), number1(n1), type2(t2), number2(n2), eta_max(eta) {}
-
-		double operator() (const event *ev) 
-		{ 
-			particle *p1 = ev->get(type1, number1, eta_max);
-			particle *p2 = ev->get(type2, number2, eta_max);
-			if (p1 && p2)
-				return p1->pt() - p2->pt();
-			return 0;
-		}
-
-	private:
-		unsigned int type1;
-		unsigned int type2;
-		unsigned int number1;
-		unsigned int number2;
-		double eta_max;
+		plot_deltapt(unsigned int t1, unsigned int n1, unsigned int t2, unsigned int n2, double eta = 5.0, observables &obs = default_observables()) :
+			plot_observable(obs, obs.add(observable_name("deltapt", {static_cast<double>(t1), static_cast<double>(n1), static_cast<double>(t2), static_cast<double>(n2), eta}),
+				[t1, n1, t2, n2, eta](const event *ev)
+				{
+					const particle *p1 = ev->get(t1, n1, eta);
+					const particle *p2 = ev->get(t2, n2, eta);
+					if (p1 && p2)
+						return p1->pt() - p2->pt();
+					return 0.0;
+				})) {}
 	};
 	
 	/* plot: met */
-	class plot_met : public plot_default
+	class plot_met : public plot_observable
 	{
 	public:
-		plot_met() {}
-
-		double operator() (const event *ev) 
-		{ 
-			return ev->met();
-		}
+		plot_met(observables &obs = default_observables()) : plot_observable(obs, add_met(obs)) {}
 	};
 	
 	/* plot: ht */
-	class plot_ht : public plot_default
+	class plot_ht : public plot_observable
 	{
 	public:
-		plot_ht(unsigned int t, double pt = 0.0, double eta = 5.0) : type(t), min_pt(pt), max_eta(eta) {};
-		
-		double operator() (const event *ev) 
-		{ 
-			return ev->ht(type, min_pt, max_eta);
-		};
-
-	private:
-		unsigned int type;
-		double min_pt;
-		double max_eta;
+		plot_ht(unsigned int t, double pt = 0.0, double eta = 5.0, observables &obs = default_observables()) :
+			plot_observable(obs, add_ht(obs, t, pt, eta)) {};
 	};
 
 	/* plot: mass */
-	class plot_mass : public plot_default
+	class plot_mass : public plot_observable
 	{
 	public:
-		plot_mass(int t, const std::vector<int> & c) : type(t), comb(c) {}
-
-		double operator() (const event *ev) 
-		{ 
-			ev->mass(type, comb);
-		}
-
-	private:
-		int type;
-		std::vector<int> comb;
+		plot_mass(int t, const std::vector<int> & c, observables &obs = default_observables()) :
+			plot_observable(obs, add_mass(obs, t, c)) {}
 	};
 
 	/* plot: mt2 */
 	class plot_mt2 : public plot_default
 	{
 	public:
-		plot_mt2() {}
+		plot_mt2(double mn = 0, int workers = 1) : mt2_mn(mn), mt2_workers(workers) {}
+
+		void prepare(const std::vector<event*> &events)
+		{
+			// mt2 of the whole sample in one batch, keyed by the event id such that freed or
+			// changed events are never confused with the prepared ones
+			std::vector<double> values = mt2_events(events, std::vector<double>(1, mt2_mn), mt2_workers);
+			mt2_values.clear();
+			for (unsigned int i = 0; i < events.size(); ++i)
+				mt2_values[events[i]->id()] = values[i];
+		}
 
 		double operator() (const event *ev) 
 		{ 
-			return ev->mt2();
+			std::unordered_map<unsigned long long, double>::const_iterator it = mt2_values.find(ev->id());
+			if (it != mt2_values.end())
+				return it->second;
+			return ev->mt2(mt2_mn);
 		}
+
+	private:
+		double mt2_mn;
+		int mt2_workers;
+		std::unordered_map<unsigned long long, double> mt2_values;
 	};
 
 /* NAMESPACE */
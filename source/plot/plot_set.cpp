@@ -0,0 +1,188 @@
+/* Plot set class
+ *
+ * Collects many plots, each with an optional precondition on the events, and
+ * fills all of them in a single (parallel) traversal of a sample.
+*/
+
+#include "plot_set.h"
+
+
+/* NAMESPACE */
+namespace analysis
+{
+
+	/* con & destructor */
+
+	plot_set::plot_set(std::string folder)
+	{
+		plot_folder = folder;
+		total_events = 0;
+	}
+
+	plot_set::~plot_set()
+	{
+		for (unsigned int i = 0; i < plots.size(); ++i)
+			delete plots[i];
+
+		// the functors and preconditions are owned, each is deleted once even if shared by several plots
+		std::vector<plot_default*> owned_imps(plot_imps);
+		std::sort(owned_imps.begin(), owned_imps.end());
+		owned_imps.erase(std::unique(owned_imps.begin(), owned_imps.end()), owned_imps.end());
+		for (unsigned int i = 0; i < owned_imps.size(); ++i)
+			delete owned_imps[i];
+		std::vector<cut*> owned_preconditions(preconditions);
+		std::sort(owned_preconditions.begin(), owned_preconditions.end());
+		owned_preconditions.erase(std::unique(owned_preconditions.begin(), owned_preconditions.end()), owned_preconditions.end());
+		for (unsigned int i = 0; i < owned_preconditions.size(); ++i)
+			delete owned_preconditions[i];
+	}
+
+	/* plots */
+
+	plot & plot_set::add_plot(const std::string &name, plot_default *plot_imp, cut *precondition)
+	{
+		plots.push_back(new plot(name, plot_folder));
+		plot_names.push_back(name);
+		plot_imps.push_back(plot_imp);
+		preconditions.push_back(precondition);
+		plot_events.push_back(0);
+		return *plots.back();
+	}
+
+	unsigned int plot_set::size() const
+	{
+		return plots.size();
+	}
+
+	plot & plot_set::operator[] (unsigned int n)
+	{
+		return *plots[n];
+	}
+
+	/* plot data */
+
+	void plot_set::add_sample(const std::vector<event*> &events, const std::string &name, double weight, int workers)
+	{
+		unsigned int nr_plots = plots.size();
+		std::vector<unsigned int> samples(nr_plots);
+		for (unsigned int p = 0; p < nr_plots; ++p)
+		{
+			samples[p] = plots[p]->new_sample(name, weight);
+			plot_imps[p]->prepare(events);
+			if (preconditions[p])
+				preconditions[p]->prepare(events);
+		}
+
+		// the automatic range of a plot is fixed after the warm-up of its histogram, for which
+		// it fills the first events in event order until it knows its range
+		total_events = events.size();
+		for (unsigned int p = 0; p < nr_plots; ++p)
+			plot_events[p] = 0;
+		auto has_ranges = [this, nr_plots]()
+		{
+			for (unsigned int p = 0; p < nr_plots; ++p)
+				if (!plots[p]->has_range())
+					return false;
+			return true;
+		};
+		std::vector<unsigned int> plot_start(nr_plots, 0);
+		for (unsigned int i = 0; i < events.size() && !has_ranges(); ++i)
+		{
+			const event *ev = events[i];
+			for (unsigned int p = 0; p < nr_plots; ++p)
+			{
+				if (plots[p]->has_range())
+					continue;
+				plot_start[p] = i + 1;
+				if (preconditions[p] && !(*preconditions[p])(ev))
+					continue;
+				plots[p]->fill(samples[p], (*plot_imps[p])(ev));
+				plot_events[p]++;
+			}
+		}
+
+		// the remaining events of each plot are filled in per-worker shards: plots with a fixed
+		// binning in histogram data, the others in histograms on the grid of their range, which
+		// is widened while filling; the mode of a plot is kept for the sample
+		std::vector<bool> binned(nr_plots), ranged(nr_plots);
+		for (unsigned int p = 0; p < nr_plots; ++p)
+		{
+			binned[p] = plots[p]->has_binning();
+			ranged[p] = plots[p]->has_range();
+		}
+
+		// each worker handles a contiguous range of the events
+		unsigned int nr_workers = std::max(1, std::min<int>(workers, events.size()));
+		unsigned int range = (events.size() + nr_workers - 1) / nr_workers;
+		std::vector< std::vector<histogram_data> > shards(nr_workers);
+		std::vector< std::vector<histogram> > range_shards(nr_workers);
+		std::vector< std::vector<unsigned int> > counts(nr_workers, std::vector<unsigned int>(nr_plots, 0));
+		for (unsigned int w = 0; w < nr_workers; ++w)
+		{
+			for (unsigned int p = 0; p < nr_plots; ++p)
+			{
+				shards[w].push_back(binned[p] ? plots[p]->binning() : histogram_data());
+				range_shards[w].push_back(!binned[p] && ranged[p] ? plots[p]->shard(samples[p]) : histogram());
+			}
+		}
+
+		auto fill_range = [&](unsigned int w)
+		{
+			unsigned int end = std::min<unsigned int>(events.size(), (w + 1) * range);
+			for (unsigned int i = w * range; i < end; ++i)
+			{
+				const event *ev = events[i];
+				for (unsigned int p = 0; p < nr_plots; ++p)
+				{
+					if (i < plot_start[p] || (preconditions[p] && !(*preconditions[p])(ev)))
+						continue;
+					double value = (*plot_imps[p])(ev);
+					if (binned[p])
+						shards[w][p].fill(value, weight);
+					else
+						range_shards[w][p].fill(0, value);
+					counts[w][p]++;
+				}
+			}
+		};
+		std::vector<std::thread> threads;
+		for (unsigned int w = 1; w < nr_workers; ++w)
+			threads.push_back(std::thread(fill_range, w));
+		fill_range(0);
+		for (unsigned int t = 0; t < threads.size(); ++t)
+			threads[t].join();
+
+		// merge the workers in order
+		for (unsigned int p = 0; p < nr_plots; ++p)
+		{
+			for (unsigned int w = 0; w < nr_workers; ++w)
+			{
+				if (binned[p])
+					plots[p]->fill(samples[p], shards[w][p]);
+				else if (ranged[p])
+					plots[p]->merge(samples[p], range_shards[w][p]);
+				plot_events[p] += counts[w][p];
+			}
+		}
+	}
+
+	void plot_set::run()
+	{
+		for (unsigned int p = 0; p < plots.size(); ++p)
+			plots[p]->run();
+	}
+
+	void plot_set::run(render_queue &queue)
+	{
+		for (unsigned int p = 0; p < plots.size(); ++p)
+			plots[p]->run(queue);
+	}
+
+	void plot_set::write(std::ostream &os) const
+	{
+		for (unsigned int p = 0; p < plots.size(); ++p)
+			os << "plot: " << plot_names[p] << " -> " << plot_events[p] << " of " << total_events << " events" << std::endl;
+	}
+
+/* NAMESPACE */
+}
@@ -0,0 +1,70 @@
+/* Plot set class
+ *
+ * Collects many plots, each with an optional precondition on the events, and
+ * fills all of them in a single (parallel) traversal of a sample.
+*/
+
+#ifndef INC_PLOT_SET
+#define INC_PLOT_SET
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../cuts/cuts.h"
+#include "../event/event.h"
+#include "../histogram/histogram.h"
+#include "../histogram/histogram_data.h"
+#include "plot.h"
+
+
+/* NAMESPACE */
+namespace analysis
+{
+
+	class plot_set
+	{
+
+	public:
+	
+		/* con & destructor: not copyable, since it owns its plots */
+		plot_set(std::string folder = "");
+		plot_set(const plot_set&) = delete;
+		plot_set & operator=(const plot_set&) = delete;
+		~plot_set();
+
+		/* register a plot of the functor for events passing the precondition (all events if null),
+		   the returned plot can be used to set its properties; the plot set takes ownership of
+		   the functor and the precondition, which may be shared by several plots */
+		plot & add_plot(const std::string &name, plot_default *plot_imp, cut *precondition = nullptr);
+		unsigned int size() const;
+		plot & operator[] (unsigned int n);
+
+		/* fill all plots in one traversal: with several workers the functors and preconditions 
+		   are evaluated concurrently on different events and filled in per-worker shards, plots
+		   with automatic range fill the first events in event order until their range is fixed */
+		void add_sample(const std::vector<event*> &events, const std::string &name = "", double weight = 1, int workers = 1);
+		void run();
+		void run(render_queue &queue);
+
+		/* number of events per plot in the last sample */
+		void write(std::ostream &os) const;
+
+	private:
+
+		std::string plot_folder;
+		std::vector<plot*> plots;
+		std::vector<std::string> plot_names;
+		std::vector<plot_default*> plot_imps;
+		std::vector<cut*> preconditions;
+		std::vector<unsigned int> plot_events;
+		unsigned int total_events;
+
+	};
+	
+/* NAMESPACE */
+}
+
+#endif
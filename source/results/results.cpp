@@ -0,0 +1,281 @@
+/* Results class
+ *
+ * Collects the partial results of an analysis job, binned histogram data
+ * and cut & count counters stored by name, in a compact binary file. The
+ * results of independent jobs are merged into the total result. Histograms
+ * are merged bin by bin, so all jobs have to fill them with the same fixed 
+ * binning, e.g. from histogram::binning() with set_range or set_bins.
+*/
+
+#include <fstream>
+
+#include "results.h"
+
+
+/* NAMESPACE */
+namespace analysis
+{
+
+	// magic and version of the binary results format, increase when the layout changes
+	const char results_magic[9] = "MCRESULT";
+	const unsigned int results_version = 1;
+
+	// upper bound of the names read from a file, such that corrupt files are 
+	// rejected instead of allocated
+	const unsigned int max_name_size = 4096;
+
+	// type identifiers of the stored results
+	enum results_type : char
+	{
+		RESULTS_HISTOGRAM = 'h',
+		RESULTS_HISTOGRAM2D = 'H',
+		RESULTS_CUTS = 'c'
+	};
+
+	/* adding results */
+
+	void results::add(const std::string & name, const histogram_data & data)
+	{
+		std::map<std::string, histogram_data>::iterator it = list_hist.find(name);
+		if (it == list_hist.end())
+			list_hist.insert(std::make_pair(name, data));
+		else
+			it->second.merge(data);
+	}
+
+	void results::add(const std::string & name, const histogram2D_data & data)
+	{
+		std::map<std::string, histogram2D_data>::iterator it = list_hist2D.find(name);
+		if (it == list_hist2D.end())
+			list_hist2D.insert(std::make_pair(name, data));
+		else
+			it->second.merge(data);
+	}
+
+	void results::add(const std::string & name, const cuts & counters)
+	{
+		// only the counters are stored, such that the results do not depend on the cut objects
+		list_cuts[name].merge(counters);
+	}
+
+	void results::merge(const results & other)
+	{
+		for (std::map<std::string, histogram_data>::const_iterator it = other.list_hist.begin(); it != other.list_hist.end(); ++it)
+			add(it->first, it->second);
+		for (std::map<std::string, histogram2D_data>::const_iterator it = other.list_hist2D.begin(); it != other.list_hist2D.end(); ++it)
+			add(it->first, it->second);
+		for (std::map<std::string, cuts>::const_iterator it = other.list_cuts.begin(); it != other.list_cuts.end(); ++it)
+			add(it->first, it->second);
+	}
+
+	// results with the same name need the same binning or cuts
+	bool results::can_merge(const results & other) const
+	{
+		for (std::map<std::string, histogram_data>::const_iterator it = other.list_hist.begin(); it != other.list_hist.end(); ++it)
+		{
+			std::map<std::string, histogram_data>::const_iterator match = list_hist.find(it->first);
+			if (match != list_hist.end() && match->second.axis() != it->second.axis())
+				return false;
+		}
+		for (std::map<std::string, histogram2D_data>::const_iterator it = other.list_hist2D.begin(); it != other.list_hist2D.end(); ++it)
+		{
+			std::map<std::string, histogram2D_data>::const_iterator match = list_hist2D.find(it->first);
+			if (match != list_hist2D.end() && (match->second.x_axis() != it->second.x_axis() || match->second.y_axis() != it->second.y_axis()))
+				return false;
+		}
+		for (std::map<std::string, cuts>::const_iterator it = other.list_cuts.begin(); it != other.list_cuts.end(); ++it)
+		{
+			std::map<std::string, cuts>::const_iterator match = list_cuts.find(it->first);
+			if (match != list_cuts.end() && !match->second.can_merge(it->second))
+				return false;
+		}
+		return true;
+	}
+
+	void results::clear()
+	{
+		list_hist.clear();
+		list_hist2D.clear();
+		list_cuts.clear();
+	}
+
+	/* accessing results */
+
+	const histogram_data & results::get_histogram(const std::string & name) const
+	{
+		std::map<std::string, histogram_data>::const_iterator it = list_hist.find(name);
+		if (it == list_hist.end())
+		{
+			std::cout << "Error: no histogram " << name << " in the results." << std::endl;
+			exit (EXIT_FAILURE);
+		}
+		return it->second;
+	}
+
+	const histogram2D_data & results::get_histogram2D(const std::string & name) const
+	{
+		std::map<std::string, histogram2D_data>::const_iterator it = list_hist2D.find(name);
+		if (it == list_hist2D.end())
+		{
+			std::cout << "Error: no 2D histogram " << name << " in the results." << std::endl;
+			exit (EXIT_FAILURE);
+		}
+		return it->second;
+	}
+
+	const cuts & results::get_cuts(const std::string & name) const
+	{
+		std::map<std::string, cuts>::const_iterator it = list_cuts.find(name);
+		if (it == list_cuts.end())
+		{
+			std::cout << "Error: no cuts " << name << " in the results." << std::endl;
+			exit (EXIT_FAILURE);
+		}
+		return it->second;
+	}
+
+	/* input & output */
+
+	void results::write(const std::string & file) const
+	{
+		std::ofstream ofs(file.c_str(), std::ios::binary);
+		if (ofs.is_open())
+			write_binary(ofs);
+		ofs.close();
+		if (!ofs)
+		{
+			std::cout << "Error: could not write results to " << file << std::endl;
+			exit (EXIT_FAILURE);
+		}
+	}
+
+	bool results::read(const std::string & file)
+	{
+		std::ifstream ifs(file.c_str(), std::ios::binary);
+		if (!ifs.is_open())
+		{
+			std::cout << "Warning: could not open results file " << file << std::endl;
+			return false;
+		}
+		if (!read_binary(ifs))
+		{
+			std::cout << "Warning: results file " << file << " is invalid, incomplete or does not match the results." << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	// write a single named entry of the given type
+	static void write_entry_header(std::ostream & os, char type, const std::string & name)
+	{
+		unsigned int name_size = name.size();
+		os.write(&type, sizeof(type));
+		os.write(reinterpret_cast<const char*>(&name_size), sizeof(name_size));
+		os.write(name.data(), name_size);
+	}
+
+	void results::write_binary(std::ostream & os) const
+	{
+		unsigned int nr_entries = size();
+		os.write(results_magic, sizeof(results_magic) - 1);
+		os.write(reinterpret_cast<const char*>(&results_version), sizeof(results_version));
+		os.write(reinterpret_cast<const char*>(&nr_entries), sizeof(nr_entries));
+		for (std::map<std::string, histogram_data>::const_iterator it = list_hist.begin(); it != list_hist.end(); ++it)
+		{
+			write_entry_header(os, RESULTS_HISTOGRAM, it->first);
+			it->second.write_binary(os);
+		}
+		for (std::map<std::string, histogram2D_data>::const_iterator it = list_hist2D.begin(); it != list_hist2D.end(); ++it)
+		{
+			write_entry_header(os, RESULTS_HISTOGRAM2D, it->first);
+			it->second.write_binary(os);
+		}
+		for (std::map<std::string, cuts>::const_iterator it = list_cuts.begin(); it != list_cuts.end(); ++it)
+		{
+			write_entry_header(os, RESULTS_CUTS, it->first);
+			it->second.write_binary(os);
+		}
+	}
+
+	bool results::read_binary(std::istream & is)
+	{
+		// check the magic and version
+		char magic[sizeof(results_magic) - 1];
+		unsigned int version = 0, nr_entries = 0;
+		is.read(magic, sizeof(magic));
+		is.read(reinterpret_cast<char*>(&version), sizeof(version));
+		is.read(reinterpret_cast<char*>(&nr_entries), sizeof(nr_entries));
+		if (!is || std::string(magic, sizeof(magic)) != results_magic || version != results_version)
+			return false;
+
+		// read into a temporary, which is only merged when complete and compatible, 
+		// names are unique within a file
+		results read;
+		for (unsigned int i = 0; i < nr_entries; ++i)
+		{
+			char type = 0;
+			unsigned int name_size = 0;
+			is.read(&type, sizeof(type));
+			is.read(reinterpret_cast<char*>(&name_size), sizeof(name_size));
+			if (!is || name_size > max_name_size)
+				return false;
+			std::string name(name_size, ' ');
+			if (name_size > 0)
+				is.read(&name[0], name_size);
+			if (!is)
+				return false;
+
+			if (type == RESULTS_HISTOGRAM)
+			{
+				histogram_data data;
+				if (!data.read_binary(is) || read.has_histogram(name))
+					return false;
+				read.add(name, data);
+			}
+			else if (type == RESULTS_HISTOGRAM2D)
+			{
+				histogram2D_data data;
+				if (!data.read_binary(is) || read.has_histogram2D(name))
+					return false;
+				read.add(name, data);
+			}
+			else if (type == RESULTS_CUTS)
+			{
+				cuts counters;
+				if (!counters.read_binary(is) || read.has_cuts(name))
+					return false;
+				read.add(name, counters);
+			}
+			else
+				return false;
+		}
+		if (!can_merge(read))
+			return false;
+		merge(read);
+		return true;
+	}
+
+	void results::print(std::ostream & os) const
+	{
+		for (std::map<std::string, histogram_data>::const_iterator it = list_hist.begin(); it != list_hist.end(); ++it)
+		{
+			const histogram_axis & axis = it->second.axis();
+			os << "histogram: " << it->first << " -> " << axis.nr_bins() << " bins in [" << axis.lower_edge(1) << ", " << axis.upper_edge(axis.nr_bins()) << "]";
+			os << ", entries: " << it->second.entries() << ", integral: " << it->second.integral() << std::endl;
+		}
+		for (std::map<std::string, histogram2D_data>::const_iterator it = list_hist2D.begin(); it != list_hist2D.end(); ++it)
+		{
+			const histogram_axis & x_axis = it->second.x_axis();
+			const histogram_axis & y_axis = it->second.y_axis();
+			os << "histogram2D: " << it->first << " -> " << x_axis.nr_bins() << "x" << y_axis.nr_bins() << " bins";
+			os << ", entries: " << it->second.entries() << std::endl;
+		}
+		for (std::map<std::string, cuts>::const_iterator it = list_cuts.begin(); it != list_cuts.end(); ++it)
+		{
+			os << "cuts: " << it->first << std::endl;
+			it->second.write(os);
+		}
+	}
+
+/* NAMESPACE */
+}
@@ -0,0 +1,64 @@
+/* Results class
+ *
+ * Collects the partial results of an analysis job, binned histogram data
+ * and cut & count counters stored by name, in a compact binary file. The
+ * results of independent jobs are merged into the total result. Histograms
+ * are merged bin by bin, so all jobs have to fill them with the same fixed 
+ * binning, e.g. from histogram::binning() with set_range or set_bins.
+*/
+
+#ifndef INC_RESULTS
+#define INC_RESULTS
+
+#include <iostream>
+#include <map>
+#include <string>
+
+#include "../cuts/cuts.h"
+#include "../histogram/histogram_data.h"
+
+
+/* NAMESPACE */
+namespace analysis
+{
+
+	class results
+	{
+
+	public:
+
+		/* adding results: results with the same name are merged */
+		void add(const std::string & name, const histogram_data & data);
+		void add(const std::string & name, const histogram2D_data & data);
+		void add(const std::string & name, const cuts & counters);
+		void merge(const results & other);
+		bool can_merge(const results & other) const;
+		void clear();
+
+		/* accessing results */
+		bool has_histogram(const std::string & name) const { return list_hist.count(name) > 0; }
+		bool has_histogram2D(const std::string & name) const { return list_hist2D.count(name) > 0; }
+		bool has_cuts(const std::string & name) const { return list_cuts.count(name) > 0; }
+		const histogram_data & get_histogram(const std::string & name) const;
+		const histogram2D_data & get_histogram2D(const std::string & name) const;
+		const cuts & get_cuts(const std::string & name) const;
+		unsigned int size() const { return list_hist.size() + list_hist2D.size() + list_cuts.size(); }
+
+		/* input & output */
+		void write(const std::string & file) const;
+		bool read(const std::string & file);
+		void write_binary(std::ostream & os) const;
+		bool read_binary(std::istream & is);
+		void print(std::ostream & os) const;
+
+	private:
+		std::map<std::string, histogram_data> list_hist;
+		std::map<std::string, histogram2D_data> list_hist2D;
+		std::map<std::string, cuts> list_cuts;
+
+	};
+
+/* NAMESPACE */
+}
+
+#endif
@@ -3,6 +3,8 @@
  * Provides useful functions for file handling
 */
 
+#include <iomanip>
+
 #include "utility.h"
 
 
@@ -151,7 +153,7 @@ namespace analysis
 			for (unsigned int i = 0; i < ev->size(); i++)
 			{
 				file_ogz << i + 1 << "\t";
-				particle *p = (*ev)[i];
+				const particle *p = (*ev)[i];
 				p->write(file_ogz);
 			}
 		}
@@ -218,7 +220,7 @@ namespace analysis
 			// loop over all particles
 			for (unsigned int i = 0; i < ev->size(); i++)
 			{
-				particle *p = (*ev)[i];
+				const particle *p = (*ev)[i];
 				p->write(file_ogz);
 			}
 			file_ogz << "</event>" << std::endl;
@@ -250,5 +252,66 @@ namespace analysis
 		return;
 	}
 
+	// returns a 64-bit FNV-1a hash of the file contents, continuing from a previous hash
+	unsigned long long hash_file(boost::filesystem::path file, unsigned long long hash)
+	{
+		std::ifstream ifs(file.string().c_str(), std::ios::binary);
+		std::vector<char> buffer(1 << 16);
+		while (ifs)
+		{
+			ifs.read(&buffer[0], buffer.size());
+			std::streamsize nr_read = ifs.gcount();
+			for (std::streamsize i = 0; i < nr_read; ++i)
+			{
+				hash ^= static_cast<unsigned char>(buffer[i]);
+				hash *= 1099511628211ULL;
+			}
+		}
+		return hash;
+	}
+
+	unsigned long long hash_string(const std::string & text, unsigned long long hash)
+	{
+		for (unsigned int i = 0; i < text.size(); ++i)
+		{
+			hash ^= static_cast<unsigned char>(text[i]);
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	bool read_xsec_estimate(boost::filesystem::path file, const std::string & key, double & xsec, double & naccept)
+	{
+		std::ifstream ifs(file.string().c_str());
+		if (!ifs.is_open())
+			return false;
+
+		// the key is stored on the first lines, followed by the estimate
+		std::string stored_key(key.size(), ' ');
+		ifs.read(&stored_key[0], key.size());
+		if (!ifs || stored_key != key)
+			return false;
+		ifs >> xsec >> naccept;
+		return !ifs.fail();
+	}
+
+	void write_xsec_estimate(boost::filesystem::path file, const std::string & key, const double & xsec, const double & naccept)
+	{
+		// write to a temporary file first, such that concurrent runs never read incomplete estimates
+		boost::system::error_code ec;
+		boost::filesystem::create_directories(file.parent_path(), ec);
+		boost::filesystem::path tmp_file = file.string() + ".tmp";
+		std::ofstream ofs(tmp_file.string().c_str());
+		ofs << key << std::setprecision(17) << xsec << " " << naccept << std::endl;
+		ofs.close();
+		if (!ofs)
+		{
+			std::cout << "Warning: could not write cross section estimate " << file.string() << std::endl;
+			boost::filesystem::remove(tmp_file, ec);
+			return;
+		}
+		boost::filesystem::rename(tmp_file, file, ec);
+	}
+
 /* NAMESPACE */
 }
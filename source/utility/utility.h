@@ -42,10 +42,26 @@ namespace analysis
 	// read the events dependent on the file type
 	void read_events(std::vector<event*> & events, boost::filesystem::path file);
 
+	// returns a 64-bit FNV-1a hash of the file contents, continuing from a previous hash
+	unsigned long long hash_file(boost::filesystem::path file, unsigned long long hash = 14695981039346656037ULL);
+
+	// returns a 64-bit FNV-1a hash of a string, continuing from a previous hash
+	unsigned long long hash_string(const std::string & text, unsigned long long hash = 14695981039346656037ULL);
+
+	// reads a merging cross section estimate from a file, only if it was stored under the same key
+	bool read_xsec_estimate(boost::filesystem::path file, const std::string & key, double & xsec, double & naccept);
+
+	// writes a merging cross section estimate together with its key into a file
+	void write_xsec_estimate(boost::filesystem::path file, const std::string & key, const double & xsec, const double & naccept);
+
 	// read a single setting from a file
 	template <typename Type>
 	Type read_settings(std::string settings_file, std::string identifier);
 
+	// read a single setting from a file, or the default if it is not set
+	template <typename Type>
+	Type read_settings(std::string settings_file, std::string identifier, const Type & default_value);
+
 	// read a list of settings from a file
 	template <typename Type>
 	std::vector<Type> read_settings_list(std::string settings_file, std::string identifier);
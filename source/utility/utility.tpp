@@ -11,11 +11,18 @@ namespace analysis
 	// read a single setting from a file
 	template <typename Type>
 	Type read_settings(std::string settings_file, std::string identifier)
+	{
+		return read_settings<Type>(settings_file, identifier, Type());
+	}
+
+	// read a single setting from a file, or the default if it is not set
+	template <typename Type>
+	Type read_settings(std::string settings_file, std::string identifier, const Type & default_value)
 	{
 		std::ifstream ifs_settings;
 		ifs_settings.open(settings_file.c_str());
 		std::string dump; 
-		Type result;
+		Type result = default_value;
 	
 		// loop over the whole settings card and locate settings
 		while (ifs_settings >> dump)
@@ -75,6 +75,26 @@ int main(int argc, const char* argv[])
 		test_cuts_passed = false;
 	cout << endl << endl << endl;
 	
+	// run: test_gres, only built with the gres module
+	cout << "=====================================================================" << endl;
+	cout << "= TEST: GRES                                                        =" << endl;
+	cout << "=====================================================================" << endl;
+	bool test_gres_passed = true;
+	int result_gres = system("./test_gres") / 256;
+	if (result_gres == EXIT_FAILURE)
+		test_gres_passed = false;
+	cout << endl << endl << endl;
+	
+	// run: test_detector
+	cout << "=====================================================================" << endl;
+	cout << "= TEST: DETECTOR                                                    =" << endl;
+	cout << "=====================================================================" << endl;
+	bool test_detector_passed = true;
+	int result_detector = system("./test_detector") / 256;
+	if (result_detector == EXIT_FAILURE)
+		test_detector_passed = false;
+	cout << endl << endl << endl;
+	
 	// run: test_histogram
 	cout << "=====================================================================" << endl;
 	cout << "= TEST: HISTOGRAM                                                   =" << endl;
@@ -116,8 +136,8 @@ int main(int argc, const char* argv[])
 	cout << endl << endl << endl;
 	
 	// determine success of all test
-	bool all_tests_passed = test_lhco_passed && test_lhe_passed && test_event_passed && test_cuts_passed
-		&& test_histogram_passed && test_plot_passed && test_bumphunter_passed && test_jets_passed;
+	bool all_tests_passed = test_lhco_passed && test_lhe_passed && test_event_passed && test_cuts_passed && test_gres_passed
+		&& test_detector_passed && test_histogram_passed && test_plot_passed && test_bumphunter_passed && test_jets_passed;
 	
 	// log results of all tests
 	cout << "=====================================================================" << endl;
@@ -132,6 +152,10 @@ int main(int argc, const char* argv[])
 	cout << "!                                            =" << endl;
 	cout << "= Cuts test has " << (test_cuts_passed ? "passed" : "failed");
 	cout << "!                                             =" << endl;
+	cout << "= Gres test has " << (test_gres_passed ? "passed" : "failed");
+	cout << "!                                             =" << endl;
+	cout << "= Detector test has " << (test_detector_passed ? "passed" : "failed");
+	cout << "!                                         =" << endl;
 	cout << "= Histogram test has " << (test_histogram_passed ? "passed" : "failed");
 	cout << "!                                        =" << endl;
 	cout << "= Plot test has " << (test_plot_passed ? "passed" : "failed");
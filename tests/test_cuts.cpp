@@ -8,6 +8,8 @@
 #include <ctime>
 #include <iostream>
 #include <random>
+#include <sstream>
+#include <string>
 #include <vector>
 
 #include <boost/filesystem.hpp>
@@ -67,16 +69,52 @@ int main(int argc, const char* argv[])
 	test_cuts.apply(events_lhe);
 	test_cuts.write(cout);
 	double eff_lhe = test_cuts.efficiency();
+
+	// the counters survive a binary round trip, while other cuts and corrupt data are rejected
+	stringstream binary;
+	test_cuts.write_binary(binary);
+	string stored = binary.str();
+	cuts read_cuts;
+	stringstream read_stream(stored), same_stream(stored), other_stream(stored);
+	bool test_binary_passed = read_cuts.read_binary(read_stream) && read_cuts.efficiency() == eff_lhe;
+	stringstream text_written, text_read;
+	test_cuts.write(text_written);
+	read_cuts.write(text_read);
+	test_binary_passed = test_binary_passed && text_written.str() == text_read.str();
+	test_binary_passed = test_binary_passed && test_cuts.read_binary(same_stream) && test_cuts.efficiency() == eff_lhe;
+	cuts other_cuts;
+	other_cuts.add_cut(pt1, "other cut");
+	test_binary_passed = test_binary_passed && !other_cuts.read_binary(other_stream);
+	string corrupt = stored;
+	for (unsigned int i = sizeof(unsigned int); i < 2 * sizeof(unsigned int); i++)
+		corrupt[i] = static_cast<char>(0xff);
+	stringstream corrupt_stream(corrupt), truncated_stream(stored.substr(0, stored.size() - 2));
+	test_binary_passed = test_binary_passed && !read_cuts.read_binary(corrupt_stream) && !read_cuts.read_binary(truncated_stream);
 	test_cuts.clear();
 	
 	// determine success
 	bool test_cuts_passed = eff_lhe / eff_lhco > 0.8 && eff_lhe / eff_lhco < 1.2;
+
+	// repeat the met and ht cuts on observables, which are computed once per event
+	observables obs;
+	obs.add("met", observable_met());
+	unsigned int ht_handle = obs.add("ht", observable_ht(ptype_jet, 20, 5.0));
+	cuts obs_cuts;
+	cut_observable *met_obs = new cut_observable(obs, "met", 100);
+	cut_observable *ht_obs = new cut_observable(obs, ht_handle, 400);
+	obs_cuts.add_cut(met_obs, "met > 100 GeV");
+	obs_cuts.add_cut(ht_obs, "ht(j's) > 400 GeV");
+	vector<event*> events_obs = obs_cuts.reduce(events_lhco);
+	events_obs = obs_cuts.reduce(events_lhco);
+	bool test_observables_passed = events_obs.size() == events_lhco.size() && obs.nr_computed() == 2 * events_lhco.size();
 		
 	// log results
 	duration = (clock() - clock_old) / static_cast<double>(CLOCKS_PER_SEC);
 	cout << "=====================================================================" << endl;
 	cout << "Cuts test: completed in " << duration << " seconds." << endl;
 	cout << "Cuts for LHCO and LHE have " << (test_cuts_passed ? "passed!" : "failed!") << endl;
+	cout << "Cuts on cached observables have " << (test_observables_passed ? "passed!" : "failed!") << endl;
+	cout << "Binary cut counters have " << (test_binary_passed ? "passed!" : "failed!") << endl;
 	cout << "=====================================================================" << endl;
 	
 	// clear remaining pointers
@@ -85,13 +123,15 @@ int main(int argc, const char* argv[])
 	delete met;
 	delete ht;
 	delete veto;
+	delete met_obs;
+	delete ht_obs;
 	
 	// clear remaining event pointers
 	delete_events(events_lhco);
 	delete_events(events_lhe);
 	
 	// return whether tests passed
-	if (test_cuts_passed)
+	if (test_cuts_passed && test_observables_passed && test_binary_passed)
 		return EXIT_SUCCESS;
 	return EXIT_FAILURE;	
 }
@@ -0,0 +1,177 @@
+/* Detector Tests
+ *
+ * Test the parametrised detector simulation with small detector cards.
+ *
+*/
+
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "detector/detector_sim.h"
+#include "event/event.h"
+#include "particle/lhco.h"
+#include "particle/particle.h"
+
+using namespace std;
+using namespace analysis;
+
+
+// writes a detector card with the same tables for all object types: two eta and two pt bins
+void write_card(string file, string efficiency, string resolution)
+{
+	ofstream card(file.c_str());
+	string names[5] = { "PHOTON", "ELECTRON", "MUON", "TAU", "JET" };
+	for (unsigned int n = 0; n < 5; ++n)
+	{
+		card << names[n] << "_ETA_BINS = {0.0,2.5,5.0}" << endl;
+		card << names[n] << "_PT_BINS = {0.0,100.0,10000.0}" << endl;
+		card << names[n] << "_EFFICIENCY = " << efficiency << endl;
+		card << names[n] << "_RESOLUTION = " << resolution << endl;
+	}
+	card << "JET_BTAG = {1.0,1.0,1.0,1.0}" << endl;
+	card << "JET_MISTAG = {0.0,0.0,0.0,0.0}" << endl;
+}
+
+// sum of the transverse momenta of the visible objects and the missing energy of an event
+void pt_balance(const event *ev, double & px, double & py)
+{
+	px = 0; py = 0;
+	for (unsigned int i = 0; i < ev->size(); ++i)
+	{
+		px += (*ev)[i]->pt() * cos((*ev)[i]->phi());
+		py += (*ev)[i]->pt() * sin((*ev)[i]->phi());
+	}
+}
+
+// checks the balance of the reconstructed events with their truth events
+bool check_balance(const vector<event*> & truth, const vector<event*> & reco, double precision)
+{
+	for (unsigned int i = 0; i < truth.size(); ++i)
+	{
+		double truth_px, truth_py, reco_px, reco_py;
+		pt_balance(truth[i], truth_px, truth_py);
+		pt_balance(reco[i], reco_px, reco_py);
+		if (abs(truth_px - reco_px) > precision || abs(truth_py - reco_py) > precision)
+			return false;
+	}
+	return true;
+}
+
+
+// main program
+int main(int argc, const char* argv[])
+{
+	// initiate timing procedure
+	clock_t clock_old = clock();
+	double duration;
+
+	// set test precision
+	double test_precision = 0.00001;
+
+	// truth events of jets, b-jets and leptons within the detector and their missing energy
+	mt19937 rng(1234);
+	uniform_real_distribution<double> eta_dist(-4.5, 4.5);
+	uniform_real_distribution<double> phi_dist(-3.14, 3.14);
+	uniform_real_distribution<double> pt_dist(10.0, 500.0);
+	unsigned int types[4] = { ptype_jet, ptype_jet, ptype_electron, ptype_muon };
+	vector<event*> truth;
+	for (unsigned int i = 0; i < 200; i++)
+	{
+		event *ev = new event;
+		for (unsigned int j = 0; j < 8; j++)
+		{
+			unsigned int type = types[j % 4];
+			double charge = type == ptype_jet ? 0.0 : (j % 8 < 4 ? 1.0 : -1.0);
+			double btag = j == 1 ? 1.0 : 0.0;
+			ev->push_back(new lhco(type, eta_dist(rng), phi_dist(rng), pt_dist(rng), type == ptype_jet ? 10.0 : 0.0, charge, btag));
+		}
+		ev->push_back(new lhco(ptype_met, 0.0, phi_dist(rng), pt_dist(rng)));
+		truth.push_back(ev);
+	}
+
+	// full efficiency and no smearing reproduces the truth objects and the missing energy
+	write_card("test_detector_ideal.dat", "{1.0,1.0,1.0,1.0}", "{0.0,0.0,0.0,0.0}");
+	detector_sim ideal("test_detector_ideal.dat");
+	vector<event*> reco_ideal;
+	ideal.simulate(truth, reco_ideal);
+	bool test_ideal_passed = true;
+	for (unsigned int i = 0; i < truth.size(); i++)
+	{
+		if (reco_ideal[i]->size() != truth[i]->size())
+		{
+			test_ideal_passed = false;
+			continue;
+		}
+		for (unsigned int j = 0; j < truth[i]->size(); j++)
+		{
+			const particle *t = (*truth[i])[j];
+			const particle *r = (*reco_ideal[i])[j];
+			if (r->type() != t->type() || abs(r->pt() - t->pt()) > test_precision || abs(r->eta() - t->eta()) > test_precision)
+				test_ideal_passed = false;
+			if (r->type() == ptype_jet && r->bjet() != t->bjet())
+				test_ideal_passed = false;
+		}
+	}
+	cout << "Detector with full efficiency and no smearing reproduces the truth: " << (test_ideal_passed ? "passed" : "failed") << endl;
+
+	// zero efficiency leaves only the missing energy, which absorbs all visible objects
+	write_card("test_detector_blind.dat", "{0.0,0.0,0.0,0.0}", "{0.0,0.0,0.0,0.0}");
+	detector_sim blind("test_detector_blind.dat");
+	vector<event*> reco_blind;
+	blind.simulate(truth, reco_blind);
+	bool test_blind_passed = check_balance(truth, reco_blind, test_precision);
+	for (unsigned int i = 0; i < reco_blind.size(); i++)
+		test_blind_passed = test_blind_passed && reco_blind[i]->size() == 1 && (*reco_blind[i])[0]->type() == ptype_met;
+	cout << "Detector with zero efficiency only reconstructs missing energy: " << (test_blind_passed ? "passed" : "failed") << endl;
+
+	// a realistic detector keeps the transverse momentum balanced and does not depend on the number of workers
+	write_card("test_detector_smear.dat", "{0.9,0.95,0.5,0.6}", "{0.1,0.05,0.2,0.15}");
+	detector_sim smear("test_detector_smear.dat", 42);
+	vector<event*> reco_single, reco_multi;
+	smear.simulate(truth, reco_single, 1);
+	smear.simulate(truth, reco_multi, 4);
+	bool test_smear_passed = check_balance(truth, reco_single, test_precision);
+	for (unsigned int i = 0; i < truth.size(); i++)
+	{
+		if (reco_single[i]->size() != reco_multi[i]->size())
+		{
+			test_smear_passed = false;
+			continue;
+		}
+		for (unsigned int j = 0; j < reco_single[i]->size(); j++)
+		{
+			const particle *s = (*reco_single[i])[j];
+			const particle *m = (*reco_multi[i])[j];
+			if (s->type() != m->type() || s->pt() != m->pt() || s->eta() != m->eta() || s->phi() != m->phi() || s->bjet() != m->bjet())
+				test_smear_passed = false;
+		}
+	}
+	cout << "Detector with smearing is balanced and independent of the workers: " << (test_smear_passed ? "passed" : "failed") << endl;
+
+	// determine success
+	bool test_detector_passed = test_ideal_passed && test_blind_passed && test_smear_passed;
+
+	// log results
+	duration = (clock() - clock_old) / static_cast<double>(CLOCKS_PER_SEC);
+	cout << "=====================================================================" << endl;
+	cout << "Detector test: completed in " << duration << " seconds." << endl;
+	cout << "Detector tests have " << (test_detector_passed ? "passed!" : "failed!") << endl;
+	cout << "=====================================================================" << endl;
+
+	// clear remaining pointers
+	delete_events(truth);
+	delete_events(reco_ideal);
+	delete_events(reco_blind);
+	delete_events(reco_single);
+	delete_events(reco_multi);
+
+	// return whether tests passed
+	if (test_detector_passed)
+		return EXIT_SUCCESS;
+	return EXIT_FAILURE;
+}
@@ -11,6 +11,9 @@
 #include <vector> 
 
 #include "event/event.h"
+#include "event/mt2_bisect.h"
+#include "event/overlap_removal.h"
+#include "particle/eta_phi_list.h"
 #include "particle/lhco.h"
 #include "particle/lhe.h"
 #include "particle/particle.h"
@@ -18,6 +21,15 @@
 using namespace std;
 using namespace analysis;
 
+// attached info referring to a particle of the event
+class test_info : public event_info
+{
+public:
+	test_info(int i) : index(i) {}
+	test_info* clone() const { return new test_info(*this); }
+	int index;
+};
+
 
 // main program
 int main(int argc, const char* argv[])
@@ -48,7 +60,7 @@ int main(int argc, const char* argv[])
 	event *ev_lhe = new event;
 	for (unsigned int i = 0; i < ev_lhco->size(); i++)
 	{
-		particle *p_lhco = (*ev_lhco)[i];
+		const particle *p_lhco = (*ev_lhco)[i];
 		double px = p_lhco->px();
 		double py = p_lhco->py();
 		double pz = p_lhco->pz();
@@ -64,8 +76,8 @@ int main(int argc, const char* argv[])
 	bool test_lhco_lhe_passed = true;
 	for (unsigned int i = 0; i < ev_lhco->size(); i++)
 	{
-		particle *p_lhco = (*ev_lhco)[i];
-		particle *p_lhe = (*ev_lhe)[i];		
+		const particle *p_lhco = (*ev_lhco)[i];
+		const particle *p_lhe = (*ev_lhe)[i];		
 		// test pt
 		if (!(fabs((p_lhco->pt() - p_lhe->pt()) / p_lhco->pt()) < test_precision))
 		{
@@ -117,13 +129,139 @@ int main(int argc, const char* argv[])
 		cout << std::setprecision(6) << "event.ht(-1, 5.0, 5.0): " << ev_lhco->ht(ptype_all, 5.0, 5.0) << " != " << ev_lhe->ht(ptype_all, 5.0, 5.0) << endl;
 		test_event_passed = false;
 	}
-		
+
+	// test the closed form mt2 solutions against the bisection: massless with the missing momentum
+	// between the visible ones (mn = 0), massless without upstream momentum, unbalanced masses and
+	// a balanced configuration which is bisected in both cases
+	bool test_mt2_passed = true;
+	double mt2_configs[4][10] = {
+		// pa(m, px, py), pb(m, px, py), pmiss(-, px, py), mn
+		{0.0, 100.0, 20.0, 0.0, 30.0, 80.0, 0.0, 60.0, 50.0, 0.0},
+		{0.0, 100.0, 20.0, 0.0, -30.0, 80.0, 0.0, -70.0, -100.0, 50.0},
+		{100.0, 20.0, 0.0, 5.0, 10.0, 5.0, 0.0, 5.0, 5.0, 0.0},
+		{10.0, 120.0, -40.0, 10.0, -60.0, 90.0, 0.0, -30.0, -80.0, 20.0}
+	};
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		double *pa = mt2_configs[i], *pb = mt2_configs[i] + 3, *pmiss = mt2_configs[i] + 6;
+		mt2_bisect::mt2 mt2_closed, mt2_bisected;
+		mt2_closed.set_momenta(pa, pb, pmiss);
+		mt2_closed.set_mn(mt2_configs[i][9]);
+		mt2_bisected.set_momenta(pa, pb, pmiss);
+		mt2_bisected.set_mn(mt2_configs[i][9]);
+		mt2_bisected.set_analytic(false);
+		double closed = mt2_closed.get_mt2();
+		double bisected = mt2_bisected.get_mt2();
+		if (fabs(closed - bisected) > 1e-3 * max(1.0, bisected))
+		{
+			cout << std::setprecision(6) << "mt2 configuration " << i << ": closed form " << closed << " != bisection " << bisected << endl;
+			test_mt2_passed = false;
+		}
+	}
+
+	// test the batched deltaR^2 kernels against the pairwise deltaR
+	bool test_delta_r_passed = true;
+	eta_phi_list group1, group2;
+	for (unsigned int i = 0; i < 50; i++)
+		group1.add((*ev_lhco)[i]);
+	for (unsigned int i = 50; i < 80; i++)
+		group2.add((*ev_lhco)[i]);
+	vector<double> dr2_within, dr2_between;
+	group1.delta_r2(dr2_within);
+	group1.delta_r2(group2, dr2_between);
+	for (unsigned int i = 0; i < group1.size(); i++)
+	{
+		for (unsigned int j = 0; j < group1.size(); j++)
+		{
+			if (fabs(dr2_within[i * group1.size() + j] - pow(delta_r((*ev_lhco)[i], (*ev_lhco)[j]), 2.0)) > test_precision)
+				test_delta_r_passed = false;
+		}
+		for (unsigned int j = 0; j < group2.size(); j++)
+		{
+			if (fabs(dr2_between[i * group2.size() + j] - pow(delta_r((*ev_lhco)[i], (*ev_lhco)[50 + j]), 2.0)) > test_precision)
+				test_delta_r_passed = false;
+		}
+	}
+	if (!test_delta_r_passed)
+		cout << "batched deltaR^2 differs from the pairwise deltaR" << endl;
+
+	// test the overlap removal: rules apply in sequence and removed objects are no references anymore
+	bool test_overlap_passed = true;
+	overlap_removal overlap;
+	overlap.add_rule("jet-electron", ptype_jet, ptype_electron, 0.2);
+	overlap.add_rule("muon-jet", ptype_muon, ptype_jet, 0.4);
+	overlap.add_rule("jet-muon", ptype_jet, ptype_muon, 0.4);
+	event *ev_overlap = new event;
+	ev_overlap->push_back(new lhco(ptype_electron, 0.0, 0.0, 100.0));
+	ev_overlap->push_back(new lhco(ptype_jet, 0.1, 0.0, 90.0));
+	ev_overlap->push_back(new lhco(ptype_jet, 1.0, 3.1, 80.0));
+	ev_overlap->push_back(new lhco(ptype_muon, 1.1, -3.1, 70.0));
+	ev_overlap->push_back(new lhco(ptype_jet, -2.0, 1.0, 60.0));
+	if (overlap.apply(ev_overlap) != 2 || ev_overlap->size() != 3 || overlap.removed(0) != 1 || overlap.removed(1) != 1 || overlap.removed(2) != 0)
+	{
+		cout << "overlap removal of the rule sequence failed" << endl;
+		test_overlap_passed = false;
+	}
+	delete ev_overlap;
+	// compare a single rule on random jets and electrons with the pairwise check
+	event *ev_random = new event;
+	for (unsigned int i = 0; i < 300; i++)
+	{
+		unsigned int type = i < 200 ? ptype_jet : ptype_electron;
+		double eta = normal_distribution<double>(0.0, 1.5)(rd);
+		double phi = uniform_real_distribution<double>(-3.14, 3.14)(rd);
+		ev_random->push_back(new lhco(type, eta, phi, 50.0));
+	}
+	unsigned int nr_overlapping = 0;
+	for (unsigned int i = 0; i < ev_random->size(); i++)
+	{
+		if ((*ev_random)[i]->type() != ptype_jet)
+			continue;
+		for (unsigned int j = 0; j < ev_random->size(); j++)
+		{
+			if ((*ev_random)[j]->type() == ptype_electron && delta_r((*ev_random)[i], (*ev_random)[j]) < 0.3)
+			{
+				nr_overlapping++;
+				break;
+			}
+		}
+	}
+	overlap_removal overlap_random;
+	overlap_random.add_rule("jet-electron", ptype_jet, ptype_electron, 0.3);
+	if (overlap_random.apply(ev_random) != nr_overlapping || ev_random->size() != 300 - nr_overlapping)
+	{
+		cout << "overlap removal differs from the pairwise check" << endl;
+		test_overlap_passed = false;
+	}
+	delete ev_random;
+
+	// test the attached info: copies keep a clone, changing the particles removes it
+	bool test_info_passed = true;
+	ev_lhco->set_info(new test_info(3));
+	event *ev_copy = new event(*ev_lhco);
+	if (ev_copy->info<test_info>() == nullptr || ev_copy->info<test_info>() == ev_lhco->info<test_info>() || ev_copy->info<test_info>()->index != 3)
+	{
+		cout << "event info is not cloned with the event" << endl;
+		test_info_passed = false;
+	}
+	ev_copy->erase(0);
+	if (ev_copy->info() != nullptr || ev_lhco->info<test_info>() == nullptr)
+	{
+		cout << "event info is not removed when the particles change" << endl;
+		test_info_passed = false;
+	}
+	delete ev_copy;
+
 	// log results
 	duration = (clock() - clock_old) / static_cast<double>(CLOCKS_PER_SEC);
 	cout << "=====================================================================" << endl;
 	cout << "Event & particle test: completed in " << duration << " seconds." << endl;
 	cout << "Kinematics checks between lhco and lhe classes have " << (test_lhco_lhe_passed ? "passed!" : "failed!") << endl;
 	cout << "Event function checks between lhco and lhe classes have " << (test_event_passed ? "passed!" : "failed!") << endl;
+	cout << "MT2 closed form checks have " << (test_mt2_passed ? "passed!" : "failed!") << endl;
+	cout << "DeltaR kernel checks have " << (test_delta_r_passed ? "passed!" : "failed!") << endl;
+	cout << "Overlap removal checks have " << (test_overlap_passed ? "passed!" : "failed!") << endl;
+	cout << "Event info checks have " << (test_info_passed ? "passed!" : "failed!") << endl;
 	cout << "=====================================================================" << endl;
 	
 	// clear remaining event pointers
@@ -131,7 +269,7 @@ int main(int argc, const char* argv[])
 	delete ev_lhe;
 	
 	// return whether tests passed
-	if (test_lhco_lhe_passed && test_event_passed)
+	if (test_lhco_lhe_passed && test_event_passed && test_mt2_passed && test_delta_r_passed && test_overlap_passed && test_info_passed)
 		return EXIT_SUCCESS;
 	return EXIT_FAILURE;
 }
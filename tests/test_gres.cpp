@@ -0,0 +1,188 @@
+/* Gres Tests
+ *
+ * Test the invariant mass combination cut against a straightforward
+ * combinatorial implementation.
+ *
+*/
+
+#include <cmath>
+#include <ctime>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "event/event.h"
+#include "gres/gres_cuts.h"
+#include "particle/lhco.h"
+#include "particle/particle.h"
+
+using namespace std;
+using namespace analysis;
+
+
+// invariant mass of a combination of the central jets, numbered from 1 as in event::get
+double reference_mass(const event *ev, const vector<unsigned int> & comb)
+{
+	double pe = 0.0; double px = 0.0; double py = 0.0; double pz = 0.0;
+	for (unsigned int k = 0; k < comb.size(); k++)
+	{
+		const particle *p = ev->get(ptype_jet, comb[k], 2.8);
+		pe += p->pe(); px += p->px(); py += p->py(); pz += p->pz();
+	}
+	return sqrt(max(pe * pe - px * px - py * py - pz * pz, 0.0));
+}
+
+// completes the combination of resonance res with jets from start on and assigns the remaining
+// resonances to unused jets, true if all resonances have a mass strictly above their cut
+bool reference_assign(const event *ev, const vector<int> & topology, const vector<double> & cuts, unsigned int nr_jets,
+	unsigned int res, vector<unsigned int> & comb, unsigned int start, vector<bool> & used)
+{
+	if (res == topology.size())
+		return true;
+
+	// a complete combination has to pass its cut before the next resonance is assigned
+	if (comb.size() == static_cast<unsigned int>(topology[res]))
+	{
+		if (!(reference_mass(ev, comb) > cuts[res]))
+			return false;
+		for (unsigned int k = 0; k < comb.size(); k++)
+			used[comb[k] - 1] = true;
+		vector<unsigned int> next_comb;
+		bool passed = reference_assign(ev, topology, cuts, nr_jets, res + 1, next_comb, 1, used);
+		for (unsigned int k = 0; k < comb.size(); k++)
+			used[comb[k] - 1] = false;
+		return passed;
+	}
+
+	for (unsigned int jet = start; jet <= nr_jets; jet++)
+	{
+		if (used[jet - 1])
+			continue;
+		comb.push_back(jet);
+		bool passed = reference_assign(ev, topology, cuts, nr_jets, res, comb, jet + 1, used);
+		comb.pop_back();
+		if (passed)
+			return true;
+	}
+	return false;
+}
+
+// the leading nr_jets central jets are combined, single jet resonances do not constrain the event
+bool reference_passed(const event *ev, const vector<int> & topology, const vector<double> & cuts)
+{
+	unsigned int nr_jets = 0;
+	vector<int> reduced_topology;
+	vector<double> reduced_cuts;
+	for (unsigned int i = 0; i < topology.size(); i++)
+	{
+		nr_jets += topology[i];
+		if (topology[i] != 1)
+		{
+			reduced_topology.push_back(topology[i]);
+			reduced_cuts.push_back(cuts[i]);
+		}
+	}
+	if (ev->get(ptype_jet, nr_jets, 2.8) == nullptr)
+		return false;
+	vector<bool> used(nr_jets, false);
+	vector<unsigned int> comb;
+	return reference_assign(ev, reduced_topology, reduced_cuts, nr_jets, 0, comb, 1, used);
+}
+
+
+// main program
+int main(int argc, const char* argv[])
+{
+	// initiate timing procedure
+	clock_t clock_old = clock();
+	double duration;
+
+	// events with jets, some outside the central region, and leptons in between
+	mt19937 rng(4321);
+	uniform_real_distribution<double> eta_dist(-4.0, 4.0);
+	uniform_real_distribution<double> phi_dist(-3.14, 3.14);
+	uniform_real_distribution<double> pt_dist(20.0, 400.0);
+	uniform_real_distribution<double> mass_dist(0.0, 40.0);
+	uniform_int_distribution<int> nr_dist(2, 9);
+	vector<event*> events;
+	for (unsigned int i = 0; i < 2000; i++)
+	{
+		event *ev = new event;
+		int nr_particles = nr_dist(rng);
+		for (int j = 0; j < nr_particles; j++)
+		{
+			unsigned int type = j % 4 == 3 ? ptype_electron : ptype_jet;
+			ev->push_back(new lhco(type, eta_dist(rng), phi_dist(rng), pt_dist(rng), type == ptype_jet ? mass_dist(rng) : 0.0));
+		}
+		events.push_back(ev);
+	}
+
+	// topologies with a specialised kernel and with the generic loop, each with a set of cuts
+	vector< vector<int> > topologies = { {2}, {2, 1}, {1, 2, 1}, {3, 1}, {2, 2}, {2, 2, 1}, {3, 2}, {2, 3, 1}, {2, 2, 2} };
+	vector< vector<double> > cut_values = { {-10.0, 0.0, 50.0, 150.0, 300.0}, {0.0, 100.0, 250.0} };
+
+	// the cut agrees with the reference for all events
+	bool test_reference_passed = true;
+	unsigned int nr_passed = 0, nr_tested = 0;
+	for (unsigned int t = 0; t < topologies.size(); t++)
+	{
+		for (unsigned int c1 = 0; c1 < cut_values[0].size(); c1++)
+		{
+			for (unsigned int c2 = 0; c2 < cut_values[1].size(); c2++)
+			{
+				vector<double> cuts;
+				for (unsigned int r = 0; r < topologies[t].size(); r++)
+					cuts.push_back(r % 2 == 0 ? cut_values[0][c1] : cut_values[1][c2]);
+				cut_gres gres;
+				gres.set_topology(topologies[t]);
+				gres.set_top_cuts(cuts);
+				gres.init();
+				for (unsigned int i = 0; i < events.size(); i++)
+				{
+					bool passed = gres(events[i]);
+					if (passed != reference_passed(events[i], topologies[t], cuts))
+						test_reference_passed = false;
+					nr_passed += passed;
+					nr_tested++;
+				}
+			}
+		}
+	}
+	cout << "Invariant mass cut agrees with the reference for " << nr_tested << " events, of which " << nr_passed << " passed: " << (test_reference_passed ? "passed" : "failed") << endl;
+
+	// the special case helpers agree with the cut for their topology
+	bool test_special_passed = true;
+	vector< vector<int> > special_topologies = { {2, 1}, {3, 1}, {2, 2} };
+	for (unsigned int t = 0; t < special_topologies.size(); t++)
+	{
+		cut_gres gres;
+		gres.set_topology(special_topologies[t]);
+		gres.set_top_cuts({150.0, 100.0});
+		gres.init();
+		for (unsigned int i = 0; i < events.size(); i++)
+		{
+			bool special = t == 0 ? gres.passed_top21(events[i]) : (t == 1 ? gres.passed_top31(events[i]) : gres.passed_top22(events[i]));
+			if (special != gres(events[i]))
+				test_special_passed = false;
+		}
+	}
+	cout << "Invariant mass special cases agree with the cut: " << (test_special_passed ? "passed" : "failed") << endl;
+
+	// determine success
+	bool test_gres_passed = test_reference_passed && test_special_passed && nr_passed > 0 && nr_passed < nr_tested;
+
+	// log results
+	duration = (clock() - clock_old) / static_cast<double>(CLOCKS_PER_SEC);
+	cout << "=====================================================================" << endl;
+	cout << "Gres test: completed in " << duration << " seconds." << endl;
+	cout << "Gres tests have " << (test_gres_passed ? "passed!" : "failed!") << endl;
+	cout << "=====================================================================" << endl;
+
+	// clear remaining pointers
+	delete_events(events);
+
+	// return whether tests passed
+	if (test_gres_passed)
+		return EXIT_SUCCESS;
+	return EXIT_FAILURE;
+}
@@ -8,6 +8,8 @@
 #include <ctime>
 #include <iomanip> 
 #include <iostream>
+#include <random>
+#include <vector>
 
 #include "Pythia8/Pythia.h"
 #include "Pythia8Plugins/FastJet3.h"
@@ -65,6 +67,59 @@ int main(int argc, const char* argv[])
 	test.initialise(TopTagger);
 
 
+	//===== tagging a chunk of events in parallel agrees with tagging them one by one =====//
+
+	// events of a few narrow sprays of massless particles, clustered into fat jets
+	mt19937 rng(2718);
+	uniform_real_distribution<double> eta_dist(-2.0, 2.0);
+	uniform_real_distribution<double> phi_dist(0.0, 2 * M_PI);
+	uniform_real_distribution<double> spread_dist(-0.6, 0.6);
+	uniform_real_distribution<double> pt_dist(20.0, 150.0);
+	fastjet::JetDefinition chunk_def(fastjet::cambridge_algorithm, 1.5);
+	vector< fastjet::ClusterSequence* > chunk_sequences;
+	vector< vector< fastjet::PseudoJet > > chunk, chunk_serial;
+	for (unsigned int iEv = 0; iEv < 40; ++iEv)
+	{
+		vector< fastjet::PseudoJet > particles;
+		for (unsigned int iSpray = 0; iSpray < 3; ++iSpray)
+		{
+			double eta = eta_dist(rng), phi = phi_dist(rng);
+			for (unsigned int i = 0; i < 6; ++i)
+			{
+				fastjet::PseudoJet p;
+				p.reset_PtYPhiM(pt_dist(rng), eta + spread_dist(rng), phi + spread_dist(rng));
+				particles.push_back(p);
+			}
+		}
+		chunk_sequences.push_back(new fastjet::ClusterSequence(particles, chunk_def));
+		chunk.push_back(fastjet::sorted_by_pt(chunk_sequences.back()->inclusive_jets(200.0)));
+		chunk_serial.push_back(test.tag_fatjets(chunk.back(), TopTagger));
+	}
+	test.set_nWorkers(4);
+	test.tag_fatjets(chunk, TopTagger);
+	bool test_chunk_passed = true;
+	for (unsigned int iEv = 0; iEv < chunk.size(); ++iEv)
+	{
+		if (chunk[iEv].size() != chunk_serial[iEv].size())
+		{
+			test_chunk_passed = false;
+			continue;
+		}
+		for (unsigned int i = 0; i < chunk[iEv].size(); ++i)
+		{
+			const TagInfo & parallel_info = chunk[iEv][i].user_info<TagInfo>();
+			const TagInfo & serial_info = chunk_serial[iEv][i].user_info<TagInfo>();
+			if (parallel_info.top_tag() != serial_info.top_tag() || parallel_info.h_tag() != serial_info.h_tag() || chunk[iEv][i].pt() != chunk_serial[iEv][i].pt())
+				test_chunk_passed = false;
+		}
+	}
+	cout << "Tagging a chunk of events in parallel agrees with the serial tagging: " << (test_chunk_passed ? "passed" : "failed") << endl;
+	chunk.clear();
+	chunk_serial.clear();
+	for (unsigned int iEv = 0; iEv < chunk_sequences.size(); ++iEv)
+		delete chunk_sequences[iEv];
+
+
 	//===== apply list of cuts as in hep-ph/1006.2833 =====//
 
 	// double eff_fatjet_pt = test.require_fatjet_pt(200,2);
@@ -109,7 +164,7 @@ int main(int argc, const char* argv[])
 
 
 	// //===== result =====//
-	bool test_jets_passed = true;
+	bool test_jets_passed = test_chunk_passed;
 
 	// log results
 	duration = (clock() - clock_old) / static_cast<double>(CLOCKS_PER_SEC);
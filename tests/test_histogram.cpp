@@ -8,12 +8,17 @@
 #include <ctime>
 #include <iostream> 
 #include <random>
+#include <sstream>
+#include <thread>
 #include <vector> 
 
 #include <boost/filesystem.hpp>
 
 #include "histogram/histogram.h"
 #include "histogram/histogram2D.h"
+#include "histogram/histogram_data.h"
+#include "histogram/interpolation_grid.h"
+#include "results/results.h"
 
 using namespace std;
 using namespace boost::filesystem;
@@ -65,6 +70,101 @@ int main(int argc, const char* argv[])
 	bool hist_1d_success = is_regular_file("../../files/tests/output/test_histogram_1d.png");
 
 
+	/* Histogram data: per-thread shards */
+
+	// fill the gauss sample in one histogram and in shards of four threads
+	histogram_data hist_serial(histogram_axis({0, 10, 15, 20, 25, 30, 50}));
+	for (unsigned int i = 0; i < gauss.size(); i++)
+		hist_serial.fill(gauss[i], 0.5);
+	histogram_shards<histogram_data> shards(histogram_data(hist_serial.axis()), 4);
+	vector<thread> threads;
+	for (unsigned int t = 0; t < shards.size(); t++)
+		threads.push_back(thread([&gauss, &shards, t]()
+		{
+			for (unsigned int i = t; i < gauss.size(); i += shards.size())
+				shards[t].fill(gauss[i], 0.5);
+		}));
+	for (unsigned int t = 0; t < threads.size(); t++)
+		threads[t].join();
+	
+	// the merged shards should reproduce the serial histogram
+	histogram_data hist_merged = shards.merged();
+	bool hist_shards_success = hist_merged.entries() == hist_serial.entries();
+	for (unsigned int bin = 0; bin <= hist_serial.nr_bins() + 1; bin++)
+	{
+		if (abs(hist_merged.content(bin) - hist_serial.content(bin)) > 1e-6 || abs(hist_merged.error(bin) - hist_serial.error(bin)) > 1e-6)
+			hist_shards_success = false;
+	}
+
+
+	/* Results: serialised partial results of independent jobs */
+
+	// store every shard as the result of a separate job and merge the binary results
+	results merged_results;
+	bool hist_results_success = true;
+	for (unsigned int t = 0; t < shards.size(); t++)
+	{
+		results job;
+		job.add("gauss", shards[t]);
+		stringstream job_file;
+		job.write_binary(job_file);
+		hist_results_success = hist_results_success && merged_results.read_binary(job_file);
+	}
+	
+	// the merged results should reproduce the serial histogram
+	if (!merged_results.has_histogram("gauss") || merged_results.get_histogram("gauss").entries() != hist_serial.entries())
+		hist_results_success = false;
+	for (unsigned int bin = 0; hist_results_success && bin <= hist_serial.nr_bins() + 1; bin++)
+	{
+		const histogram_data & hist_result = merged_results.get_histogram("gauss");
+		if (abs(hist_result.content(bin) - hist_serial.content(bin)) > 1e-6 || abs(hist_result.error(bin) - hist_serial.error(bin)) > 1e-6)
+			hist_results_success = false;
+	}
+
+	// results with a different binning are rejected instead of merged
+	results other_results;
+	other_results.add("gauss", histogram_data(histogram_axis(10, 0, 50)));
+	stringstream other_file;
+	other_results.write_binary(other_file);
+	hist_results_success = hist_results_success && !merged_results.read_binary(other_file);
+
+	// the merged results are added as a sample of a histogram, which adopts their binning
+	histogram hist_from_results;
+	hist_from_results.add_sample(merged_results.get_histogram("gauss"), "gauss");
+	hist_results_success = hist_results_success && hist_from_results.has_binning() && hist_from_results.data(0).axis() == hist_serial.axis();
+	hist_results_success = hist_results_success && abs(hist_from_results.data(0).integral() - hist_serial.integral()) < 1e-6;
+
+
+	/* Histogram: automatic range after the warm-up */
+
+	// a single outlier should not set the range, which is fixed after the warm-up
+	histogram hist_auto;
+	unsigned int sample_auto = hist_auto.new_sample("exp");
+	hist_auto.fill(sample_auto, 1.0e6);
+	for (unsigned int i = 0; i < exp.size(); i++)
+		hist_auto.fill(sample_auto, exp[i]);
+	hist_auto.fix_binning();
+	const histogram_axis & axis_auto = hist_auto.data(sample_auto).axis();
+	bool hist_auto_success = !hist_auto.has_binning() && axis_auto.upper_edge(axis_auto.nr_bins()) < 1000;
+
+	// a later sample beyond the range of the warm-up widens it on the same grid, such that its
+	// bulk is not lost in the overflow and the earlier sample keeps all its values
+	histogram hist_widen;
+	hist_widen.set_warm_up(1000);
+	vector<double> gamma_shifted;
+	for (unsigned int i = 0; i < gamma.size(); i++)
+		gamma_shifted.push_back(200.0 + gamma[i]);
+	hist_widen.add_sample(exp, "exp");
+	hist_widen.add_sample(gamma_shifted, "gamma");
+	hist_widen.fix_binning();
+	const histogram_data & data_exp = hist_widen.data(0);
+	const histogram_data & data_gamma = hist_widen.data(1);
+	double sum_exp = 0;
+	for (unsigned int bin = 0; bin <= data_exp.nr_bins() + 1; bin++)
+		sum_exp += data_exp.content(bin);
+	hist_auto_success = hist_auto_success && data_exp.axis() == data_gamma.axis() && abs(sum_exp - exp.size()) < 1e-6;
+	hist_auto_success = hist_auto_success && data_gamma.content(data_gamma.nr_bins() + 1) < 0.01 * gamma.size();
+
 	/* 2D histogram: XY pairs */
 
 	// test two dimensional histogram: counting x vs y
@@ -140,6 +240,44 @@ int main(int argc, const char* argv[])
 	hist_2d_xyz.add_sample_xyz(list_xyz);
 	hist_2d_xyz.draw();
 	bool hist_2d_xyz_success = is_regular_file("../../files/tests/output/test_histogram_2d_xyz.png");
+
+	// the interpolation reproduces the grid points and is linear in between
+	double step = 100.0 / nr_bins;
+	double z_mid = 0.5 * (list_xyz[0][2] + list_xyz[nr_bins][2]);
+	bool hist_2d_interpolate_success = abs(hist_2d_xyz.interpolate(list_xyz[0][0], list_xyz[0][1]) - list_xyz[0][2]) < 1e-9;
+	hist_2d_interpolate_success = hist_2d_interpolate_success && abs(hist_2d_xyz.interpolate(list_xyz[0][0] + step / 2, list_xyz[0][1]) - z_mid) < 1e-9;
+
+	// scattered points are triangulated over their whole convex hull, where a linear function
+	// is interpolated exactly: nearly collinear points and random points with random queries
+	auto linear = [](double x, double y) { return 2.0 * x + 3.0 * y + 1.0; };
+	vector< vector<double> > list_collinear = {{0.18, 0.01}, {0.37, 0.32}, {0.58, 0.66}, {0.75, 0.91}};
+	for (unsigned int i = 0; i < list_collinear.size(); i++)
+		list_collinear[i].push_back(linear(list_collinear[i][0], list_collinear[i][1]));
+	interpolation_grid grid_collinear(list_collinear);
+	grid_collinear.set_outside(-1.0);
+	bool hist_2d_scattered_success = grid_collinear.nr_triangles() == 2 && abs(grid_collinear.interpolate(0.325, 0.2425) - linear(0.325, 0.2425)) < 1e-9;
+	hist_2d_scattered_success = hist_2d_scattered_success && !grid_collinear.is_inside(0.2, 0.3);
+	mt19937 rng_scattered(1234);
+	uniform_real_distribution<double> dist_unit(0.0, 1.0);
+	vector< vector<double> > list_scattered;
+	for (unsigned int i = 0; i < 500; i++)
+	{
+		double x = 100.0 * dist_unit(rng_scattered);
+		double y = dist_unit(rng_scattered);
+		list_scattered.push_back({x, y, linear(x, y)});
+	}
+	interpolation_grid grid_scattered(list_scattered);
+	for (unsigned int i = 0; i < 2000; i++)
+	{
+		// convex combinations of three points are inside the hull
+		const vector<double> & a = list_scattered[rng_scattered() % list_scattered.size()];
+		const vector<double> & b = list_scattered[rng_scattered() % list_scattered.size()];
+		const vector<double> & c = list_scattered[rng_scattered() % list_scattered.size()];
+		double wa = dist_unit(rng_scattered), wb = (1.0 - wa) * dist_unit(rng_scattered), wc = 1.0 - wa - wb;
+		double x = wa * a[0] + wb * b[0] + wc * c[0], y = wa * a[1] + wb * b[1] + wc * c[1];
+		if (!grid_scattered.is_inside(x, y) || abs(grid_scattered.interpolate(x, y) - linear(x, y)) > 1e-9 * linear(x, y))
+			hist_2d_scattered_success = false;
+	}
 	
 	// log results
 	duration = (clock() - clock_old) / static_cast<double>(CLOCKS_PER_SEC);
@@ -147,14 +285,19 @@ int main(int argc, const char* argv[])
 	cout << "Histogram test: completed in " << duration << " seconds." << endl;
 	cout << "1D Histogram creation has " << (hist_1d_success ? "succeeded!" : "failed!") << endl; 
 	cout << "Check: exponential falling background with gaussian and gamma peaks." << endl;
+	cout << "Histogram shards merging has " << (hist_shards_success ? "succeeded!" : "failed!") << endl;
+	cout << "Histogram results merging has " << (hist_results_success ? "succeeded!" : "failed!") << endl;
+	cout << "Histogram automatic range has " << (hist_auto_success ? "succeeded!" : "failed!") << endl;
 	cout << "2D Histogram XY creation has " << (hist_2d_xy_success ? "succeeded!" : "failed!") << endl;
 	cout << "Check: 2D gaussian peak around (50, 50)." << endl;
 	cout << "2D Histogram XYZ creation has " << (hist_2d_xyz_success ? "succeeded!" : "failed!") << endl;
 	cout << "Check: same 2D gaussian peak as XY with double resolution." << endl;
+	cout << "2D Histogram interpolation has " << (hist_2d_interpolate_success ? "succeeded!" : "failed!") << endl;
+	cout << "2D Scattered interpolation has " << (hist_2d_scattered_success ? "succeeded!" : "failed!") << endl;
 	cout << "=====================================================================" << endl;
 		
 	// return whether tests passed
-	if (hist_1d_success && hist_2d_xy_success && hist_2d_xyz_success)
+	if (hist_1d_success && hist_shards_success && hist_results_success && hist_auto_success && hist_2d_xy_success && hist_2d_xyz_success && hist_2d_interpolate_success && hist_2d_scattered_success)
 		return EXIT_SUCCESS;
 	return EXIT_FAILURE;
 }
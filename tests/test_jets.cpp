@@ -56,8 +56,52 @@ int main(int argc, const char* argv[])
 	double eff = test.require_top_tagged(ntops);
 	cout << setprecision(2) << endl << "Efficiency of tagging requirement: " << 100 * eff << "%" << endl;
 
+	// compare the b-flavour ancestry with Pythia's isAncestor on a few showered events: every
+	// final state particle descending from a b quark according to isAncestor must be marked
+	Pythia pythia;
+	pythia.settings.flag("Print:quiet", true);
+	pythia.settings.mode("Beams:frameType", 4);
+	pythia.settings.word("Beams:LHEF", "../../files/tests/input/test_fastjet_events.lhe");
+	pythia.init();
+	flavour_ancestry ancestry;
+	int nr_ancestry_events = 10, nr_b_descendants = 0, nr_missing = 0, nr_extra = 0;
+	for (int iEvent = 0; iEvent < nr_ancestry_events; ++iEvent)
+	{
+		if (!pythia.next())
+			break;
+		const Event & record = pythia.event;
+		ancestry.fill(record);
+
+		// b quarks in the order of their bits
+		vector<int> b_quarks;
+		for (int i = 0; i < record.size() && b_quarks.size() < 32; ++i)
+		{
+			if (record[i].idAbs() == 5 && record[i].status() == -23)
+				b_quarks.push_back(i);
+		}
+		if (static_cast<int>(b_quarks.size()) != ancestry.nr_b())
+			nr_missing++;
+
+		for (int i = 0; i < record.size(); ++i)
+		{
+			if (!record[i].isFinal())
+				continue;
+			for (unsigned int b = 0; b < b_quarks.size(); ++b)
+			{
+				bool is_ancestor = record.isAncestor(i, b_quarks[b]);
+				bool is_marked = ancestry.b_mask(i) & (1u << b);
+				nr_b_descendants += is_ancestor;
+				nr_missing += is_ancestor && !is_marked;
+				nr_extra += !is_ancestor && is_marked;
+			}
+		}
+	}
+	bool test_ancestry_passed = nr_b_descendants > 0 && nr_missing == 0;
+	cout << "Descendants of b quarks (isAncestor): " << nr_b_descendants << ", missing: " << nr_missing;
+	cout << ", additionally marked from b strings: " << nr_extra << endl;
+
 	// determine success
-	bool test_jets_passed = true;
+	bool test_jets_passed = test_ancestry_passed;
 
 	// log results
 	duration = (clock() - clock_old) / static_cast<double>(CLOCKS_PER_SEC);
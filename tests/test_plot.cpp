@@ -8,14 +8,18 @@
 #include <ctime>
 #include <iostream>
 #include <random>
+#include <sstream>
 #include <vector>
 
 #include <boost/filesystem.hpp>
 
+#include "cuts/cuts.h"
 #include "event/event.h"
+#include "particle/lhco.h"
 #include "utility/utility.h"
 #include "plot/plot.h"
 #include "plot/plot2d.h"
+#include "plot/plot_set.h"
 
 using namespace std;
 using namespace boost::filesystem;
@@ -34,6 +38,9 @@ int main(int argc, const char* argv[])
 	remove("../../files/tests/output/test_plot_met.png");
 	remove("../../files/tests/output/test_plot_2d_lhco.png");
 	remove("../../files/tests/output/test_plot_2d_lhe.png");
+	remove("../../files/tests/output/test_plot_set_rare.png");
+	remove("../../files/tests/output/test_plot_set_all.png");
+	remove("../../files/tests/output/test_plot_set_fixed.png");
 	
 	// load the lhco and lhe events for this test
 	vector<event*> events_lhco;
@@ -73,6 +80,34 @@ int main(int argc, const char* argv[])
 	lhe_2d.run();
 	bool test_plot_lhe_2d_passed = is_regular_file("../../files/tests/output/test_plot_2d_lhe.png");
 	
+	// make a plot set with a rare precondition over many events and several workers: plots with 
+	// automatic range fill the warm-up in event order and then shards on their range, the plot
+	// with fixed bins fills shards of its binning
+	vector<event*> events_many;
+	mt19937 rng(42);
+	exponential_distribution<double> dist_pt(0.02);
+	unsigned int nr_rare = 0;
+	for (unsigned int i = 0; i < 250000; i++)
+	{
+		event *ev = new event;
+		double pt = 20.0 + dist_pt(rng);
+		ev->push_back(new lhco(ptype_jet, 0.0, 0.0, pt, 10.0));
+		events_many.push_back(ev);
+		nr_rare += pt > 400.0;
+	}
+	plot_set set("../../files/tests/output/");
+	set.add_plot("test_plot_set_rare", new plot_ht(ptype_all), new cut_pt(400, ptype_jet, 1, 5.0));
+	set.add_plot("test_plot_set_all", new plot_ht(ptype_all));
+	set.add_plot("test_plot_set_fixed", new plot_ht(ptype_all)).set_bins(50, 0, 1000);
+	set.add_sample(events_many, "first", 1, 4);
+	set.add_sample(events_many, "second", 1, 4);
+	set.run();
+	ostringstream set_counts;
+	set.write(set_counts);
+	bool test_plot_set_passed = set_counts.str().find("test_plot_set_rare -> " + to_string(nr_rare) + " of") != string::npos;
+	test_plot_set_passed = test_plot_set_passed && is_regular_file("../../files/tests/output/test_plot_set_rare.png");
+	test_plot_set_passed = test_plot_set_passed && is_regular_file("../../files/tests/output/test_plot_set_fixed.png");
+
 	// log results
 	duration = (clock() - clock_old) / static_cast<double>(CLOCKS_PER_SEC);
 	cout << "=====================================================================" << endl;
@@ -85,14 +120,16 @@ int main(int argc, const char* argv[])
 	cout << "Check: previous distributions combined in 2D." << endl;
 	cout << "2D HT vs MET plot (LHE) creation has " << (test_plot_lhe_2d_passed ? "succeeded!" : "failed!") << endl;
 	cout << "Check: previous distributions combined in 2D." << endl;
+	cout << "Plot set with a rare precondition has " << (test_plot_set_passed ? "succeeded!" : "failed!") << endl;
 	cout << "=====================================================================" << endl;
 	
 	// clear remaining event pointers
 	delete_events(events_lhco);
 	delete_events(events_lhe);
+	delete_events(events_many);
 	
 	// return whether tests passed
-	if (test_plot_ht_passed && test_plot_met_passed && test_plot_lhco_2d_passed && test_plot_lhe_2d_passed)
+	if (test_plot_ht_passed && test_plot_met_passed && test_plot_lhco_2d_passed && test_plot_lhe_2d_passed && test_plot_set_passed)
 		return EXIT_SUCCESS;
 	return EXIT_FAILURE;	
 }
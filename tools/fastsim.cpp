@@ -0,0 +1,59 @@
+/* Fast simulation
+ *
+ * Applies the parametrised detector response of a settings file to the events
+ * of an lhe or lhco input file and writes the reconstructed lhco events.
+*/
+
+#include <iostream>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+
+#include "detector/detector_sim.h"
+#include "event/event.h"
+#include "utility/utility.h"
+
+
+using namespace std;
+using namespace analysis;
+
+
+// main program with the detector settings, the input file, the output file
+// and optionally the number of workers and the random seed
+int main(int argc, char* argv[])
+{
+	// make sure there are enough arguments
+	if (argc < 4 || argc > 6) 
+	{
+		cout << "specify the arguments: <settings.cmnd> <input.lhe.gz|input.lhco.gz> <output.lhco.gz> [workers] [seed]" << endl;
+		return EXIT_FAILURE;
+	}
+	string settings_file = argv[1];
+	string input_file = argv[2];
+	string output_file = argv[3];
+	int workers = argc > 4 ? boost::lexical_cast<int>(argv[4]) : 1;
+	unsigned int seed = argc > 5 ? boost::lexical_cast<unsigned int>(argv[5]) : 5489;
+
+	// load the events dependent on whether they are .lhe.gz or .lhco.gz
+	vector<event*> events;
+	if (regex_match(input_file, regex("(.*)(lhe.gz)")))
+		read_lhe(events, input_file);
+	else if (regex_match(input_file, regex("(.*)(lhco.gz)")))
+		read_lhco(events, input_file);
+	else
+	{
+		cout << "Error: input file " << input_file << " is neither .lhe.gz nor .lhco.gz." << endl;
+		return EXIT_FAILURE;
+	}
+
+	// simulate the detector and write the reconstructed events
+	detector_sim detector(settings_file, seed);
+	detector.simulate(events, output_file, workers);
+	cout << "Simulated " << events.size() << " events into " << output_file << endl;
+
+	// clear remaining event pointers
+	delete_events(events);
+	return EXIT_SUCCESS;
+}
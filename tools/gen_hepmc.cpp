@@ -6,8 +6,13 @@
 */
 
 #include <cstdlib>
+#include <future>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <utility>
 
 #include <getopt.h>
 
@@ -19,14 +24,19 @@
 #include "HepMC/GenEvent.h"
 #include "HepMC/IO_GenEvent.h"
 
+#include "utility/utility.h"
+
 using namespace std;
 using namespace boost;
 using namespace boost::filesystem;
 using namespace Pythia8; 
 
 
+// cross section estimation of a merged sample
+void estimate_xsec(const string &settings_file, const string &lhe_file, int njet, bool pythia_fast, int max_events, const string &cache_dir, double &xsec, double &naccept);
+
 // utility functions
-void read_options(int &argc, char* argv[], bool &exit_program, bool &pythia_fast, bool &merging, string &settings_file, string &input_file, string &output_file);
+void read_options(int &argc, char* argv[], bool &exit_program, bool &pythia_fast, bool &merging, string &cache_dir, string &settings_file, string &input_file, string &output_file);
 void print_help();
 void print_version();
 
@@ -37,8 +47,8 @@ int main(int argc, char* argv[])
 	bool exit_program = false;
 	bool pythia_fast = false;
 	bool merging = false;
-	string settings_file, input_file, output_file;
-	read_options(argc, argv, exit_program, pythia_fast, merging, settings_file, input_file, output_file);
+	string cache_dir, settings_file, input_file, output_file;
+	read_options(argc, argv, exit_program, pythia_fast, merging, cache_dir, settings_file, input_file, output_file);
 	
 	// exit program if requested
 	if (exit_program)
@@ -100,59 +110,32 @@ int main(int argc, char* argv[])
 
 	/* cross section estimation procedure */
 	
-	// save estimates in vectors
-	vector< double > xsecLO;
-	vector< double > nAcceptLO;
-	bool fsr, isr, mpi, had;
+	// the estimates (cross section, accepted events) are computed with a separate pythia instance in a thread 
+	// from the highest jet multiplicity downwards, the analysis of a sample starts as soon as its estimate is known
+	std::vector< std::promise< pair<double, double> > > estimates(njetcounterLO + 1);
+	std::vector< std::future< pair<double, double> > > estimatesLO;
+	for (unsigned int njet = 0; njet < estimates.size(); ++njet)
+		estimatesLO.push_back(estimates[njet].get_future());
+	std::thread estimation;
 
 	if (merging)
 	{
 		cout << "\n\n ================ Start cross section estimation ================" << endl << endl;
 		
-		// switch off all showering and MPI when extimating the cross section after the merging scale cut
-		fsr = pythia.flag("PartonLevel:FSR");
-		isr = pythia.flag("PartonLevel:ISR");
-		mpi = pythia.flag("PartonLevel:MPI");
-		had = pythia.flag("HadronLevel:all");
-		pythia.settings.flag("PartonLevel:FSR", false);
-		pythia.settings.flag("PartonLevel:ISR", false);
-		pythia.settings.flag("PartonLevel:MPI", false);
-		pythia.settings.flag("HadronLevel:all", false);
-
-		pythia.settings.flag("Merging:doXSectionEstimate", true);
-
-		for (; njetcounterLO >= 0; --njetcounterLO) 
+		estimation = std::thread([&]()
 		{
-			// set appropriate LHE file name
-			string lhe_file = input_file;
-			if (njetcounterLO > 0)
-				lhe_file.insert(lhe_file.size() - 4, "_j" + boost::lexical_cast<std::string>(njetcounterLO)); // check me
-
-			// LHE initialisation
-			pythia.settings.mode("Merging:nRequested", njetcounterLO);
-			pythia.settings.word("Beams:LHEF", lhe_file);
-			if (!pythia.init(lhe_file))
+			for (int njet = MergingNJetMax; njet >= 0; --njet) 
 			{
-				cout << "Error while initialising Pythia (pythia.init)" << endl;
-				exit (EXIT_FAILURE);
+				// set appropriate LHE file name
+				string lhe_file = input_file;
+				if (njet > 0)
+					lhe_file.insert(lhe_file.size() - 4, "_j" + boost::lexical_cast<std::string>(njet)); // check me
+
+				double xsec, naccept;
+				estimate_xsec(settings_file, lhe_file, njet, pythia_fast, max_events, cache_dir, xsec, naccept);
+				estimates[njet].set_value(make_pair(xsec, naccept));
 			}
-
-			// start event loop
-			for (int iEvent = 0; iEvent < max_events; ++iEvent)
-			{
-				// generate event
-				if (!pythia.next())
-					if (pythia.info.atEndOfFile()) 
-						break;
-			} 
-
-			// store cross section
-			xsecLO.push_back(pythia.info.sigmaGen());
-			nAcceptLO.push_back(pythia.info.nAccepted());
-		} 
-
-		// reset values
-		njetcounterLO = MergingNJetMax;
+		});
 	}
 
 	/* event generation and matching */
@@ -161,7 +144,7 @@ int main(int argc, char* argv[])
 	// cross section and error variables
 	double sigmaTotal = 0.;
 	double errorTotal = 0.;
-	int sizeLO = static_cast<int>(xsecLO.size()), iNow;
+	double normLO = 0.;
 
 	// loop over different LHE files with additional external jets
 	for (; njetcounterLO >= 0; --njetcounterLO)
@@ -174,16 +157,10 @@ int main(int argc, char* argv[])
 		// additional merging settings: LHE input and total jet to be merged
 		if (merging)
 		{
-			// possibly switch showering and multiple interaction back on
-			pythia.settings.flag("Merging:doXSectionEstimate", false);
-			pythia.settings.flag("PartonLevel:FSR", fsr);
-			pythia.settings.flag("PartonLevel:ISR", isr);
-			pythia.settings.flag("PartonLevel:MPI", mpi);
-			pythia.settings.flag("HadronLevel:all", had);
-
 			pythia.settings.mode("Merging:nRequested", njetcounterLO);
 			pythia.settings.word("Beams:LHEF", lhe_file);
-			iNow = sizeLO - 1 - njetcounterLO;
+			pair<double, double> estimate = estimatesLO[njetcounterLO].get();
+			normLO = estimate.first / estimate.second;
 			cout << "\n\nStart analysis of " << njetcounterLO << " jets sample" << endl;
 		}
 
@@ -232,7 +209,7 @@ int main(int argc, char* argv[])
 			double normhepmc;
 			if (merging)
 			{
-				normhepmc = xsecLO[iNow] / nAcceptLO[iNow];
+				normhepmc = normLO;
 				sigmaTotal += weight*normhepmc;
 				errorTotal += Pythia8::pow2(weight*normhepmc);
 				hepmcevt->weights().push_back(weight*normhepmc);
@@ -255,6 +232,9 @@ int main(int argc, char* argv[])
 		}
 	}
 
+	if (estimation.joinable())
+		estimation.join();
+
 	if (merging)
 	{		
 		sigmaTotal *= 1e9;
@@ -267,8 +247,77 @@ int main(int argc, char* argv[])
 	return EXIT_SUCCESS;
 }
 
+// estimates the cross section of a merged sample after the merging scale cut, cached per input and settings
+void estimate_xsec(const string &settings_file, const string &lhe_file, int njet, bool pythia_fast, int max_events, const string &cache_dir, double &xsec, double &naccept)
+{
+	// look up the estimate in the cache
+	path estimate_file;
+	string key;
+	if (!cache_dir.empty())
+	{
+		ostringstream settings;
+		settings << "xsec estimate 1\n";
+		settings << "input " << analysis::hash_file(lhe_file) << " " << njet << "\n";
+		settings << "settings " << analysis::hash_file(settings_file) << " " << max_events << " " << pythia_fast << "\n";
+		key = settings.str();
+
+		ostringstream name;
+		name << "xsec_" << hex << setw(16) << setfill('0') << analysis::hash_string(key) << ".estimate";
+		estimate_file = path(cache_dir) / name.str();
+		if (analysis::read_xsec_estimate(estimate_file, key, xsec, naccept))
+		{
+			cout << "Loaded cross section estimate of " << njet << " jets sample from cache " << estimate_file.string() << endl;
+			return;
+		}
+	}
+
+	// pythia instance of the estimation with the same settings
+	Pythia pythia;
+	pythia.readFile(settings_file);
+	pythia.settings.flag("Print:quiet", true);
+	if (pythia_fast)
+	{
+		pythia.settings.flag("PartonLevel:MPI", false);
+		pythia.settings.flag("PartonLevel:Remnants", false);
+		pythia.settings.flag("Check:Event", false);
+		pythia.settings.flag("HadronLevel:all", false);
+	}
+
+	// switch off all showering and MPI when extimating the cross section after the merging scale cut
+	pythia.settings.flag("PartonLevel:FSR", false);
+	pythia.settings.flag("PartonLevel:ISR", false);
+	pythia.settings.flag("PartonLevel:MPI", false);
+	pythia.settings.flag("HadronLevel:all", false);
+
+	pythia.settings.flag("Merging:doXSectionEstimate", true);
+
+	// LHE initialisation
+	pythia.settings.mode("Merging:nRequested", njet);
+	pythia.settings.word("Beams:LHEF", lhe_file);
+	if (!pythia.init(lhe_file))
+	{
+		cout << "Error while initialising Pythia (pythia.init)" << endl;
+		exit (EXIT_FAILURE);
+	}
+
+	// start event loop
+	for (int iEvent = 0; iEvent < max_events; ++iEvent)
+	{
+		// generate event
+		if (!pythia.next())
+			if (pythia.info.atEndOfFile()) 
+				break;
+	} 
+
+	// store cross section
+	xsec = pythia.info.sigmaGen();
+	naccept = pythia.info.nAccepted();
+	if (!cache_dir.empty())
+		analysis::write_xsec_estimate(estimate_file, key, xsec, naccept);
+}
+
 // reads in the command line options
-void read_options(int &argc, char* argv[], bool &exit_program, bool &pythia_fast, bool &merging, string &settings_file, string &input_file, string &output_file)
+void read_options(int &argc, char* argv[], bool &exit_program, bool &pythia_fast, bool &merging, string &cache_dir, string &settings_file, string &input_file, string &output_file)
 {
 	// values will be set by getopt
 	extern char *optarg; 
@@ -281,6 +330,7 @@ void read_options(int &argc, char* argv[], bool &exit_program, bool &pythia_fast
 		{"version",     	no_argument,       0, 'v'},
 		{"fast",        	no_argument,       0, 'f'},
 		{"merging",        	no_argument,       0, 'm'},
+		{"cache",        	required_argument, 0, 'c'},
 		{0,             	0,                 0, 0  },
 	};
 	
@@ -289,7 +339,7 @@ void read_options(int &argc, char* argv[], bool &exit_program, bool &pythia_fast
 	int arg = 0;
 	while (arg != -1)
 	{
-		arg = getopt_long(argc, argv, "hvfm", longopts, &index);
+		arg = getopt_long(argc, argv, "hvfmc:", longopts, &index);
 		switch (arg)
 		{
 		// check for --help (-h) first and print
@@ -314,6 +364,11 @@ void read_options(int &argc, char* argv[], bool &exit_program, bool &pythia_fast
 			merging = true;
 			break;
 
+		// check for --cache (-c)
+		case 'c':
+			cache_dir = optarg;
+			break;
+
 		// default
 		default:
 			/* EMPTY */;
@@ -355,6 +410,8 @@ void print_help()
 	cout << "  -f, --fast         	turns off Pythia8 advanced options like" << endl;
 	cout << "                       MPI, remnants, hadronlevel, event check" << endl;
 	cout << "  -m, --merging      	turn on Pythia8 merging procedure" << endl;
+	cout << "  -c, --cache=DIR    	reuse merging cross section estimates" << endl;
+	cout << "                       stored in DIR, and store new ones" << endl;
 }
 
 // prints the version output to the screen
@@ -0,0 +1,171 @@
+/* Merge results
+ *
+ * merges the partial histogram and cut & count results of
+ * independent jobs into one results file
+ * 
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <getopt.h>
+
+#include <boost/filesystem.hpp>
+
+#include "utility/utility.h"
+#include "results/results.h"
+
+using namespace std;
+using namespace boost;
+using namespace boost::filesystem;
+using namespace analysis;
+
+
+// utility functions
+void read_options(int &argc, char* argv[], bool &exit_program, bool &recursive, bool &print, string &input_dir, string &output_file);
+void print_help();
+void print_version();
+
+// main program with two arguments representing the input folder 
+// and the output file for the merged results
+int main(int argc, char* argv[])
+{
+	// read command line options
+	bool exit_program = false;
+	bool recursive = false;
+	bool print = false;
+	string input_dir;
+	string output_file;
+	read_options(argc, argv, exit_program, recursive, print, input_dir, output_file);
+	
+	// exit program if requested
+	if (exit_program)
+		return EXIT_SUCCESS;
+		
+	// make sure the output file's directory exists
+	string output_dir = output_file;
+	while (output_dir.size() > 0 && output_dir.back() != '/' && output_dir.back() != '\\')
+		output_dir.erase(output_dir.end() - 1);
+	if (output_dir.size() > 0 && !is_directory(output_dir))
+		create_directory(output_dir);
+	
+	// get the files to load from the folder
+	vector<path> files(get_files(input_dir, ".results", recursive));
+	
+	// merge the partial results and print while loading, the merge is 
+	// associative such that the order of the files does not matter
+	results merged;
+	cout << "Merging files:" << endl;
+	for (unsigned int i = 0; i < files.size(); i++)
+	{
+		cout << "  " << files[i].string() << endl;
+		if (!merged.read(files[i].string()))
+		{
+			cout << "Error: could not merge " << files[i].string() << endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	// print the merged results if requested
+	if (print)
+		merged.print(cout);
+
+	// write the results into the output file and print output file
+	cout << "Done, now writing to:" << endl;
+	cout << "  " << output_file << endl;
+	merged.write(output_file);
+
+	// finished the merging
+	return EXIT_SUCCESS;
+}
+
+// reads in the command line options
+void read_options(int &argc, char* argv[], bool &exit_program, bool &recursive, bool &print, string &input_dir, string &output_file)
+{
+	// values will be set by getopt
+	extern char *optarg; 
+	extern int optind;
+	
+	// program options
+	const struct option longopts[] =
+	{
+		{"help",       no_argument,       0, 'h'},
+		{"version",    no_argument,       0, 'v'},
+		{"recursive",  no_argument,       0, 'r'},
+		{"print",      no_argument,       0, 'p'},
+		{0,            0,                 0, 0  },
+	};
+	
+	// read in the options using getopt_long
+	int index;  
+	int arg = 0;
+	while (arg != -1)
+	{
+		arg = getopt_long(argc, argv, "hvrp", longopts, &index);
+
+		switch (arg)
+		{
+		// check for --help (-h) first and print
+		case 'h':
+			print_help();
+			exit_program = true;
+			return;
+		// check for --version (-v) second and print
+		case 'v':
+			print_version();
+			exit_program = true;
+			return;
+		// check for --recursive (-r)
+		case 'r':
+			recursive = true;
+			break;
+		// check for --print (-p)
+		case 'p':
+			print = true;
+			break;
+		// default
+		default:
+			/* EMPTY */;
+		}
+	}
+	
+	// retrieve the input & output file strings, otherwise print warnings
+	if (argc - optind < 2)
+	{
+		std::cout << "Warning: did not specify either input directory or output file." << std::endl;
+		print_help();
+		exit_program = true;	
+	}
+	else if (argc - optind > 2)
+	{
+		std::cout << "Warning: specified to many arguments." << std::endl;
+		print_help();
+		exit_program = true;	
+	}
+	else
+	{	
+		input_dir = argv[optind];
+		output_file = argv[optind + 1];
+	}	
+}
+
+// prints the help output to the screen
+void print_help()
+{
+	std::cout << "Usage: mergeresults [OPTION]... [INPUT DIR] [OUTPUT FILE]" << std::endl;
+	std::cout << "Merges the partial histogram and cut & count results of independent" << std::endl;
+	std::cout << "jobs from INPUT DIR and writes the resulting file to OUTPUT FILE." << std::endl;
+	std::cout << std::endl;
+	std::cout << "The following options are available:" << std::endl;
+	std::cout << "  -h, --help        display this help and exit" << std::endl;
+	std::cout << "  -v, --version     output version information and exit" << std::endl;
+	std::cout << "  -r, --recursive   also processes files in sub folders" << std::endl;
+	std::cout << "  -p, --print       print a summary of the merged results" << std::endl;
+}
+
+// prints the version output to the screen
+void print_version()
+{
+	std::cout << "mergeresults version 1.0" << std::endl;
+}
@@ -6,12 +6,14 @@
 
 #include <algorithm>
 #include <iostream>
+#include <thread>
 
 #include <boost/filesystem.hpp>
 
 #include "cuts/cuts.h"
 #include "event/event.h"
 #include "plot/plot.h"
+#include "plot/plot_set.h"
 #include "utility/utility.h"
 
 
@@ -23,11 +25,11 @@ using namespace analysis;
 
 // necessary function prototypes
 void read_events(vector<event*> & events, const string & input_file);
-void plot_particle_pt(const vector<event*> & events, const string & output_dir, unsigned int type, unsigned int number);
-void plot_particle_eta(const vector<event*> & events, const string & output_dir, unsigned int type, unsigned int number);
-void plot_particle_phi(const vector<event*> & events, const string & output_dir, unsigned int type, unsigned int number);
-void plot_particle_mass(const vector<event*> & events, const string & output_dir, unsigned int type, const std::vector<int> & comb);
-void plot_event_met(const vector<event*> & events, const string & output_dir);
+void plot_particle_pt(plot_set & plots, observables & obs, unsigned int type, unsigned int number);
+void plot_particle_eta(plot_set & plots, observables & obs, unsigned int type, unsigned int number);
+void plot_particle_phi(plot_set & plots, observables & obs, unsigned int type, unsigned int number);
+void plot_particle_mass(plot_set & plots, observables & obs, unsigned int type, const std::vector<int> & comb);
+void plot_event_met(plot_set & plots, observables & obs);
 
 
 // main program with two arguments representing the input file 
@@ -53,16 +55,28 @@ int main(int argc, char* argv[])
 	vector<event*> events; 	
 	read_events(events, input_file);
 	
+	// all plots are filled in a single pass over the events, the plot set owns their functors and preconditions
+	plot_set plots(output_dir);
+	
+	// the plots register their observables in one registry, which computes each value once per event
+	observables obs;
+	
 	// plot pt, eta and phi of the n leading jets
-	plot_particle_pt(events, output_dir, ptype_jet, 2);
-	plot_particle_eta(events, output_dir, ptype_jet, 3);
-	plot_particle_phi(events, output_dir, ptype_electron | ptype_muon | ptype_tau, 1);
+	plot_particle_pt(plots, obs, ptype_jet, 2);
+	plot_particle_eta(plots, obs, ptype_jet, 3);
+	plot_particle_phi(plots, obs, ptype_electron | ptype_muon | ptype_tau, 1);
 	
 	// plot particle invariant mass combinations
-	plot_particle_mass(events, output_dir, ptype_jet, {1,2});
+	plot_particle_mass(plots, obs, ptype_jet, {1,2});
 	
 	// plot general event variables
-	plot_event_met(events, output_dir);
+	plot_event_met(plots, obs);
+	
+	// fill and draw all plots
+	int workers = max(1u, thread::hardware_concurrency());
+	plots.add_sample(events, "sample", 1, workers);
+	plots.write(cout);
+	plots.run();
 	
 	// clear remaining event pointers
 	delete_events(events);
@@ -95,91 +109,68 @@ void read_events(vector<event*> & events, const string & input_file)
 }
 
 
-void plot_particle_pt(const vector<event*> & events, const string & output_dir, unsigned int type, unsigned int number)
+void plot_particle_pt(plot_set & plots, observables & obs, unsigned int type, unsigned int number)
 {
-	// cut away events that do not have that specific particle
-	cuts cp;	
+	// only events that have that specific particle enter the plot
 	cut_particle *ft_p = new cut_particle(type, number);
-	cp.add_cut(ft_p);
-	const vector<event*> red_events(cp.reduce(events));
 
 	// log details of what is being plotted
-	cout << "plotting pt of particle: " << ptype_to_string(type) << " and number: " << number << " for " << red_events.size() << " events" << endl;
+	cout << "plotting pt of particle: " << ptype_to_string(type) << " and number: " << number << endl;
 	
 	// plot the pt of the nth particle
-	plot_pt *ft_pt = new plot_pt(type, number);
+	plot_pt *ft_pt = new plot_pt(type, number, 5.0, obs);
 	string plot_name = "pt_" + ptype_to_string(type) + "_" + boost::lexical_cast<std::string>(number);
-	plot pt(plot_name, output_dir);
-	pt.add_sample(red_events, ft_pt, "sample");
-	pt.run();
+	plots.add_plot(plot_name, ft_pt, ft_p);
 }
 
-void plot_particle_eta(const vector<event*> & events, const string & output_dir, unsigned int type, unsigned int number)
+void plot_particle_eta(plot_set & plots, observables & obs, unsigned int type, unsigned int number)
 {
-	// cut away events that do not have that specific particle
-	cuts cp;	
+	// only events that have that specific particle enter the plot
 	cut_particle *ft_p = new cut_particle(type, number);
-	cp.add_cut(ft_p);
-	const vector<event*> red_events(cp.reduce(events));
 
 	// log details of what is being plotted
-	cout << "plotting pt of particle: " << ptype_to_string(type) << " and number: " << number << " for " << red_events.size() << " events" << endl;
+	cout << "plotting eta of particle: " << ptype_to_string(type) << " and number: " << number << endl;
 	
-	// plot the pt of the nth particle
-	plot_eta *ft_eta = new plot_eta(type, number);
+	// plot the eta of the nth particle
+	plot_eta *ft_eta = new plot_eta(type, number, obs);
 	string plot_name = "eta_" + ptype_to_string(type) + "_" + boost::lexical_cast<std::string>(number);
-	plot eta(plot_name, output_dir);
-	eta.add_sample(red_events, ft_eta, "sample");
-	eta.run();
+	plots.add_plot(plot_name, ft_eta, ft_p);
 }
 
-void plot_particle_phi(const vector<event*> & events, const string & output_dir, unsigned int type, unsigned int number)
+void plot_particle_phi(plot_set & plots, observables & obs, unsigned int type, unsigned int number)
 {
-	// cut away events that do not have that specific particle
-	cuts cp;	
+	// only events that have that specific particle enter the plot
 	cut_particle *ft_p = new cut_particle(type, number);
-	cp.add_cut(ft_p);
-	const vector<event*> red_events(cp.reduce(events));
 
 	// log details of what is being plotted
-	cout << "plotting pt of particle: " << ptype_to_string(type) << " and number: " << number << " for " << red_events.size() << " events" << endl;
+	cout << "plotting phi of particle: " << ptype_to_string(type) << " and number: " << number << endl;
 	
-	// plot the pt of the nth particle
-	plot_phi *ft_phi = new plot_phi(type, number);
+	// plot the phi of the nth particle
+	plot_phi *ft_phi = new plot_phi(type, number, obs);
 	string plot_name = "phi_" + ptype_to_string(type) + "_" + boost::lexical_cast<std::string>(number);
-	plot phi(plot_name, output_dir);
-	phi.add_sample(red_events, ft_phi, "sample");
-	phi.run();
+	plots.add_plot(plot_name, ft_phi, ft_p);
 }
 
-void plot_particle_mass(const vector<event*> & events, const string & output_dir, unsigned int type, const std::vector<int> & comb)
+void plot_particle_mass(plot_set & plots, observables & obs, unsigned int type, const std::vector<int> & comb)
 {
-	// cut away events that do not have that specific particle
-	cuts cp;	
+	// only events that have all particles of the combination enter the plot
 	cut_particle *ft_p = new cut_particle(type, *max_element(comb.begin(), comb.end()));
-	cp.add_cut(ft_p);
-	const vector<event*> red_events(cp.reduce(events));
 	
 	// log details of what is being plotted
-	cout << "plotting invariant mass of particle: " << ptype_to_string(type) << " and comb: " << "TODO" << " for " << red_events.size() << " events" << endl;
+	cout << "plotting invariant mass of particle: " << ptype_to_string(type) << " and comb: " << "TODO" << endl;
 	
 	// plot the invariant mass of the combination
-	plot_mass *ft_mass = new plot_mass(type, comb);
+	plot_mass *ft_mass = new plot_mass(type, comb, obs);
 	string plot_name = "mass_" + ptype_to_string(type) + "_" + boost::lexical_cast<std::string>("{1,2}");
-	plot mass(plot_name, output_dir);
-	mass.add_sample(red_events, ft_mass, "sample");
-	mass.run();	
+	plots.add_plot(plot_name, ft_mass, ft_p);
 }
 
-void plot_event_met(const vector<event*> & events, const string & output_dir)
+void plot_event_met(plot_set & plots, observables & obs)
 {
 	// log details of what is being plotted
-	cout << "plotting met for " << events.size() << " events" << endl;
+	cout << "plotting met" << endl;
 	
 	// plot the met of the event
-	plot_met *ft_met = new plot_met();
-	plot met("met", output_dir);
-	met.add_sample(events, ft_met, "sample");
-	met.run();
+	plot_met *ft_met = new plot_met(obs);
+	plots.add_plot("met", ft_met);
 }
-
@@ -15,6 +15,7 @@
 
 #include "particle/lhco.h"
 #include "particle/particle.h"
+#include "particle/eta_phi_list.h"
 #include "event/event.h"
 #include "utility/utility.h"
 #include "cuts/cuts.h"
@@ -22,6 +23,8 @@
 #include "plot/plot2d.h"
 #include "jet_analysis/jet_analysis.h"
 
+#include "tztag_candidates.h"
+
 using namespace std;
 using namespace boost;
 using namespace boost::filesystem;
@@ -32,48 +35,34 @@ using namespace analysis;
 // function prototypes
 bool load_settings_input(const string &settings_file, string &input_sig_lhe, string &input_sig_lhco, double &sig_xsec, int &nr_events);
 bool load_settings_output(const string &settings_file, string &output_lhco, string &output_xsec);
-bool load_settings_merging(const string &settings_file, bool &pythia_fast, bool &merging_on, string &merging_process, int &merging_njets, double &merging_scale);
-vector<const particle*> identify_candidate_leptons(const vector<const particle*> & leptons);
-PseudoJet identify_candidate_top(const vector<PseudoJet> & fatjets, vector<const particle*> & leptons);
+bool load_settings_merging(const string &settings_file, bool &pythia_fast, int &pythia_workers, string &pythia_cache, bool &merging_on, string &merging_process, int &merging_njets, double &merging_scale);
+void reconstruct_top_candidates(jet_analysis &analysis);
 double cut_ptT(jet_analysis &analysis, double pt_min);
 double cut_etaT(jet_analysis &analysis, double eta_max);
 double cut_deltaRtb(jet_analysis &analysis, double delta_r);
-void get_top_partner_constituents(const vector<event*> &signal_lhco, const vector<vector<PseudoJet> > &signal_fatjets, vector<event*> &signal_reconstructed);
+void get_top_partner_constituents(const tagged_view<event*> &signal_lhco, vector<event*> &signal_reconstructed);
 
 // basic cut: at least two opposite sign leptons need to be present, with invariant mass near the Z boson
+// the cut reconstructs the candidates of the events, which the Z and top cuts on this sample read
 class cut_2osl : public cut
 {
 public:
-	cut_2osl(double pt, double eta) : pt_min(pt), eta_max(eta) {}
+	cut_2osl(double pt, double eta, double RLL) : pt_min(pt), eta_max(eta), RLL_max(RLL) {}
+
+	void prepare(const vector<event*> &events)
+	{
+		reconstruct_candidates(events, RLL_max, pt_min, eta_max);
+	}
 
 	bool operator() (const event *ev) 
 	{ 
-		// extract all visible leptons
-		vector<const particle*> leptons;
-		for (unsigned int i = 0; i < ev->size(); ++i)
-		{
-			if ((*ev)[i]->type() & ptype_lepton && (*ev)[i]->pt() > pt_min && abs((*ev)[i]->eta()) < eta_max)
-				leptons.push_back((*ev)[i]);
-		}
-
-		// check whether at least two visible leptons are present
-		if (leptons.size() < 2)
-			return false;
-
-		// identify lepton candidates
-		vector<const particle*> l_candidates = identify_candidate_leptons(leptons);
-		const particle *first_l = l_candidates[0];
-		const particle *second_l = l_candidates[1];
-		
-		if (first_l == nullptr || second_l == nullptr)
-			return false;
-		
-		// cut passed
-		return true;
+		// cut passed if the Z boson candidate was reconstructed
+		return candidates(ev).has_Z();
 	}
 private:
 	double pt_min;
 	double eta_max;
+	double RLL_max;
 };
 
 // basic cut: pt of the reconstructed Z boson
@@ -84,26 +73,8 @@ public:
 
 	bool operator() (const event *ev) 
 	{ 
-		// extract all visible leptons
-		vector<const particle*> leptons;
-		for (unsigned int i = 0; i < ev->size(); ++i)
-		{
-			if ((*ev)[i]->type() & ptype_lepton && (*ev)[i]->pt() > 25. && abs((*ev)[i]->eta()) < 2.5)
-				leptons.push_back((*ev)[i]);
-		}
-
-		// identify lepton candidates (notice that the osl leptons reconstructing the Z need to be present)
-		vector<const particle*> l_candidates = identify_candidate_leptons(leptons);
-		const particle *first_l = l_candidates[0];
-		const particle *second_l = l_candidates[1];
-		
-		// reconstruct Z-boson transverse momentum
-		double px_Z = first_l->px() + second_l->px();
-		double py_Z = first_l->py() + second_l->py();
-		double pt_Z = sqrt(pow(px_Z, 2.0) + pow(py_Z, 2.0));
-
-		// check if pT(Z) > pt_min
-		if (pt_Z < pt_min)
+		// check if pT(Z) > pt_min (notice that the Z candidate needs to be present)
+		if (candidates(ev).Z.pt() < pt_min)
 			return false;
 		
 		// cut passed
@@ -121,31 +92,8 @@ public:
 
 	bool operator() (const event *ev) 
 	{ 
-		// extract all visible leptons
-		vector<const particle*> leptons;
-		for (unsigned int i = 0; i < ev->size(); ++i)
-		{
-			if ((*ev)[i]->type() & ptype_lepton && (*ev)[i]->pt() > 25. && abs((*ev)[i]->eta()) < 2.5)
-				leptons.push_back((*ev)[i]);
-		}
-
-		// identify lepton candidates (notice that the osl leptons reconstructing the Z need to be present)
-		vector<const particle*> l_candidates = identify_candidate_leptons(leptons);
-		const particle *first_l = l_candidates[0];
-		const particle *second_l = l_candidates[1];
-		
-		// reconstruct Z-boson 4-vector
-		const double px_Z = first_l->px() + second_l->px();
-		const double py_Z = first_l->py() + second_l->py();
-		const double pz_Z = first_l->pz() + second_l->pz();
-		const double pe_Z = first_l->pe() + second_l->pe();
-		PseudoJet Zboson(px_Z, py_Z, pz_Z, pe_Z);
-
-		// extract eta of Z
-		double eta_Z = abs(Zboson.eta());
-
-		// check if eta(Z) < eta_max
-		if (eta_Z > eta_max)
+		// check if eta(Z) < eta_max (notice that the Z candidate needs to be present)
+		if (abs(candidates(ev).Z.eta()) > eta_max)
 			return false;
 		
 		// cut passed
@@ -237,10 +185,12 @@ int main(int argc, const char* argv[])
 		return EXIT_FAILURE;		
 	// read the merging settings from command file
 	bool pythia_fast = false, merging_on = false;
+	int pythia_workers = 1;
+	string pythia_cache;
 	string merging_process;
 	int merging_njets = 2;
 	double merging_scale = 0;
-	if (!load_settings_merging(settings_file, pythia_fast, merging_on, merging_process, merging_njets, merging_scale))
+	if (!load_settings_merging(settings_file, pythia_fast, pythia_workers, pythia_cache, merging_on, merging_process, merging_njets, merging_scale))
 		return EXIT_FAILURE;
 
 	// jet_analysis initialisation (settings, load files, shower and cluster the events)
@@ -251,6 +201,9 @@ int main(int argc, const char* argv[])
 	PseudoJet (jet_analysis::*TopTagger)(const PseudoJet &) = &jet_analysis::HEPTopTagging;
 	if (pythia_fast)
 		thth_tztz.set_fast_showering();
+	thth_tztz.set_nWorkers(pythia_workers);
+	if (!pythia_cache.empty())
+		thth_tztz.set_cache(pythia_cache);
 
 	thth_tztz.import_lhe(input_lhe);
 	thth_tztz.import_lhco(input_lhco);
@@ -265,7 +218,7 @@ int main(int argc, const char* argv[])
 
 	// basic cuts definition
 	cuts basic_cuts;
-	cut_2osl *osl = new cut_2osl(25, 2.5);
+	cut_2osl *osl = new cut_2osl(25, 2.5, 1.0);
 	basic_cuts.add_cut(osl, "2 opposite sign leptons within R=1.0 cone");
 	cut_ptZ *ptZ = new cut_ptZ(225);
 	basic_cuts.add_cut(ptZ, "pT(Z)>225 GeV");
@@ -282,10 +235,11 @@ int main(int argc, const char* argv[])
 	double eff_basic = thth_tztz.reduce_sample(basic_cuts); // require: 2 osl which reconstruct a Z, pT(Z), eta(Z), HT, nj, nb, pT(b) cuts
 	double eff_fatjpt = thth_tztz.require_fatjet_pt(200, 1); // require at least 1 fatjet with pT>200 GeV
 	double eff_ttag = thth_tztz.require_top_tagged(1); // require at least 1 fatjet to be HEP Top-Tagged
+	reconstruct_top_candidates(thth_tztz); // top candidate of the tagged fatjets most back-to-back wrt the Z
 	double eff_ptT = cut_ptT(thth_tztz, 250); // require pT(t)>250 GeV
 	double eff_deltaRtb = cut_deltaRtb(thth_tztz, 0.8); // require deltaR(t, b)<0.8 for at least one b-jet
 
-	unsigned int remaining_events = thth_tztz.map_lhco_taggedJets.size();
+	unsigned int remaining_events = thth_tztz.nr_selected();
 	cout << "\nFatjet pT>200 GeV Efficiency: " << setprecision(4) << 100 * eff_fatjpt << " %" << endl;
 	cout << "\nTop Tagging Efficiency: " << setprecision(4) << 100 * eff_ttag << " %" << endl;
 	cout << "\npT(t)>250 GeV Efficiency: " << setprecision(4) << 100 * eff_ptT << " %" << endl;
@@ -295,7 +249,7 @@ int main(int argc, const char* argv[])
 	
 	// identify top partner constituents
 	vector<event*> signal_reconstructed;
-	get_top_partner_constituents(thth_tztz.events(), thth_tztz.fatjets(), signal_reconstructed);
+	get_top_partner_constituents(thth_tztz.events(), signal_reconstructed);
 	
 	// calculate cross section and store
 	ofstream ofs_txt;
@@ -361,10 +315,12 @@ bool load_settings_output(const string &settings_file, string &output_lhco, stri
 	return true;	
 }
 
-bool load_settings_merging(const string &settings_file, bool &pythia_fast, bool &merging_on, string &merging_process, int &merging_njets, double &merging_scale)
+bool load_settings_merging(const string &settings_file, bool &pythia_fast, int &pythia_workers, string &pythia_cache, bool &merging_on, string &merging_process, int &merging_njets, double &merging_scale)
 {
 	// read merging settings
 	pythia_fast = read_settings<bool>(settings_file, static_cast<string>("PYTHIA_FAST"));
+	pythia_workers = read_settings<int>(settings_file, static_cast<string>("PYTHIA_WORKERS"), 1);
+	pythia_cache = read_settings<string>(settings_file, static_cast<string>("PYTHIA_CACHE"));
 	merging_on = read_settings<bool>(settings_file, static_cast<string>("MERGING_ON"));
 	merging_process = read_settings<string>(settings_file, static_cast<string>("MERGING_PROCESS"));
 	merging_njets = read_settings<int>(settings_file, static_cast<string>("MERGING_NJETS"));
@@ -374,6 +330,8 @@ bool load_settings_merging(const string &settings_file, bool &pythia_fast, bool
 	cout << "################################################################################" << endl;
 	cout << "Loaded merging settings from " << settings_file << ":" << endl;
 	cout << "Pythia fast: " << pythia_fast << endl;
+	cout << "Pythia workers: " << pythia_workers << endl;
+	cout << "Pythia cache: " << pythia_cache << endl;
 	cout << "Merging on: " << merging_on << endl;
 	cout << "Merging process: " << merging_process << endl;
 	cout << "Merging nr. jets: " << merging_njets << endl;
@@ -382,266 +340,112 @@ bool load_settings_merging(const string &settings_file, bool &pythia_fast, bool
 	return true;
 }
 
-// identify lepton candidates to reconstruct the Z boson
-vector<const particle*> identify_candidate_leptons(const vector<const particle*> & leptons)
+// add the top candidate to the reconstructed candidates of the selected events
+void reconstruct_top_candidates(jet_analysis &analysis)
 {
-	const particle *candidate1 = nullptr;
-	const particle *candidate2 = nullptr;
-
-	double delta_r_max = 1.0;
-	double mz = 91.1876;
-	double mass_range = 10.;
-	double mass_diff_min = 1000.;
-
-	for (unsigned int i = 0; i < leptons.size()-1; ++i)
+	tagged_view<event*> events = analysis.events();
+	tagged_view<vector<PseudoJet> > fatjets = analysis.fatjets();
+	for (unsigned int i = 0; i < events.size(); ++i)
 	{
-		const particle *first_l = leptons[i];
-
-		for (unsigned int j = i+1; j < leptons.size(); ++j)
+		// identify top-tagged jets
+		vector< PseudoJet > topjets;
+		for (unsigned int j = 0; j < fatjets[i].size(); ++j)
 		{
-			const particle *second_l = leptons[j];
-
-			// same flavour required
-			if (second_l->type() != first_l->type())
-				continue;
-			
-			// opposite charge required
-			if (second_l->charge() + first_l->charge() != 0)
-				continue;
-
-			// delta_r < delta_r_max required
-			if (delta_r(first_l, second_l) > delta_r_max)
-				continue;
-
-			// inv. mass required to be within 10 GeV from mZ
-			double inv_mass = mass({first_l, second_l});
-			if (abs(inv_mass - mz) > mass_range)
-				continue;
-
-			// select osl leptons with inv. mass closest to mZ
-			if (abs(inv_mass - mz) < mass_diff_min)
-			{
-				candidate1 = first_l;
-				candidate2 = second_l;
-				mass_diff_min = abs(inv_mass - mz);
-			}
-				 
-		} // end second loop over leptons
-		
-	} // end first loop over leptons
-
-	// return lepton candidates
-	vector<const particle*> l_candidates;
-	l_candidates.push_back(candidate1);
-	l_candidates.push_back(candidate2);
-	return l_candidates;
-}
-
-// identify top candidate most back-to-back wrt the reconstructed Z
-PseudoJet identify_candidate_top(const vector<PseudoJet> & fatjets, vector<const particle*> & leptons)
-{
-	// reconstruct ideal back-to-back top wrt Z-boson
-	const double px_Z = leptons[0]->px() + leptons[1]->px();
-	const double py_Z = leptons[0]->py() + leptons[1]->py();
-	const double pz_Z = leptons[0]->pz() + leptons[1]->pz();
-	const double pe_Z = leptons[0]->pe() + leptons[1]->pe();
-	PseudoJet Ideal_T(-px_Z, -py_Z, -pz_Z, pe_Z);
-
-	// identify top-tagged jets
-	vector< PseudoJet > topjets;
-	for (unsigned int i = 0; i < fatjets.size(); ++i)
-	{
-		if (fatjets[i].user_info<TagInfo>().top_tag())
-			topjets.push_back(fatjets[i]);
-	}
-
-	// identify top candidate
-	PseudoJet top_candidate;
-	double delta_r_min = 1000.;
-	for (unsigned int i = 0; i < topjets.size(); ++i)
-	{
-		// deltaR between top candidate and back-to-back ideal direction
-		double deltaEta = topjets[i].eta() - Ideal_T.eta();
-		double deltaPhi = abs(topjets[i].phi() - Ideal_T.phi());
-		deltaPhi = min(deltaPhi, 8 * atan(1) - deltaPhi);
-		double deltaR = sqrt( pow(deltaEta,2.0) + pow(deltaPhi,2.0) );
-
-		// minimize deltaR
-		if (deltaR < delta_r_min)
-		{
-			delta_r_min = deltaR;
-			top_candidate = topjets[i];
+			if (fatjets[i][j].user_info<TagInfo>().top_tag())
+				topjets.push_back(fatjets[i][j]);
 		}
+		reconstruct_top_candidate(events[i], topjets);
 	}
-
-	// return top candidate
-	return top_candidate;
 }
 
-// cut: require pT(t)>pT_min
-double cut_ptT(jet_analysis &analysis, double pt_min)
+// requirement: pT(t)>pT_min
+class tagged_ptT : public tagged_cut
 {
-	map< event *, vector< PseudoJet > >::iterator it;
-	map< event *, vector< PseudoJet > > original_map = analysis.map_lhco_taggedJets;
-	map< event *, vector< PseudoJet > > reduced_map;
-	int map_size = 0, passed = 0;
-	double eff;
+public:
+	tagged_ptT(double pt) : pt_min(pt) {}
 
-	// loop over events
-	for (it=original_map.begin(); it!=original_map.end(); ++it)
+	bool operator() (const tagged_event & record)
 	{
-		map_size++;
-
-		// extract lepton candidates
-		event *ev = it->first;
-		vector< const particle* > leptons;
-		for (unsigned int j = 0; j < ev->size(); ++j)
-		{
-			if ((*ev)[j]->type() & ptype_lepton && (*ev)[j]->pt() > 25. && abs((*ev)[j]->eta()) < 2.5)
-				leptons.push_back((*ev)[j]);
-		}		
-		vector<const particle*> l_candidates = identify_candidate_leptons(leptons);
-
-		// identify top candidate		
-		vector< PseudoJet > fatjets = it->second;
-		PseudoJet top_candidate = identify_candidate_top(fatjets, l_candidates);
-
 		// evaluate pT(t): the cut is passed if pT(t)>pT_min
-		double pt_T = top_candidate.pt();
-		if (pt_T > pt_min)
-		{
-			passed++;
-			reduced_map.insert( make_pair(it->first,it->second) );
-		}
-
+		return candidates(record.ev).T.pt() > pt_min;
 	}
+private:
+	double pt_min;
+};
 
-	// calculate efficiency
-	eff = (map_size == 0 ? 0.0 : static_cast<double>(passed) / map_size);
-
-	// resize the map_lhco_taggedJets
-	analysis.map_lhco_taggedJets = reduced_map;
-
-	return eff;
-}
-
-// cut: require eta(t)<eta_max
-double cut_etaT(jet_analysis &analysis, double eta_max)
+// requirement: eta(t)<eta_max
+class tagged_etaT : public tagged_cut
 {
-	map< event *, vector< PseudoJet > >::iterator it;
-	map< event *, vector< PseudoJet > > original_map = analysis.map_lhco_taggedJets;
-	map< event *, vector< PseudoJet > > reduced_map;
-	int map_size = 0, passed = 0;
-	double eff;
+public:
+	tagged_etaT(double eta) : eta_max(eta) {}
 
-	// loop over events
-	for (it=original_map.begin(); it!=original_map.end(); ++it)
+	bool operator() (const tagged_event & record)
 	{
-		map_size++;
-
-		// extract lepton candidates
-		event *ev = it->first;
-		vector< const particle* > leptons;
-		for (unsigned int j = 0; j < ev->size(); ++j)
-		{
-			if ((*ev)[j]->type() & ptype_lepton && (*ev)[j]->pt() > 25. && abs((*ev)[j]->eta()) < 2.5)
-				leptons.push_back((*ev)[j]);
-		}		
-		vector<const particle*> l_candidates = identify_candidate_leptons(leptons);
-
-		// identify top candidate		
-		vector< PseudoJet > fatjets = it->second;
-		PseudoJet top_candidate = identify_candidate_top(fatjets, l_candidates);
-
 		// evaluate eta(t): the cut is passed if eta(t)<eta_max
-		double eta_T = abs(top_candidate.eta());
-		if (eta_T < eta_max)
-		{
-			passed++;
-			reduced_map.insert( make_pair(it->first,it->second) );
-		}
-
+		return abs(candidates(record.ev).T.eta()) < eta_max;
 	}
+private:
+	double eta_max;
+};
 
-	// calculate efficiency
-	eff = (map_size == 0 ? 0.0 : static_cast<double>(passed) / map_size);
-
-	// resize the map_lhco_taggedJets
-	analysis.map_lhco_taggedJets = reduced_map;
-
-	return eff;
-}
-
-// cut: require deltaR(t, b)<delta_r for at least one b-jet
-double cut_deltaRtb(jet_analysis &analysis, double delta_r)
+// requirement: deltaR(t, b)<delta_r for at least one b-jet
+class tagged_deltaRtb : public tagged_cut
 {
-	map< event *, vector< PseudoJet > >::iterator it;
-	map< event *, vector< PseudoJet > > original_map = analysis.map_lhco_taggedJets;
-	map< event *, vector< PseudoJet > > reduced_map;
-	int map_size = 0, passed = 0;
-	double eff;
+public:
+	tagged_deltaRtb(double r) : delta_r(r) {}
 
-	// loop over events
-	for (it=original_map.begin(); it!=original_map.end(); ++it)
+	bool operator() (const tagged_event & record)
 	{
-		map_size++;
-
-		// extract lepton candidates
-		event *ev = it->first;
-		vector< const particle* > leptons;
-		for (unsigned int j = 0; j < ev->size(); ++j)
-		{
-			if ((*ev)[j]->type() & ptype_lepton && (*ev)[j]->pt() > 25. && abs((*ev)[j]->eta()) < 2.5)
-				leptons.push_back((*ev)[j]);
-		}		
-		vector<const particle*> l_candidates = identify_candidate_leptons(leptons);
-
-		// identify top candidate		
-		vector< PseudoJet > fatjets = it->second;
-		PseudoJet top_candidate = identify_candidate_top(fatjets, l_candidates);
-		double	top_eta = top_candidate.eta(), 
-				top_phi = top_candidate.phi();
+		const PseudoJet & top_candidate = candidates(record.ev).T;
+		eta_phi_list top_eta_phi;
+		top_eta_phi.add(top_candidate.eta(), top_candidate.phi());
 
 		// extract all visible b-jets
-		vector<const particle*> bjets;
+		const event *ev = record.ev;
+		eta_phi_list bjet_eta_phi;
 		for (unsigned int j = 0; j < ev->size(); ++j)
 		{
 			if ((*ev)[j]->bjet() != 0.0 && (*ev)[j]->pt() > 30. && abs((*ev)[j]->eta()) < 2.5)
-				bjets.push_back((*ev)[j]);
+				bjet_eta_phi.add((*ev)[j]);
 		}
 
 		// evaluate deltaR(t, b): the cut is passed if at least one b-jet is within a cone of delta_r wrt the reconstructed top
-		for (unsigned int j = 0; j < bjets.size(); ++j)
+		vector<double> dr2;
+		top_eta_phi.delta_r2(bjet_eta_phi, dr2);
+		for (unsigned int j = 0; j < dr2.size(); ++j)
 		{
-			double	b_eta = bjets[j]->eta(), 
-					b_phi = bjets[j]->phi();
-
-			double deltaEta = top_eta - b_eta;
-			double deltaPhi = abs(top_phi - b_phi);
-			deltaPhi = min(deltaPhi, 8 * atan(1) - deltaPhi);
-			double deltaR = sqrt( pow(deltaEta,2.0) + pow(deltaPhi,2.0) );
-
-			if (deltaR < delta_r)
-			{
-				passed++;
-				reduced_map.insert( make_pair(it->first,it->second) );
-				break;
-			}		
+			if (dr2[j] < delta_r * delta_r)
+				return true;
 		}
-
+		return false;
 	}
+private:
+	double delta_r;
+};
 
-	// calculate efficiency
-	eff = (map_size == 0 ? 0.0 : static_cast<double>(passed) / map_size);
+// cut: require pT(t)>pT_min
+double cut_ptT(jet_analysis &analysis, double pt_min)
+{
+	tagged_ptT requirement(pt_min);
+	return analysis.require(requirement);
+}
 
-	// resize the map_lhco_taggedJets
-	analysis.map_lhco_taggedJets = reduced_map;
+// cut: require eta(t)<eta_max
+double cut_etaT(jet_analysis &analysis, double eta_max)
+{
+	tagged_etaT requirement(eta_max);
+	return analysis.require(requirement);
+}
 
-	return eff;
+// cut: require deltaR(t, b)<delta_r for at least one b-jet
+double cut_deltaRtb(jet_analysis &analysis, double delta_r)
+{
+	tagged_deltaRtb requirement(delta_r);
+	return analysis.require(requirement);
 }
 
 // reconstruct top partner consistituents
-void get_top_partner_constituents(const vector<event*> &signal_lhco, const vector<vector<PseudoJet> > &signal_fatjets, vector<event*> &signal_reconstructed)
+void get_top_partner_constituents(const tagged_view<event*> &signal_lhco, vector<event*> &signal_reconstructed)
 {
 	// loop over events
 	for (unsigned int i = 0; i < signal_lhco.size(); ++i)
@@ -649,14 +453,9 @@ void get_top_partner_constituents(const vector<event*> &signal_lhco, const vecto
 		event *newev = new event();
 
 		// extract lepton candidates
-		event *ev = signal_lhco[i];
-		vector< const particle* > leptons;
-		for (unsigned int j = 0; j < ev->size(); ++j)
-		{
-			if ((*ev)[j]->type() & ptype_lepton && (*ev)[j]->pt() > 25. && abs((*ev)[j]->eta()) < 2.5)
-				leptons.push_back((*ev)[j]);
-		}		
-		vector<const particle*> l_candidates = identify_candidate_leptons(leptons);
+		const event *ev = signal_lhco[i];
+		const tztag_candidates & cand = candidates(ev);
+		vector<const particle*> l_candidates = {(*ev)[cand.lepton1], (*ev)[cand.lepton2]};
 		for (unsigned int j = 0; j < l_candidates.size(); ++j)
 		{
 			int p_type = ptype_electron;
@@ -670,8 +469,7 @@ void get_top_partner_constituents(const vector<event*> &signal_lhco, const vecto
 		}
 
 		// extract top candidate		
-		vector< PseudoJet > fatjets = signal_fatjets[i];
-		PseudoJet top_candidate = identify_candidate_top(fatjets, l_candidates);
+		const PseudoJet & top_candidate = cand.T;
 		int p_type = ptype_jet;
 		double	p_eta 	= top_candidate.eta(), 
 				p_phi 	= top_candidate.phi(), 
@@ -0,0 +1,180 @@
+/* thth->tztz candidates
+ *
+ * Reconstruction stage of the tztag analyses: the Z boson candidate from an
+ * opposite sign same flavour lepton pair, the leading b-jet and the top candidate
+ * from the top-tagged fat jets are built once per event and attached to it, the 
+ * cuts and plots read them there.
+*/
+
+#ifndef INC_TZTAG_CANDIDATES
+#define INC_TZTAG_CANDIDATES
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "fastjet/PseudoJet.hh"
+
+#include "particle/particle.h"
+#include "particle/eta_phi_list.h"
+#include "event/event.h"
+
+
+// candidates of an event, stored as particle indices which are -1 if not found
+class tztag_candidates : public analysis::event_info
+{
+public:
+	tztag_candidates() : lepton1(-1), lepton2(-1), bjet(-1), top_found(false) {}
+
+	tztag_candidates* clone() const { return new tztag_candidates(*this); }
+
+	bool has_Z() const { return lepton1 >= 0; }
+	bool has_bjet() const { return bjet >= 0; }
+	bool has_top() const { return top_found; }
+
+	int lepton1, lepton2;
+	int bjet;
+
+	// Z boson 4-vector of the lepton pair
+	fastjet::PseudoJet Z;
+
+	// top candidate 4-vector of a top-tagged fat jet
+	bool top_found;
+	fastjet::PseudoJet T;
+};
+
+// reconstructs the candidates of an event: the Z boson from the same flavour opposite sign
+// leptons (pt > lepton_pt, |eta| < lepton_eta, deltaR < RLL_max) with invariant mass closest
+// to mZ and at most 10 GeV away from it and the leading b-jet with pt > 30 GeV and |eta| < 2.8;
+// the top candidate is added by reconstruct_top_candidate
+inline void reconstruct_candidates(analysis::event *ev, double RLL_max = std::numeric_limits<double>::infinity(), double lepton_pt = 25., double lepton_eta = 2.5)
+{
+	using namespace analysis;
+	tztag_candidates *candidates = new tztag_candidates;
+
+	// visible leptons and their pairwise deltaR^2
+	std::vector<int> leptons;
+	eta_phi_list lepton_eta_phi;
+	for (unsigned int i = 0; i < ev->size(); ++i)
+	{
+		if ((*ev)[i]->type() & ptype_lepton && (*ev)[i]->pt() > lepton_pt && std::abs((*ev)[i]->eta()) < lepton_eta)
+		{
+			leptons.push_back(i);
+			lepton_eta_phi.add((*ev)[i]);
+		}
+	}
+	std::vector<double> lepton_dr2;
+	lepton_eta_phi.delta_r2(lepton_dr2);
+	double RLL2_max = RLL_max * RLL_max;
+
+	// lepton pair closest to mZ
+	double mz = 91.1876;
+	double mass_range = 10.;
+	double mass_diff_min = 1000.;
+	for (unsigned int i = 0; i + 1 < leptons.size(); ++i)
+	{
+		const particle *first_l = (*ev)[leptons[i]];
+
+		for (unsigned int j = i+1; j < leptons.size(); ++j)
+		{
+			const particle *second_l = (*ev)[leptons[j]];
+
+			// same flavour and opposite charge required
+			if (second_l->type() != first_l->type() || second_l->charge() + first_l->charge() != 0)
+				continue;
+
+			// delta_r < RLL_max required
+			if (lepton_dr2[i * leptons.size() + j] > RLL2_max)
+				continue;
+
+			// inv. mass required to be within 10 GeV from mZ
+			double mass_diff = std::abs(mass({first_l, second_l}) - mz);
+			if (mass_diff > mass_range || mass_diff >= mass_diff_min)
+				continue;
+
+			candidates->lepton1 = leptons[i];
+			candidates->lepton2 = leptons[j];
+			mass_diff_min = mass_diff;
+		}
+	}
+	if (candidates->has_Z())
+	{
+		const particle *first_l = (*ev)[candidates->lepton1];
+		const particle *second_l = (*ev)[candidates->lepton2];
+		candidates->Z = fastjet::PseudoJet(first_l->px() + second_l->px(), first_l->py() + second_l->py(), first_l->pz() + second_l->pz(), first_l->pe() + second_l->pe());
+	}
+
+	// leading b-jet, the particles are sorted in pt
+	for (unsigned int i = 0; i < ev->size() && candidates->bjet < 0; ++i)
+	{
+		if ((*ev)[i]->bjet() != 0.0 && std::abs((*ev)[i]->eta()) < 2.8 && (*ev)[i]->pt() > 30)
+			candidates->bjet = i;
+	}
+
+	ev->set_info(candidates);
+}
+
+inline void reconstruct_candidates(const std::vector<analysis::event*> & events, double RLL_max = std::numeric_limits<double>::infinity(), double lepton_pt = 25., double lepton_eta = 2.5)
+{
+	for (unsigned int i = 0; i < events.size(); ++i)
+		reconstruct_candidates(events[i], RLL_max, lepton_pt, lepton_eta);
+}
+
+// adds the top candidate to the reconstructed candidates of an event: of the top-tagged fat
+// jets the one closest in deltaR to the direction opposite to the Z candidate, or the leading
+// one if there is no Z candidate
+inline void reconstruct_top_candidate(analysis::event *ev, const std::vector<fastjet::PseudoJet> & top_jets)
+{
+	using namespace analysis;
+	const tztag_candidates *reconstructed = ev->info<tztag_candidates>();
+	if (reconstructed == nullptr)
+	{
+		std::cout << "Error: the top candidate needs the reconstructed tztag candidates of the event." << std::endl;
+		exit (EXIT_FAILURE);
+	}
+	tztag_candidates *candidates = reconstructed->clone();
+	candidates->top_found = false;
+	if (top_jets.empty())
+	{
+		ev->set_info(candidates);
+		return;
+	}
+
+	unsigned int top = 0;
+	if (candidates->has_Z())
+	{
+		// deltaR^2 between the top-tagged jets and the ideal back-to-back direction
+		const fastjet::PseudoJet & Z = candidates->Z;
+		fastjet::PseudoJet ideal_T(-Z.px(), -Z.py(), -Z.pz(), Z.e());
+		eta_phi_list top_eta_phi, ideal_eta_phi;
+		for (unsigned int i = 0; i < top_jets.size(); ++i)
+			top_eta_phi.add(top_jets[i].eta(), top_jets[i].phi());
+		ideal_eta_phi.add(ideal_T.eta(), ideal_T.phi());
+		std::vector<double> top_dr2;
+		top_eta_phi.delta_r2(ideal_eta_phi, top_dr2);
+		for (unsigned int i = 1; i < top_jets.size(); ++i)
+		{
+			if (top_dr2[i] < top_dr2[top])
+				top = i;
+		}
+	}
+	candidates->top_found = true;
+	candidates->T = top_jets[top];
+	ev->set_info(candidates);
+}
+
+// candidates attached to an event by the reconstruction stage
+inline const tztag_candidates & candidates(const analysis::event *ev)
+{
+	const tztag_candidates *candidates = ev->info<tztag_candidates>();
+	if (candidates == nullptr)
+	{
+		std::cout << "Error: event has no reconstructed tztag candidates." << std::endl;
+		exit (EXIT_FAILURE);
+	}
+	return *candidates;
+}
+
+#endif
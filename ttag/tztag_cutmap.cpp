@@ -22,6 +22,8 @@
 #include "plot/plot2d.h"
 #include "jet_analysis/jet_analysis.h"
 
+#include "tztag_candidates.h"
+
 using namespace std;
 using namespace boost;
 using namespace boost::filesystem;
@@ -32,38 +34,23 @@ using namespace analysis;
 // function prototypes
 bool load_settings(const string &settings_file, string &input_sig_lhco, string &output_file_cutmap);
 vector<event*> assign(const vector<event*> & original);
-vector<const particle*> identify_candidate_leptons(const vector<const particle*> & leptons, const double RLL_max);
 
 // basic cut: at least two opposite sign leptons need to be present, with invariant mass near the Z boson
+// the cut reconstructs the candidates of the events, which the Z cuts on this sample read
 class cut_2osl : public cut
 {
 public:
 	cut_2osl(double pt, double eta, double RLL) : pt_min(pt), eta_max(eta), RLL_max(RLL) {}
 
+	void prepare(const vector<event*> &events)
+	{
+		reconstruct_candidates(events, RLL_max, pt_min, eta_max);
+	}
+
 	bool operator() (const event *ev) 
 	{ 
-		// extract all visible leptons
-		vector<const particle*> leptons;
-		for (unsigned int i = 0; i < ev->size(); ++i)
-		{
-			if ((*ev)[i]->type() & ptype_lepton && (*ev)[i]->pt() > pt_min && abs((*ev)[i]->eta()) < eta_max)
-				leptons.push_back((*ev)[i]);
-		}
-
-		// check whether at least two visible leptons are present
-		if (leptons.size() < 2)
-			return false;
-
-		// identify lepton candidates
-		vector<const particle*> l_candidates = identify_candidate_leptons(leptons, RLL_max);
-		const particle *first_l = l_candidates[0];
-		const particle *second_l = l_candidates[1];
-		
-		if (first_l == nullptr || second_l == nullptr)
-			return false;
-		
-		// cut passed
-		return true;
+		// cut passed if the Z boson candidate was reconstructed
+		return candidates(ev).has_Z();
 	}
 private:
 	double pt_min;
@@ -75,30 +62,12 @@ private:
 class cut_ptZ : public cut
 {
 public:
-	cut_ptZ(double pt, double RLL) : pt_min(pt), RLL_max(RLL) {}
+	cut_ptZ(double pt) : pt_min(pt) {}
 
 	bool operator() (const event *ev) 
 	{ 
-		// extract all visible leptons
-		vector<const particle*> leptons;
-		for (unsigned int i = 0; i < ev->size(); ++i)
-		{
-			if ((*ev)[i]->type() & ptype_lepton && (*ev)[i]->pt() > 25. && abs((*ev)[i]->eta()) < 2.5)
-				leptons.push_back((*ev)[i]);
-		}
-
-		// identify lepton candidates (notice that the osl leptons reconstructing the Z need to be present)
-		vector<const particle*> l_candidates = identify_candidate_leptons(leptons, RLL_max);
-		const particle *first_l = l_candidates[0];
-		const particle *second_l = l_candidates[1];
-		
-		// reconstruct Z-boson transverse momentum
-		double px_Z = first_l->px() + second_l->px();
-		double py_Z = first_l->py() + second_l->py();
-		double pt_Z = sqrt(pow(px_Z, 2.0) + pow(py_Z, 2.0));
-
-		// check if pT(Z) > pt_min
-		if (pt_Z < pt_min)
+		// check if pT(Z) > pt_min (notice that the Z candidate needs to be present)
+		if (candidates(ev).Z.pt() < pt_min)
 			return false;
 		
 		// cut passed
@@ -106,42 +75,18 @@ public:
 	}
 private:
 	double pt_min;
-	double RLL_max;
 };
 
 // basic cut: eta of the reconstructed Z boson
 class cut_etaZ : public cut
 {
 public:
-	cut_etaZ(double eta, double RLL) : eta_max(eta), RLL_max(RLL) {}
+	cut_etaZ(double eta) : eta_max(eta) {}
 
 	bool operator() (const event *ev) 
 	{ 
-		// extract all visible leptons
-		vector<const particle*> leptons;
-		for (unsigned int i = 0; i < ev->size(); ++i)
-		{
-			if ((*ev)[i]->type() & ptype_lepton && (*ev)[i]->pt() > 25. && abs((*ev)[i]->eta()) < 2.5)
-				leptons.push_back((*ev)[i]);
-		}
-
-		// identify lepton candidates (notice that the osl leptons reconstructing the Z need to be present)
-		vector<const particle*> l_candidates = identify_candidate_leptons(leptons, RLL_max);
-		const particle *first_l = l_candidates[0];
-		const particle *second_l = l_candidates[1];
-		
-		// reconstruct Z-boson 4-vector
-		const double px_Z = first_l->px() + second_l->px();
-		const double py_Z = first_l->py() + second_l->py();
-		const double pz_Z = first_l->pz() + second_l->pz();
-		const double pe_Z = first_l->pe() + second_l->pe();
-		PseudoJet Zboson(px_Z, py_Z, pz_Z, pe_Z);
-
-		// extract eta of Z
-		double eta_Z = abs(Zboson.eta());
-
-		// check if eta(Z) < eta_max
-		if (eta_Z > eta_max)
+		// check if eta(Z) < eta_max (notice that the Z candidate needs to be present)
+		if (abs(candidates(ev).Z.eta()) > eta_max)
 			return false;
 		
 		// cut passed
@@ -149,7 +94,6 @@ public:
 	}
 private:
 	double eta_max;
-	double RLL_max;
 };
 
 // basic cut: at least n visible jets
@@ -236,11 +180,16 @@ int main(int argc, const char* argv[])
 	int ptZ_cut, ht_cut, nj_cut, ptB_cut; 
 	double RLL_cut, etaZ_cut;
 	double tot_eff, RLL_eff, ptZ_eff, etaZ_eff, ht_eff, nj_eff, ptB_eff;
+
+	// the HT of an event is computed once and shared by all steps of the HT cut
+	observables obs;
+	unsigned int ht_handle = obs.add("ht", observable_ht(ptype_jet, 30, 3.0));
 	
 	// cutmap loggin variables
 	int cutmap_done = 0, cutmap_total = 11 * 9 * 8 * 6 * 4 * 6, cutmap_logging = 11 * 9; 
 
-	// Delat_R(LL) cut: 11 steps
+	// Delat_R(LL) cut: 11 steps, which reconstructs the candidates, the copies of the
+	// events for the following cuts keep them
 	vector<event*> RLL_data = assign(events);
 	RLL_eff = 1;
 	for (RLL_cut = 2.4; RLL_cut >= 0.8; RLL_cut -= 0.2)
@@ -265,7 +214,7 @@ int main(int argc, const char* argv[])
 			if (ptZ_data.size() > 0)
 			{	
 				cuts ptZ_cuts;
-				cut_ptZ *ptZ = new cut_ptZ(ptZ_cut, RLL_cut);
+				cut_ptZ *ptZ = new cut_ptZ(ptZ_cut);
 				ptZ_cuts.add_cut(ptZ);
 				ptZ_cuts.apply(ptZ_data);
 				ptZ_eff *= ptZ_cuts.efficiency();
@@ -282,7 +231,7 @@ int main(int argc, const char* argv[])
 				if (etaZ_data.size() > 0)
 				{
 					cuts etaZ_cuts;
-					cut_etaZ *etaZ = new cut_etaZ(etaZ_cut, RLL_cut);
+					cut_etaZ *etaZ = new cut_etaZ(etaZ_cut);
 					etaZ_cuts.add_cut(etaZ);
 					etaZ_cuts.apply(etaZ_data);
 					etaZ_eff *= etaZ_cuts.efficiency();
@@ -299,7 +248,7 @@ int main(int argc, const char* argv[])
 					if (ht_data.size() > 0)
 					{
 						cuts ht_cuts;
-						cut_ht *ht = new cut_ht(ht_cut, ptype_jet, 30, 3.0);
+						cut_observable *ht = new cut_observable(obs, ht_handle, ht_cut);
 						ht_cuts.add_cut(ht);
 						ht_cuts.apply(ht_data);
 						ht_eff *= ht_cuts.efficiency();
@@ -409,58 +358,3 @@ vector<event*> assign(const vector<event*> & original)
 		duplicate.push_back(new event(*original[i]));
 	return duplicate;
 }
-
-// identify lepton candidates to reconstruct the Z boson
-vector<const particle*> identify_candidate_leptons(const vector<const particle*> & leptons, const double RLL_max)
-{
-	const particle *candidate1 = nullptr;
-	const particle *candidate2 = nullptr;
-
-	double delta_r_max = RLL_max;
-	double mz = 91.1876;
-	double mass_range = 10.;
-	double mass_diff_min = 1000.;
-
-	for (unsigned int i = 0; i < leptons.size()-1; ++i)
-	{
-		const particle *first_l = leptons[i];
-
-		for (unsigned int j = i+1; j < leptons.size(); ++j)
-		{
-			const particle *second_l = leptons[j];
-
-			// same flavour required
-			if (second_l->type() != first_l->type())
-				continue;
-			
-			// opposite charge required
-			if (second_l->charge() + first_l->charge() != 0)
-				continue;
-
-			// delta_r < delta_r_max required
-			if (delta_r(first_l, second_l) > delta_r_max)
-				continue;
-
-			// inv. mass required to be within 10 GeV from mZ
-			double inv_mass = mass({first_l, second_l});
-			if (abs(inv_mass - mz) > mass_range)
-				continue;
-
-			// select osl leptons with inv. mass closest to mZ
-			if (abs(inv_mass - mz) < mass_diff_min)
-			{
-				candidate1 = first_l;
-				candidate2 = second_l;
-				mass_diff_min = abs(inv_mass - mz);
-			}
-				 
-		} // end second loop over leptons
-		
-	} // end first loop over leptons
-
-	// return lepton candidates
-	vector<const particle*> l_candidates;
-	l_candidates.push_back(candidate1);
-	l_candidates.push_back(candidate2);
-	return l_candidates;
-}
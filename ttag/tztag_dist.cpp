@@ -7,6 +7,7 @@
 #include <ctime>
 #include <iostream>
 #include <random>
+#include <thread>
 #include <vector>
 
 #include <boost/filesystem.hpp>
@@ -20,7 +21,11 @@
 #include "cuts/cuts.h"
 #include "plot/plot.h"
 #include "plot/plot2d.h"
+#include "histogram/render_queue.h"
 #include "jet_analysis/jet_analysis.h"
+#include "results/results.h"
+
+#include "tztag_candidates.h"
 
 using namespace std;
 using namespace boost;
@@ -32,7 +37,6 @@ using namespace analysis;
 // function prototypes
 bool load_settings_mcinput(const string &settings_file, vector<string> &bkg_lhco, vector<double> &bkg_xsec, string &sig_lhco, double &sig_xsec);
 bool load_settings_general(const string &settings_file, string &output_folder, double &luminosity, bool &kinematic_dist);
-vector<const particle*> identify_candidate_leptons(const vector<const particle*> & leptons);
 
 //===== Observables defined on non-analyzed events =====//
 
@@ -44,40 +48,13 @@ public:
 
 	double operator() (const event *ev)
 	{
-		// identify leptons
-		vector<const particle*> leptons;
-		for (unsigned int i = 0; i < ev->size(); ++i)
-		{
-			if ((*ev)[i]->type() & ptype_lepton && (*ev)[i]->pt() > 25. && abs((*ev)[i]->eta()) < 2.5)
-				leptons.push_back((*ev)[i]);
-		}
-
-		// at least two visible leptons are required
-		if (leptons.size() < 2)
+		// lepton candidates: no deltaR_min is required!
+		const tztag_candidates & cand = candidates(ev);
+		if (!cand.has_Z())
 			return 0.0;
 
-		// identify lepton candidates: no deltaR_min is required!
-		vector<const particle*> l_candidates = identify_candidate_leptons(leptons);
-		const particle *first_l = l_candidates[0];
-		const particle *second_l = l_candidates[1];
-		
-		if (first_l == nullptr || second_l == nullptr)
-			return 0.0;
-
-		// extract eta and phi of L1,L2
-		double etaL1 = first_l->eta();
-		double phiL1 = first_l->phi();
-		double etaL2 = second_l->eta();
-		double phiL2 = second_l->phi();
-
-		// evaluate deltaR(L1,L2)
-		double deltaEta = etaL1 - etaL2;
-		double deltaPhi = abs(phiL1 - phiL2);
-		deltaPhi = min(deltaPhi, 8 * atan(1) - deltaPhi);
-		double deltaR = sqrt( pow(deltaEta,2.0) + pow(deltaPhi,2.0) );
-
-		// return deltaR
-		return deltaR;
+		// return deltaR(L1,L2)
+		return delta_r((*ev)[cand.lepton1], (*ev)[cand.lepton2]);
 	}
 };
 
@@ -89,50 +66,16 @@ public:
 
 	double operator() (const event *ev)
 	{
-		// identify leptons
-		vector<const particle*> leptons;
-		for (unsigned int i = 0; i < ev->size(); ++i)
-		{
-			if ((*ev)[i]->type() & ptype_lepton && (*ev)[i]->pt() > 25. && abs((*ev)[i]->eta()) < 2.5)
-				leptons.push_back((*ev)[i]);
-		}
-
-		// at least two visible leptons are required
-		if (leptons.size() < 2)
-			return 0.0;
-
-		// identify lepton candidates: no deltaR_min is required!
-		vector<const particle*> l_candidates = identify_candidate_leptons(leptons);
-		const particle *first_l = l_candidates[0];
-		const particle *second_l = l_candidates[1];
-		
-		if (first_l == nullptr || second_l == nullptr)
-			return 0.0;
-
-		// reconstruct Z-boson 4-vector
-		const double px_Z = first_l->px() + second_l->px();
-		const double py_Z = first_l->py() + second_l->py();
-		const double pz_Z = first_l->pz() + second_l->pz();
-		const double pe_Z = first_l->pe() + second_l->pe();
-		PseudoJet Zboson(px_Z, py_Z, pz_Z, pe_Z);
-
-		// identify b-jets
-		vector<const particle*> bjets;
-		for (unsigned int i = 0; i < ev->size(); ++i)
-		{
-			if ( (*ev)[i]->bjet() != 0.0 && abs((*ev)[i]->eta()) < 2.8 && (*ev)[i]->pt() > 30 )
-				bjets.push_back((*ev)[i]);
-		}
-
-		// at least one b-jet is required
-		if (bjets.size() < 1)
+		// Z candidate and (leading) b-jet are required
+		const tztag_candidates & cand = candidates(ev);
+		if (!cand.has_Z() || !cand.has_bjet())
 			return 0.0;
 
 		// extract eta and phi of Z and (leading) b-jet
-		double etaZ = Zboson.eta();
-		double phiZ = Zboson.phi();
-		double etaB = bjets[0]->eta();
-		double phiB = bjets[0]->phi();
+		double etaZ = cand.Z.eta();
+		double phiZ = cand.Z.phi();
+		double etaB = (*ev)[cand.bjet]->eta();
+		double phiB = (*ev)[cand.bjet]->phi();
 
 		// evaluate deltaR(b,Z)
 		double deltaEta = etaB - etaZ;
@@ -153,33 +96,13 @@ public:
 
 	double operator() (const event *ev)
 	{
-		// identify leptons
-		vector<const particle*> leptons;
-		for (unsigned int i = 0; i < ev->size(); ++i)
-		{
-			if ((*ev)[i]->type() & ptype_lepton && (*ev)[i]->pt() > 25. && abs((*ev)[i]->eta()) < 2.5)
-				leptons.push_back((*ev)[i]);
-		}
-
-		// at least two visible leptons are required
-		if (leptons.size() < 2)
-			return 0.0;
-
-		// identify lepton candidates: no deltaR_min is required!
-		vector<const particle*> l_candidates = identify_candidate_leptons(leptons);
-		const particle *first_l = l_candidates[0];
-		const particle *second_l = l_candidates[1];
-		
-		if (first_l == nullptr || second_l == nullptr)
+		// Z candidate: no deltaR_min is required!
+		const tztag_candidates & cand = candidates(ev);
+		if (!cand.has_Z())
 			return 0.0;
 
-		// reconstruct Z-boson transverse momentum
-		double px_Z = first_l->px() + second_l->px();
-		double py_Z = first_l->py() + second_l->py();
-		double pt_Z = sqrt(pow(px_Z, 2.0) + pow(py_Z, 2.0));
-
 		// return pt_Z
-		return pt_Z;
+		return cand.Z.pt();
 	}
 };
 
@@ -191,38 +114,13 @@ public:
 
 	double operator() (const event *ev)
 	{
-		// identify leptons
-		vector<const particle*> leptons;
-		for (unsigned int i = 0; i < ev->size(); ++i)
-		{
-			if ((*ev)[i]->type() & ptype_lepton && (*ev)[i]->pt() > 25. && abs((*ev)[i]->eta()) < 2.5)
-				leptons.push_back((*ev)[i]);
-		}
-
-		// at least two visible leptons are required
-		if (leptons.size() < 2)
+		// Z candidate: no deltaR_min is required!
+		const tztag_candidates & cand = candidates(ev);
+		if (!cand.has_Z())
 			return 0.0;
 
-		// identify lepton candidates: no deltaR_min is required!
-		vector<const particle*> l_candidates = identify_candidate_leptons(leptons);
-		const particle *first_l = l_candidates[0];
-		const particle *second_l = l_candidates[1];
-		
-		if (first_l == nullptr || second_l == nullptr)
-			return 0.0;
-
-		// reconstruct Z-boson 4-vector
-		const double px_Z = first_l->px() + second_l->px();
-		const double py_Z = first_l->py() + second_l->py();
-		const double pz_Z = first_l->pz() + second_l->pz();
-		const double pe_Z = first_l->pe() + second_l->pe();
-		PseudoJet Zboson(px_Z, py_Z, pz_Z, pe_Z);
-
-		// extract eta of Z
-		double eta = abs(Zboson.eta());
-
 		// return eta
-		return eta;
+		return abs(cand.Z.eta());
 	}
 };
 
@@ -269,31 +167,36 @@ public:
 	}
 };
 
-// HT(jets)
-class plot_HT : public plot_default
+//===== Observables defined on analyzed events =====//
+
+// lepton pair mass
+class plot_leptonmass : public plot_default
 {
 public:
-	plot_HT() {}
+	plot_leptonmass() {}
 
 	double operator() (const event *ev)
 	{
-		double HT = ev->ht(ptype_jet, 30, 3.0);
-		return HT;
+		return mass({ev->get(ptype_lepton, 1), ev->get(ptype_lepton, 2)});
 	}
 };
 
-//===== Observables defined on analyzed events =====//
+//===== Observables defined on analyzed events, with the candidates required by cut_candidates =====//
 
-// lepton pair mass
-class plot_leptonmass : public plot_default
+// precondition: the event has the requested candidates
+class cut_candidates : public cut
 {
 public:
-	plot_leptonmass() {}
+	cut_candidates(bool Z, bool top) : require_Z(Z), require_top(top) {}
 
-	double operator() (const event *ev)
+	bool operator() (const event *ev)
 	{
-		return mass({ev->get(ptype_lepton, 1), ev->get(ptype_lepton, 2)});
+		const tztag_candidates & cand = candidates(ev);
+		return (!require_Z || cand.has_Z()) && (!require_top || cand.has_top());
 	}
+private:
+	bool require_Z;
+	bool require_top;
 };
 
 // pT of reconstructed Z (with deltaR_min on the lepton pair required)
@@ -304,13 +207,8 @@ public:
 
 	double operator() (const event *ev)
 	{
-		// reconstruct Z-boson transverse momentum
-		double px_Z = (ev->get(ptype_lepton, 1))->px() + (ev->get(ptype_lepton, 2))->px();
-		double py_Z = (ev->get(ptype_lepton, 1))->py() + (ev->get(ptype_lepton, 2))->py();
-		double pt_Z = sqrt( pow(px_Z, 2.0) + pow(py_Z, 2.0) );
-
-		// return pt
-		return pt_Z;
+		// the analyzed events contain the lepton pair of the Z candidate
+		return candidates(ev).Z.pt();
 	}
 };
 
@@ -322,18 +220,7 @@ public:
 
 	double operator() (const event *ev)
 	{
-		// reconstruct Z-boson 4-vector
-		const double px_Z = (ev->get(ptype_lepton, 1))->px() + (ev->get(ptype_lepton, 2))->px();
-		const double py_Z = (ev->get(ptype_lepton, 1))->py() + (ev->get(ptype_lepton, 2))->py();
-		const double pz_Z = (ev->get(ptype_lepton, 1))->pz() + (ev->get(ptype_lepton, 2))->pz();
-		const double pe_Z = (ev->get(ptype_lepton, 1))->pe() + (ev->get(ptype_lepton, 2))->pe();
-		PseudoJet Zboson(px_Z, py_Z, pz_Z, pe_Z);
-
-		// extract eta of Z
-		double eta = abs(Zboson.eta());
-
-		// return eta
-		return eta;
+		return abs(candidates(ev).Z.eta());
 	}
 };
 
@@ -345,8 +232,7 @@ public:
 
 	double operator() (const event *ev)
 	{
-		double pt = (ev->get(ptype_jet, 1))->pt();
-		return pt;
+		return candidates(ev).T.pt();
 	}
 };
 
@@ -358,8 +244,7 @@ public:
 
 	double operator() (const event *ev)
 	{
-		double eta = abs((ev->get(ptype_jet, 1))->eta());
-		return eta;
+		return abs(candidates(ev).T.eta());
 	}
 };
 
@@ -371,18 +256,14 @@ public:
 
 	double operator() (const event *ev)
 	{
-		// reconstruct Z-boson 4-vector
-		const double px_Z = (ev->get(ptype_lepton, 1))->px() + (ev->get(ptype_lepton, 2))->px();
-		const double py_Z = (ev->get(ptype_lepton, 1))->py() + (ev->get(ptype_lepton, 2))->py();
-		const double pz_Z = (ev->get(ptype_lepton, 1))->pz() + (ev->get(ptype_lepton, 2))->pz();
-		const double pe_Z = (ev->get(ptype_lepton, 1))->pe() + (ev->get(ptype_lepton, 2))->pe();
-		PseudoJet Zboson(px_Z, py_Z, pz_Z, pe_Z);
+		// the analyzed events contain the Z and top candidates
+		const tztag_candidates & cand = candidates(ev);
 
 		// extract eta and phi of Z and top-jet
-		double etaZ = Zboson.eta();
-		double phiZ = Zboson.phi();
-		double etaJ = (ev->get(ptype_jet, 1))->eta();
-		double phiJ = (ev->get(ptype_jet, 1))->phi();
+		double etaZ = cand.Z.eta();
+		double phiZ = cand.Z.phi();
+		double etaJ = cand.T.eta();
+		double phiJ = cand.T.phi();
 
 		// evaluate deltaR(t,Z)
 		double deltaEta = etaJ - etaZ;
@@ -403,10 +284,28 @@ public:
 
 	double operator() (const event *ev)
 	{
-		return mass({ev->get(ptype_lepton, 1), ev->get(ptype_lepton, 2), ev->get(ptype_jet, 1)});
+		const tztag_candidates & cand = candidates(ev);
+		return (cand.Z + cand.T).m();
 	}
 };
 
+// the analyzed events written by tztag_1top contain the top-tagged fat jet as their only jet
+void reconstruct_tagged_top(const vector<event*> & events)
+{
+	for (unsigned int i = 0; i < events.size(); ++i)
+	{
+		event *ev = events[i];
+		vector<PseudoJet> top_jets;
+		for (unsigned int j = 0; j < ev->size(); ++j)
+		{
+			const particle *p = (*ev)[j];
+			if (p->type() & ptype_jet)
+				top_jets.push_back(PseudoJet(p->px(), p->py(), p->pz(), p->pe()));
+		}
+		reconstruct_top_candidate(ev, top_jets);
+	}
+}
+
 // main program: may have one argument
 int main(int argc, const char* argv[])
 {
@@ -449,6 +348,11 @@ int main(int argc, const char* argv[])
 	}	
 	read_lhco(sig_evts, sig_lhco);
 
+	// reconstruct the Z, b-jet and top candidates once per event
+	for (unsigned int i = 0; i < bkg_evts.size(); ++i)
+		reconstruct_candidates(bkg_evts[i]);
+	reconstruct_candidates(sig_evts);
+
 	// create labels for plot legend
 	vector<string> labels;
 	labels = {"ttz+jets","z+jets","tz+jets","t^{*}z+jets"};
@@ -458,6 +362,9 @@ int main(int argc, const char* argv[])
 	kfact_bkg = {1.30,1.20,1.11,1.09};
 	double kfact_sig = 1.14;
 
+	// the plots are rendered by background workers while the analysis continues
+	render_queue renderer(thread::hardware_concurrency());
+
 	// if requested, plot some kinematic distributions before the application of the cuts
 	if (kinematic_dist)
 	{
@@ -475,7 +382,7 @@ int main(int argc, const char* argv[])
 			deltarLL.add_sample(bkg_evts[i], LL, labels[i]);
 		}
 		deltarLL.add_sample(sig_evts, LL, "signal");
-		deltarLL.run();
+		deltarLL.run(renderer);
 
 		// plot deltaR(Z,b)
 		plot drZb("plot_deltarZb_before_cuts", output_folder);
@@ -490,7 +397,7 @@ int main(int argc, const char* argv[])
 			drZb.add_sample(bkg_evts[i], deltarZb, labels[i]);
 		}
 		drZb.add_sample(sig_evts, deltarZb, "signal");
-		drZb.run();
+		drZb.run(renderer);
 
 		// plot pT of Z
 		plot ptZ("plot_ptZ_before_cuts", output_folder);
@@ -505,7 +412,7 @@ int main(int argc, const char* argv[])
 			ptZ.add_sample(bkg_evts[i], Zpt, labels[i]);
 		}
 		ptZ.add_sample(sig_evts, Zpt, "signal");
-		ptZ.run();
+		ptZ.run(renderer);
 
 		// plot eta of Z
 		plot etaZ("plot_etaZ_before_cuts", output_folder);
@@ -520,7 +427,7 @@ int main(int argc, const char* argv[])
 			etaZ.add_sample(bkg_evts[i], Zeta, labels[i]);
 		}
 		etaZ.add_sample(sig_evts, Zeta, "signal");
-		etaZ.run();
+		etaZ.run(renderer);
 
 		// plot jet multiplicity
 		plot nj("plot_nj_before_cuts", output_folder);
@@ -535,7 +442,7 @@ int main(int argc, const char* argv[])
 			nj.add_sample(bkg_evts[i], NJ, labels[i]);
 		}
 		nj.add_sample(sig_evts, NJ, "signal");
-		nj.run();
+		nj.run(renderer);
 
 		// plot pT of leading b-jet
 		plot ptB("plot_ptB_before_cuts", output_folder);
@@ -550,7 +457,7 @@ int main(int argc, const char* argv[])
 			ptB.add_sample(bkg_evts[i], Bpt, labels[i]);
 		}
 		ptB.add_sample(sig_evts, Bpt, "signal");
-		ptB.run();
+		ptB.run(renderer);
 
 		// plot HT(jets)
 		plot ht("plot_HT_before_cuts", output_folder);
@@ -559,13 +466,20 @@ int main(int argc, const char* argv[])
 		ht.set_leg_title("");
 		ht.set_x_label("H_{T} [GeV]");
 		ht.set_y_label("fraction of events");
-		plot_HT *HT = new plot_HT();
+		// the ht plot and the ht cut below share the default observables, which are prepared
+		// for all samples at once such that the ht of each event is computed only once
+		vector<event*> kinematic_evts(sig_evts);
+		for (unsigned int i = 0; i < bkg_evts.size()-1; ++i)
+			kinematic_evts.insert(kinematic_evts.end(), bkg_evts[i].begin(), bkg_evts[i].end());
+		default_observables().prepare(kinematic_evts);
+		plot_ht *HT = new plot_ht(ptype_jet, 30, 3.0);
 		for (unsigned int i = 0; i < bkg_evts.size()-1; ++i)
 		{
 			ht.add_sample(bkg_evts[i], HT, labels[i]);
 		}
 		ht.add_sample(sig_evts, HT, "signal");
-		ht.run();
+		ht.run(renderer);
+		renderer.start();
 
 		// apply ht cut
 		cuts basic_cuts;
@@ -589,7 +503,7 @@ int main(int argc, const char* argv[])
 			deltarLLht.add_sample(bkg_evts[i], LL, labels[i]);
 		}
 		deltarLLht.add_sample(sig_evts, LL, "signal");
-		deltarLLht.run();
+		deltarLLht.run(renderer);
 
 		// plot deltaR(Z,b) after ht cut
 		plot drZbht("plot_deltarZb_htcut", output_folder);
@@ -603,7 +517,7 @@ int main(int argc, const char* argv[])
 			drZbht.add_sample(bkg_evts[i], deltarZb, labels[i]);
 		}
 		drZbht.add_sample(sig_evts, deltarZb, "signal");
-		drZbht.run();
+		drZbht.run(renderer);
 
 		// plot pT of Z after ht cut
 		plot ptZht("plot_ptZ_htcut", output_folder);
@@ -617,7 +531,7 @@ int main(int argc, const char* argv[])
 			ptZht.add_sample(bkg_evts[i], Zpt, labels[i]);
 		}
 		ptZht.add_sample(sig_evts, Zpt, "signal");
-		ptZht.run();
+		ptZht.run(renderer);
 
 		// plot eta of Z
 		plot etaZht("plot_etaZ_htcut", output_folder);
@@ -631,7 +545,7 @@ int main(int argc, const char* argv[])
 			etaZht.add_sample(bkg_evts[i], Zeta, labels[i]);
 		}
 		etaZht.add_sample(sig_evts, Zeta, "signal");
-		etaZht.run();
+		etaZht.run(renderer);
 
 		// plot jet multiplicity after ht cut
 		plot njht("plot_nj_htcut", output_folder);
@@ -645,7 +559,7 @@ int main(int argc, const char* argv[])
 			njht.add_sample(bkg_evts[i], NJ, labels[i]);
 		}
 		njht.add_sample(sig_evts, NJ, "signal");
-		njht.run();
+		njht.run(renderer);
 
 		// plot pT of leading b-jet after ht cut
 		plot ptBht("plot_ptB_htcut", output_folder);
@@ -659,7 +573,7 @@ int main(int argc, const char* argv[])
 			ptBht.add_sample(bkg_evts[i], Bpt, labels[i]);
 		}
 		ptBht.add_sample(sig_evts, Bpt, "signal");
-		ptBht.run();
+		ptBht.run(renderer);
 	
 		// clear remaining pointers
 		delete LL;
@@ -671,6 +585,9 @@ int main(int argc, const char* argv[])
 		delete HT;
 		delete htcut;
 		
+		// render the remaining plots and wait for the workers
+		renderer.render();
+
 		// clear remaining event pointers
 		for (unsigned int i = 0; i < bkg_evts.size(); ++i)
 			delete_events(bkg_evts[i]);
@@ -686,6 +603,14 @@ int main(int argc, const char* argv[])
 		return EXIT_SUCCESS;
 	}
 	
+	// the analyzed events also have a top candidate, events without the candidates of a plot are skipped
+	for (unsigned int i = 0; i < bkg_evts.size(); ++i)
+		reconstruct_tagged_top(bkg_evts[i]);
+	reconstruct_tagged_top(sig_evts);
+	cut_candidates *has_Z = new cut_candidates(true, false);
+	cut_candidates *has_top = new cut_candidates(false, true);
+	cut_candidates *has_Zt = new cut_candidates(true, true);
+
 	// // plot lepton pair mass
 	// plot lmass("plot_leptonmass", output_folder);
 	// lmass.set_normalized(true);
@@ -710,10 +635,10 @@ int main(int argc, const char* argv[])
 	plot_deltarLL *LL = new plot_deltarLL();
 	for (unsigned int i = 0; i < bkg_evts.size()-1; ++i)
 	{
-		deltarLL.add_sample(bkg_evts[i], LL, labels[i]);
+		deltarLL.add_sample(bkg_evts[i], LL, labels[i], 1, has_Z);
 	}
-	deltarLL.add_sample(sig_evts, LL, "signal");
-	deltarLL.run();	
+	deltarLL.add_sample(sig_evts, LL, "signal", 1, has_Z);
+	deltarLL.run(renderer);	
 
 	// plot pT of reconstructed Z
 	plot ptRecZ("plot_ptZ", output_folder);
@@ -725,10 +650,10 @@ int main(int argc, const char* argv[])
 	plot_recZpt *recZpt = new plot_recZpt();
 	for (unsigned int i = 0; i < bkg_evts.size()-1; ++i)
 	{
-		ptRecZ.add_sample(bkg_evts[i], recZpt, labels[i]);
+		ptRecZ.add_sample(bkg_evts[i], recZpt, labels[i], 1, has_Z);
 	}
-	ptRecZ.add_sample(sig_evts, recZpt, "signal");
-	ptRecZ.run();
+	ptRecZ.add_sample(sig_evts, recZpt, "signal", 1, has_Z);
+	ptRecZ.run(renderer);
 
 	// plot eta of reconstructed Z
 	plot etaRecZ("plot_etaZ", output_folder);
@@ -740,10 +665,10 @@ int main(int argc, const char* argv[])
 	plot_recZeta *recZeta = new plot_recZeta();
 	for (unsigned int i = 0; i < bkg_evts.size()-1; ++i)
 	{
-		etaRecZ.add_sample(bkg_evts[i], recZeta, labels[i]);
+		etaRecZ.add_sample(bkg_evts[i], recZeta, labels[i], 1, has_Z);
 	}
-	etaRecZ.add_sample(sig_evts, recZeta, "signal");
-	etaRecZ.run();
+	etaRecZ.add_sample(sig_evts, recZeta, "signal", 1, has_Z);
+	etaRecZ.run(renderer);
 
 	// plot pT of reconstructed top-jet
 	plot ptT("plot_ptT", output_folder);
@@ -755,10 +680,10 @@ int main(int argc, const char* argv[])
 	plot_Tpt *Tpt = new plot_Tpt();
 	for (unsigned int i = 0; i < bkg_evts.size()-1; ++i)
 	{
-		ptT.add_sample(bkg_evts[i], Tpt, labels[i]);
+		ptT.add_sample(bkg_evts[i], Tpt, labels[i], 1, has_top);
 	}
-	ptT.add_sample(sig_evts, Tpt, "signal");
-	ptT.run();
+	ptT.add_sample(sig_evts, Tpt, "signal", 1, has_top);
+	ptT.run(renderer);
 
 	// plot eta of reconstructed top-jet
 	plot etaT("plot_etaT", output_folder);
@@ -770,10 +695,10 @@ int main(int argc, const char* argv[])
 	plot_etaT *Teta = new plot_etaT();
 	for (unsigned int i = 0; i < bkg_evts.size()-1; ++i)
 	{
-		etaT.add_sample(bkg_evts[i], Teta, labels[i]);
+		etaT.add_sample(bkg_evts[i], Teta, labels[i], 1, has_top);
 	}
-	etaT.add_sample(sig_evts, Teta, "signal");
-	etaT.run();
+	etaT.add_sample(sig_evts, Teta, "signal", 1, has_top);
+	etaT.run(renderer);
 
 	// plot deltaR(Z, tagged top)
 	plot drZt("plot_deltarZt", output_folder);
@@ -785,10 +710,10 @@ int main(int argc, const char* argv[])
 	plot_deltarZt *deltarZt = new plot_deltarZt();
 	for (unsigned int i = 0; i < bkg_evts.size()-1; ++i)
 	{
-		drZt.add_sample(bkg_evts[i], deltarZt, labels[i]);
+		drZt.add_sample(bkg_evts[i], deltarZt, labels[i], 1, has_Zt);
 	}
-	drZt.add_sample(sig_evts, deltarZt, "signal");
-	drZt.run();
+	drZt.add_sample(sig_evts, deltarZt, "signal", 1, has_Zt);
+	drZt.run(renderer);
 	
 	// plot top partner mass
 	plot pmass("plot_thmass", output_folder);
@@ -800,10 +725,10 @@ int main(int argc, const char* argv[])
 	for (unsigned int i = 0; i < bkg_evts.size()-1; ++i)
 	{
 		double weight = bkg_xsec[i] * luminosity / bkg_evts[i].size();
-		pmass.add_sample(bkg_evts[i], th_mass, labels[i], weight);
+		pmass.add_sample(bkg_evts[i], th_mass, labels[i], weight, has_Zt);
 	}
-	pmass.add_sample(sig_evts, th_mass, "signal", sig_xsec * luminosity / sig_evts.size());
-	pmass.run();	
+	pmass.add_sample(sig_evts, th_mass, "signal", sig_xsec * luminosity / sig_evts.size(), has_Zt);
+	pmass.run(renderer);	
 	
 	// plot top partner mass: combined
 	plot pmass_comb("plot_thmass_combined", output_folder);
@@ -815,13 +740,20 @@ int main(int argc, const char* argv[])
 	double weight;
 	// ttz sample
 	weight = bkg_xsec[0] * kfact_bkg[0] * luminosity / bkg_evts[0].size();
-	pmass_comb.add_sample(bkg_evts[0], th_mass, labels[0], weight);
+	pmass_comb.add_sample(bkg_evts[0], th_mass, labels[0], weight, has_Zt);
 	// zjj sample
 	weight = bkg_xsec[1] * kfact_bkg[1] * luminosity / bkg_evts[1].size();
-	pmass_comb.add_sample(bkg_evts[1], th_mass, labels[1], weight);
+	pmass_comb.add_sample(bkg_evts[1], th_mass, labels[1], weight, has_Zt);
 	// signal sample
-	pmass_comb.add_sample(sig_evts, th_mass, "signal", sig_xsec * kfact_sig * luminosity / sig_evts.size());
-	pmass_comb.run();
+	pmass_comb.add_sample(sig_evts, th_mass, "signal", sig_xsec * kfact_sig * luminosity / sig_evts.size(), has_Zt);
+	pmass_comb.run(renderer);
+
+	// store the weighted mass distributions, the results of independent jobs can be merged
+	results dist_results;
+	for (unsigned int i = 0; i < bkg_evts.size()-1; ++i)
+		dist_results.add("thmass/" + labels[i], pmass.data(i));
+	dist_results.add("thmass/signal", pmass.data(bkg_evts.size()-1));
+	dist_results.write(output_folder + "tztag_dist.results");
 
 	// clear remaining pointers
 	// delete lepton_mass;
@@ -832,7 +764,13 @@ int main(int argc, const char* argv[])
 	delete Teta;
 	delete deltarZt;
 	delete th_mass;
+	delete has_Z;
+	delete has_top;
+	delete has_Zt;
 	
+	// render the plots and wait for the workers
+	renderer.render();
+
 	// clear remaining event pointers
 	for (unsigned int i = 0; i < bkg_evts.size(); ++i)
 		delete_events(bkg_evts[i]);
@@ -848,56 +786,6 @@ int main(int argc, const char* argv[])
 	return EXIT_SUCCESS;
 }
 
-// identify lepton candidates to reconstruct the Z boson
-vector<const particle*> identify_candidate_leptons(const vector<const particle*> & leptons)
-{
-	const particle *candidate1 = nullptr;
-	const particle *candidate2 = nullptr;
-
-	double mz = 91.1876;
-	double mass_range = 10.;
-	double mass_diff_min = 1000.;
-
-	for (unsigned int i = 0; i < leptons.size()-1; ++i)
-	{
-		const particle *first_l = leptons[i];
-
-		for (unsigned int j = i+1; j < leptons.size(); ++j)
-		{
-			const particle *second_l = leptons[j];
-
-			// same flavour required
-			if (second_l->type() != first_l->type())
-				continue;
-			
-			// opposite charge required
-			if (second_l->charge() + first_l->charge() != 0)
-				continue;
-
-			// inv. mass required to be within 10 GeV from mZ
-			double inv_mass = mass({first_l, second_l});
-			if (abs(inv_mass - mz) > mass_range)
-				continue;
-
-			// select osl leptons with inv. mass closest to mZ
-			if (abs(inv_mass - mz) < mass_diff_min)
-			{
-				candidate1 = first_l;
-				candidate2 = second_l;
-				mass_diff_min = abs(inv_mass - mz);
-			}
-				 
-		} // end second loop over leptons
-		
-	} // end first loop over leptons
-
-	// return lepton candidates
-	vector<const particle*> l_candidates;
-	l_candidates.push_back(candidate1);
-	l_candidates.push_back(candidate2);
-	return l_candidates;
-}
-
 // load settings functions
 bool load_settings_mcinput(const string &settings_file, vector<string> &bkg_lhco, vector<double> &bkg_xsec, string &sig_lhco, double &sig_xsec)
 {